@@ -0,0 +1,193 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+#include "sgp4sdp4.h"
+
+// Chebyshev ephemeris cache:
+//
+// Astronomy_Equator() evaluates the full planetary or lunar theory, which
+// is far too slow to run on every tracking cycle.  Over a few hours the
+// topocentric position of any body is smooth, so we sample it at the
+// Chebyshev nodes of a window, keep the coefficients, and evaluate the
+// polynomial on each tick.  The sidereal time is advanced linearly from
+// the start of the window and the horizontal transform and refraction
+// are done here, so a tick costs a few dozen flops and some trig.
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "astronomy.h"
+#include "astro_cache.h"
+
+// Sidereal hours per UT day
+#define ASTRO_SIDEREAL_RATE (24 * 1.00273790935)
+
+#define ASTRO_PI 3.14159265358979323846
+
+void astro_cache_reset(astro_cache_t *cache)
+{
+	memset(cache, 0, sizeof(*cache));
+	cache->body = BODY_INVALID;
+}
+
+// Sample the body at the Chebyshev nodes of the window starting at ut
+// and compute the coefficients.
+static astro_status_t astro_cache_fit(astro_cache_t *cache,
+	astro_body_t body, astro_observer_t observer, double ut)
+{
+	double samples[3][ASTRO_CACHE_ORDER];
+	astro_equatorial_t equ;
+	astro_time_t t;
+	int j, k;
+
+	cache->valid = 0;
+
+	for (k = 0; k < ASTRO_CACHE_ORDER; k++)
+	{
+		double x = cos(ASTRO_PI * (k + 0.5) / ASTRO_CACHE_ORDER);
+
+		t = Astronomy_TimeFromDays(ut + (x + 1) / 2 * ASTRO_CACHE_WINDOW);
+
+		equ = Astronomy_Equator(body, &t, observer, EQUATOR_OF_DATE, ABERRATION);
+		if (equ.status != ASTRO_SUCCESS)
+			return equ.status;
+
+		samples[0][k] = equ.vec.x;
+		samples[1][k] = equ.vec.y;
+		samples[2][k] = equ.vec.z;
+	}
+
+	for (j = 0; j < ASTRO_CACHE_ORDER; j++)
+	{
+		double sx = 0, sy = 0, sz = 0;
+
+		for (k = 0; k < ASTRO_CACHE_ORDER; k++)
+		{
+			double c = cos(ASTRO_PI * j * (k + 0.5) / ASTRO_CACHE_ORDER);
+
+			sx += samples[0][k] * c;
+			sy += samples[1][k] * c;
+			sz += samples[2][k] * c;
+		}
+
+		cache->coef[0][j] = sx * 2 / ASTRO_CACHE_ORDER;
+		cache->coef[1][j] = sy * 2 / ASTRO_CACHE_ORDER;
+		cache->coef[2][j] = sz * 2 / ASTRO_CACHE_ORDER;
+	}
+
+	t = Astronomy_TimeFromDays(ut);
+
+	cache->gast_start = Astronomy_SiderealTime(&t);
+	cache->ut_start = ut;
+	cache->body = body;
+	cache->observer = observer;
+	cache->valid = 1;
+	cache->fits++;
+
+	return ASTRO_SUCCESS;
+}
+
+// Evaluate a Chebyshev series at x in [-1,1] by Clenshaw recurrence.
+static double astro_cache_cheb(const double *c, double x)
+{
+	double b0 = 0, b1 = 0, b2 = 0;
+	int j;
+
+	for (j = ASTRO_CACHE_ORDER - 1; j >= 1; j--)
+	{
+		b2 = b1;
+		b1 = b0;
+		b0 = 2 * x * b1 - b2 + c[j];
+	}
+
+	return x * b0 - b1 + c[0] / 2;
+}
+
+// Return the horizontal position of body at time, refitting the cache
+// when the body or observer changes or time leaves the window.  Azimuth
+// and altitude are in degrees and altitude includes normal refraction,
+// the same as Astronomy_Horizon(..., REFRACTION_NORMAL).
+astro_status_t astro_cache_horizon(astro_cache_t *cache,
+	astro_body_t body, astro_observer_t observer, astro_time_t *time,
+	double *azimuth, double *altitude)
+{
+	double x, px, py, pz, ra, dec, ha, lat, az, alt;
+	astro_status_t status;
+
+	if (!cache->valid
+		|| cache->body != body
+		|| cache->observer.latitude != observer.latitude
+		|| cache->observer.longitude != observer.longitude
+		|| cache->observer.height != observer.height
+		|| time->ut < cache->ut_start
+		|| time->ut > cache->ut_start + ASTRO_CACHE_WINDOW)
+	{
+		status = astro_cache_fit(cache, body, observer, time->ut);
+		if (status != ASTRO_SUCCESS)
+			return status;
+	}
+
+	cache->evals++;
+
+	x = 2 * (time->ut - cache->ut_start) / ASTRO_CACHE_WINDOW - 1;
+
+	px = astro_cache_cheb(cache->coef[0], x);
+	py = astro_cache_cheb(cache->coef[1], x);
+	pz = astro_cache_cheb(cache->coef[2], x);
+
+	// Right ascension (hours) and declination (radians) of date
+	ra = atan2(py, px) * 12 / ASTRO_PI;
+	dec = atan2(pz, sqrt(px*px + py*py));
+
+	// Local hour angle in radians
+	ha = cache->gast_start + ASTRO_SIDEREAL_RATE * (time->ut - cache->ut_start)
+		+ observer.longitude / 15 - ra;
+	ha *= ASTRO_PI / 12;
+
+	lat = observer.latitude * ASTRO_PI / 180;
+
+	alt = asin(sin(lat)*sin(dec) + cos(lat)*cos(dec)*cos(ha)) * 180 / ASTRO_PI;
+	az = atan2(-cos(dec)*sin(ha),
+		sin(dec)*cos(lat) - cos(dec)*sin(lat)*cos(ha)) * 180 / ASTRO_PI;
+
+	if (az < 0)
+		az += 360;
+
+	*azimuth = az;
+	*altitude = alt + Astronomy_Refraction(REFRACTION_NORMAL, alt);
+
+	return ASTRO_SUCCESS;
+}
+
+void astro_cache_status(astro_cache_t *cache)
+{
+	if (!cache->valid)
+	{
+		printf("Astro cache: empty\r\n");
+		return;
+	}
+
+	printf("Astro cache: %s, window %.1f hours starting at UT day %.5f, %u fits for %u evaluations\r\n",
+		Astronomy_BodyName(cache->body),
+		ASTRO_CACHE_WINDOW * 24,
+		cache->ut_start,
+		cache->fits, cache->evals);
+}
@@ -0,0 +1,489 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+
+// Zero-copy access to tle.bin:
+//
+// Flash is memory mapped, so once tle.bin is in one contiguous run of
+// flash its records can be read as an array in place, without opening
+// the file and copying each record through the FatFs sector buffer.
+//
+// On the EFR32 and Linux the FAT volume is mapped directly: the file is
+// contiguous if its clusters form a single fragment, and catalog_layout()
+// rewrites it into clusters allocated with f_expand() when they do not.
+// This needs room for a second copy while it runs, and the raw volume
+// (not USE_FTL, whose sectors move around).
+//
+// The ESP32 FAT is behind wear levelling, so catalog_layout() copies
+// tle.bin to the "catalog" partition instead and it is mapped from
+// there while its header still matches tle.bin.
+//
+// Anything that rewrites tle.bin calls catalog_unmap() first.  Without a
+// mapping catalog_get() falls back to reading the file.
+//
+// The LCD task reads records while the console may be rewriting the
+// catalog, so the mapping is only used under a lock and catalog_get()
+// copies the record out before the lock is released.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+#include "catalog.h"
+#include "sat.h"
+#include "fatfs-util.h"
+
+#ifdef __ESP32__
+#include "esp_partition.h"
+
+#define CATALOG_MAP_MAGIC  0x50414D43 // "CMAP"
+
+// Records start at the second flash sector of the partition
+#define CATALOG_MAP_DATA   0x1000
+
+typedef struct {
+	uint32_t magic, size;
+
+	// Date and time of the tle.bin it was copied from
+	WORD fdate, ftime;
+} catalog_map_hdr_t;
+#endif
+
+static struct {
+	// True once a mapping was tried since the last catalog_unmap()
+	int tried;
+
+	const catalog_rec_t *rec;
+	uint32_t count;
+
+#ifdef __ESP32__
+	esp_partition_mmap_handle_t handle;
+#endif
+
+	// Records returned from the mapping and read from the file
+	uint32_t mapped, read;
+} map;
+
+#ifdef __ESP32__
+// Recursive because catalog_layout() calls catalog_unmap()
+static SemaphoreHandle_t map_mutex;
+static StaticSemaphore_t map_mutex_buf;
+#endif
+
+void catalog_map_init()
+{
+#ifdef __ESP32__
+	map_mutex = xSemaphoreCreateRecursiveMutexStatic(&map_mutex_buf);
+#endif
+}
+
+static void catalog_map_lock()
+{
+#ifdef __ESP32__
+	xSemaphoreTakeRecursive(map_mutex, portMAX_DELAY);
+#endif
+}
+
+static void catalog_map_unlock()
+{
+#ifdef __ESP32__
+	xSemaphoreGiveRecursive(map_mutex);
+#endif
+}
+
+#ifdef __ESP32__
+static const esp_partition_t *catalog_partition()
+{
+	return esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+		ESP_PARTITION_SUBTYPE_ANY, "catalog");
+}
+
+static void catalog_map_open()
+{
+	const esp_partition_t *part = catalog_partition();
+	catalog_map_hdr_t hdr;
+	const void *ptr;
+	FILINFO fno;
+
+	if (part == NULL || f_stat("tle.bin", &fno) != FR_OK)
+		return;
+
+	if (esp_partition_read(part, 0, &hdr, sizeof(hdr)) != ESP_OK ||
+		hdr.magic != CATALOG_MAP_MAGIC ||
+		hdr.size != fno.fsize ||
+		hdr.fdate != fno.fdate ||
+		hdr.ftime != fno.ftime ||
+		hdr.size < sizeof(catalog_rec_t))
+		return;
+
+	if (esp_partition_mmap(part, CATALOG_MAP_DATA, hdr.size,
+		ESP_PARTITION_MMAP_DATA, &ptr, &map.handle) != ESP_OK)
+		return;
+
+	map.rec = ptr;
+	map.count = hdr.size / sizeof(catalog_rec_t);
+}
+#else
+static void catalog_map_open()
+{
+	FIL in;
+	FATFS *fs;
+	DWORD tbl[4];
+	FSIZE_t size;
+	const void *ptr;
+
+	if (f_open(&in, "tle.bin", FA_READ) != FR_OK)
+		return;
+
+	size = f_size(&in);
+	fs = in.obj.fs;
+
+	// One fragment is two entries and the terminator after the size.
+	// A fragmented file does not fit and returns FR_NOT_ENOUGH_CORE.
+	tbl[0] = 4;
+	in.cltbl = tbl;
+
+	if (size >= sizeof(catalog_rec_t) && f_lseek(&in, CREATE_LINKMAP) == FR_OK)
+	{
+		ptr = disk_map(fs->database + (tbl[2] - 2) * fs->csize,
+			(size + FF_MIN_SS - 1) / FF_MIN_SS);
+
+		if (ptr != NULL)
+		{
+			map.rec = ptr;
+			map.count = size / sizeof(catalog_rec_t);
+		}
+	}
+
+	f_close(&in);
+}
+#endif
+
+// Map tle.bin if possible.  Returns the records and sets *count, or NULL
+// if the catalog is not mapped.  The records are only valid until the
+// next catalog_unmap(), so other tasks use catalog_get().
+const catalog_rec_t *catalog_map(uint32_t *count)
+{
+	const catalog_rec_t *rec;
+
+	catalog_map_lock();
+
+	if (!map.tried)
+	{
+		map.tried = 1;
+		catalog_map_open();
+	}
+
+	if (count != NULL)
+		*count = map.count;
+	rec = map.rec;
+
+	catalog_map_unlock();
+
+	return rec;
+}
+
+// Drop the mapping before tle.bin is rewritten or the volume changes
+void catalog_unmap()
+{
+	catalog_map_lock();
+
+#ifdef __ESP32__
+	if (map.rec != NULL)
+		esp_partition_munmap(map.handle);
+#endif
+
+	map.rec = NULL;
+	map.count = 0;
+	map.tried = 0;
+
+	catalog_map_unlock();
+}
+
+// Copy record idx of tle.bin into buf from the mapped catalog, or read it
+// from the file.  Returns buf, or NULL past the end.  The record is not
+// checked: use catalog_unpack() or catalog_select() to get its TLE.
+const catalog_rec_t *catalog_get(uint32_t idx, catalog_rec_t *buf)
+{
+	FRESULT res;
+	FIL in;
+	UINT br = 0;
+
+	catalog_map_lock();
+
+	if (catalog_map(NULL) != NULL)
+	{
+		if (idx >= map.count)
+			buf = NULL;
+		else
+		{
+			*buf = map.rec[idx];
+			map.mapped++;
+		}
+
+		catalog_map_unlock();
+
+		return buf;
+	}
+
+	res = f_open(&in, "tle.bin", FA_READ);
+	if (res == FR_OK)
+	{
+		res = f_lseek(&in, sizeof(catalog_rec_t) * idx);
+		if (res == FR_OK)
+			res = f_read(&in, buf, sizeof(catalog_rec_t), &br);
+
+		f_close(&in);
+	}
+
+	if (res != FR_OK || br != sizeof(catalog_rec_t))
+		buf = NULL;
+	else
+		map.read++;
+
+	catalog_map_unlock();
+
+	return buf;
+}
+
+#ifdef __ESP32__
+// Copy filename to the catalog partition with a header that ties it to
+// this version of the file
+static FRESULT catalog_layout_locked(const char *filename)
+{
+	const esp_partition_t *part = catalog_partition();
+	catalog_map_hdr_t hdr;
+	FILINFO fno;
+	FRESULT res;
+	FIL in;
+	UINT br;
+	uint32_t off;
+	char *buf;
+
+	catalog_unmap();
+
+	if (part == NULL)
+		return FR_OK;
+
+	res = f_stat(filename, &fno);
+	if (res != FR_OK)
+		return res;
+
+	if (fno.fsize + CATALOG_MAP_DATA > part->size)
+	{
+		printf("%s: %lu bytes do not fit the catalog partition\r\n",
+			filename, (unsigned long)fno.fsize);
+		return FR_OK;
+	}
+
+	buf = malloc(CATALOG_MAP_DATA);
+	if (buf == NULL)
+		return FR_NOT_ENOUGH_CORE;
+
+	res = f_open(&in, filename, FA_READ);
+	if (res != FR_OK)
+	{
+		free(buf);
+		return res;
+	}
+
+	if (esp_partition_erase_range(part, 0,
+		(fno.fsize + 2*CATALOG_MAP_DATA - 1) / CATALOG_MAP_DATA * CATALOG_MAP_DATA) != ESP_OK)
+		res = FR_DISK_ERR;
+
+	for (off = 0; res == FR_OK && off < fno.fsize; off += br)
+	{
+		res = f_read(&in, buf, CATALOG_MAP_DATA, &br);
+		if (res == FR_OK && br == 0)
+			break;
+
+		if (res == FR_OK &&
+			esp_partition_write(part, CATALOG_MAP_DATA + off, buf, br) != ESP_OK)
+			res = FR_DISK_ERR;
+	}
+
+	f_close(&in);
+	free(buf);
+
+	// The header goes last, so an interrupted copy is never mapped
+	if (res == FR_OK)
+	{
+		hdr.magic = CATALOG_MAP_MAGIC;
+		hdr.size = fno.fsize;
+		hdr.fdate = fno.fdate;
+		hdr.ftime = fno.ftime;
+
+		if (esp_partition_write(part, 0, &hdr, sizeof(hdr)) != ESP_OK)
+			res = FR_DISK_ERR;
+	}
+
+	return res;
+}
+#else
+// Rewrite filename into one contiguous run of clusters so it can be
+// mapped.  If there is no contiguous free space the file is left as it
+// is and read through FatFs.
+static FRESULT catalog_layout_locked(const char *filename)
+{
+	FIL in, out;
+	DWORD tbl[4];
+	FRESULT res;
+	UINT br, bw;
+	BYTE buf[FF_MAX_SS];
+
+	catalog_unmap();
+
+	res = f_open(&in, filename, FA_READ);
+	if (res != FR_OK)
+		return res;
+
+	tbl[0] = 4;
+	in.cltbl = tbl;
+
+	if (f_size(&in) == 0 || f_lseek(&in, CREATE_LINKMAP) == FR_OK)
+	{
+		f_close(&in);
+		return FR_OK;
+	}
+
+	in.cltbl = NULL;
+	f_lseek(&in, 0);
+
+	res = f_open(&out, "tlemap.tmp", FA_CREATE_ALWAYS | FA_WRITE);
+	if (res != FR_OK)
+	{
+		f_close(&in);
+		return res;
+	}
+
+	res = f_expand(&out, f_size(&in), 1);
+	if (res == FR_DENIED)
+	{
+		printf("%s: no contiguous space, it is read through FatFs\r\n", filename);
+		f_close(&in);
+		f_close(&out);
+		f_unlink("tlemap.tmp");
+
+		return FR_OK;
+	}
+
+	while (res == FR_OK)
+	{
+		res = f_read(&in, buf, sizeof(buf), &br);
+		if (res != FR_OK || br == 0)
+			break;
+
+		res = f_write(&out, buf, br, &bw);
+		if (res == FR_OK && bw < br)
+			res = FR_DENIED;
+	}
+
+	f_close(&in);
+
+	if (res == FR_OK)
+		res = f_close(&out);
+	else
+		f_close(&out);
+
+	if (res == FR_OK)
+		res = f_unlink(filename);
+	if (res == FR_OK)
+		res = f_rename("tlemap.tmp", filename);
+	else
+		f_unlink("tlemap.tmp");
+
+	return res;
+}
+#endif
+
+// Nothing is mapped or read from the catalog while it is laid out
+FRESULT catalog_layout(const char *filename)
+{
+	FRESULT res;
+
+	catalog_map_lock();
+	res = catalog_layout_locked(filename);
+	catalog_map_unlock();
+
+	return res;
+}
+
+void catalog_map_status()
+{
+	uint32_t count;
+	const catalog_rec_t *rec = catalog_map(&count);
+
+	if (rec != NULL)
+		printf("tle.bin: %lu records mapped at %p\r\n", (unsigned long)count, rec);
+	else
+		printf("tle.bin: not mapped, records are read through FatFs\r\n");
+
+	printf("records: %lu mapped, %lu read\r\n",
+		(unsigned long)map.mapped, (unsigned long)map.read);
+}
+
+// Check every record of tle.bin and that catalog_select() prepares it
+// the same way select_ephemeris() does.
+void catalog_check()
+{
+	const catalog_rec_t *rec;
+	catalog_rec_t buf;
+	tle_t a, b;
+	uint32_t i, bad = 0, differ = 0;
+	int deep;
+
+	for (i = 0; (rec = catalog_get(i, &buf)) != NULL; i++)
+	{
+		if (!catalog_rec_valid(rec))
+		{
+			if (bad++ < 5)
+				printf("record %lu: bad CRC or version %d\r\n",
+					(unsigned long)i, rec->version);
+			continue;
+		}
+
+		// Both set the SGP4 flags the tracked satellite uses
+		sat_lock();
+		catalog_select(rec, &a);
+		deep = isFlagSet(DEEP_SPACE_EPHEM_FLAG);
+
+		catalog_unpack(rec, &b);
+		ClearFlag(ALL_FLAGS);
+		select_ephemeris(&b);
+		if (deep != isFlagSet(DEEP_SPACE_EPHEM_FLAG))
+			deep = -1;
+
+		sat_reselect();
+		sat_unlock();
+
+		if (memcmp(&a, &b, sizeof(a)) || deep < 0)
+		{
+			if (differ++ < 5)
+				printf("[%5d] %s: catalog_select() differs from select_ephemeris()\r\n",
+					(int)rec->catnr, a.sat_name);
+		}
+	}
+
+	printf("tle.bin: %lu records of %d bytes, version %d: %lu bad, %lu differ\r\n",
+		(unsigned long)i, (int)sizeof(catalog_rec_t), CATALOG_REC_VERSION,
+		(unsigned long)bad, (unsigned long)differ);
+}
@@ -0,0 +1,1129 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+
+// Streaming catalog ingest:
+//
+// Text is passed to catalog_feed() in whatever chunks it arrives in: read
+// from a file, received by xmodem or downloaded.  Lines are parsed where
+// they lie in the chunk and only a line split between two chunks is
+// copied.  TLE fields are read straight from their fixed columns into the
+// same tle_t fields Convert_Satellite_Data() fills, with the checksum of
+// each line checked.  OMM CSV as published by Celestrak and Space-Track
+// is read the same way once its header line is seen; it carries full
+// precision and catalog numbers above 99999 that TLE text cannot hold.
+// Records are collected into sector-sized
+// batches before they are written.  A catalog number that appears again
+// replaces the earlier record only if its epoch is newer.  The catalog is
+// built in a temporary file and renamed over the old one at the end, so
+// the old catalog stays usable until the new one is complete.
+//
+// catalog_merge() updates an existing catalog instead: only records whose
+// epoch moved forward are rewritten in place and new objects are
+// appended, so a refresh writes a few sectors instead of the whole file
+// and record numbers stay the same.  The catalog number index in tle.idx
+// is loaded to find existing records, and is written to a temporary file
+// and renamed into place at the end.
+//
+// Each parsed tle_t is packed into a catalog_rec_t before it is stored.
+// Records are smaller than tle_t, carry a version and a CRC, and hold
+// the deep space choice select_ephemeris() makes, so catalog_select()
+// turns one into a tle_t ready for SGP4/SDP4 with a few multiplications.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include "sgp4sdp4.h"
+
+#include "catalog.h"
+#include "sat.h"
+#include "pass.h"
+#include "rtcc.h"
+#include "strutil.h"
+
+#include "ff.h"
+#include "fatfs-util.h"
+
+#define CATALOG_TMP       "catalog.tmp"
+#define CATALOG_IDX_TMP   "tleidx.tmp"
+
+// Bytes read from the text file at a time
+#define CATALOG_READ_SIZE 2048
+
+// Verify the modulo 10 checksum in column 69 of a TLE line
+static int catalog_checksum(const char *s)
+{
+	int i, sum = 0;
+
+	for (i = 0; i < 68; i++)
+	{
+		if (isdigit((unsigned char)s[i]))
+			sum += s[i] - '0';
+		else if (s[i] == '-')
+			sum++;
+	}
+
+	return isdigit((unsigned char)s[68]) && sum % 10 == s[68] - '0';
+}
+
+// Fixed-column number of len characters at s
+static double catalog_num(const char *s, int len)
+{
+	char buf[16];
+
+	memcpy(buf, s, len);
+	buf[len] = 0;
+
+	return atof(buf);
+}
+
+// Fixed-column number with an assumed leading decimal point and a
+// trailing exponent, like " 13844-3" for 0.13844E-3
+static double catalog_exp(const char *s)
+{
+	char buf[12];
+
+	buf[0] = s[0];
+	buf[1] = '.';
+	memcpy(buf+2, s+1, 5);
+	buf[7] = 'E';
+	memcpy(buf+8, s+6, 2);
+	buf[10] = 0;
+
+	return atof(buf);
+}
+
+static uint32_t catalog_rec_crc(const catalog_rec_t *rec)
+{
+	return crc32_ieee((const uint8_t *)rec + sizeof(rec->crc),
+		sizeof(*rec) - sizeof(rec->crc));
+}
+
+// True if rec has the current version and a good CRC
+int catalog_rec_valid(const catalog_rec_t *rec)
+{
+	return rec->version == CATALOG_REC_VERSION && rec->crc == catalog_rec_crc(rec);
+}
+
+static void catalog_rec_tle(const catalog_rec_t *rec, tle_t *tle)
+{
+	memset(tle, 0, sizeof(*tle));
+
+	tle->catnr = rec->catnr;
+	tle->epoch = rec->epoch;
+	tle->xno = rec->xno;
+	tle->xndt2o = rec->xndt2o;
+	tle->xndd6o = rec->xndd6o;
+	tle->bstar = rec->bstar;
+	tle->xincl = rec->xincl;
+	tle->xnodeo = rec->xnodeo;
+	tle->eo = rec->eo;
+	tle->omegao = rec->omegao;
+	tle->xmo = rec->xmo;
+	tle->revnum = rec->revnum;
+	tle->elset = rec->elset;
+	memcpy(tle->sat_name, rec->sat_name, sizeof(rec->sat_name));
+	memcpy(tle->idesg, rec->idesg, sizeof(rec->idesg));
+}
+
+// Fill rec from the raw TLE.  The deep space choice is made from the
+// values as they are stored, so it matches what select_ephemeris() does
+// with the unpacked record.
+void catalog_pack(const tle_t *tle, catalog_rec_t *rec)
+{
+	double temp, xno, xincl, eo, a1, r1, del1, ao, delo, xnodp;
+
+	memset(rec, 0, sizeof(*rec));
+
+	rec->catnr = tle->catnr;
+	rec->epoch = tle->epoch;
+	rec->xno = tle->xno;
+	rec->xndt2o = tle->xndt2o;
+	rec->xndd6o = tle->xndd6o;
+	rec->bstar = tle->bstar;
+	rec->xincl = tle->xincl;
+	rec->xnodeo = tle->xnodeo;
+	rec->eo = tle->eo;
+	rec->omegao = tle->omegao;
+	rec->xmo = tle->xmo;
+	rec->revnum = tle->revnum;
+	rec->elset = tle->elset;
+	rec->version = CATALOG_REC_VERSION;
+	strncpy(rec->sat_name, tle->sat_name, sizeof(rec->sat_name));
+	strncpy(rec->idesg, tle->idesg, sizeof(rec->idesg));
+
+	// Recovered mean motion and semi-major axis as in select_ephemeris()
+	temp = twopi/xmnpda/xmnpda;
+	xno = rec->xno*temp*xmnpda;
+	xincl = rec->xincl*de2ra;
+	eo = rec->eo;
+
+	a1 = pow(xke/xno, tothrd);
+	r1 = cos(xincl);
+	temp = ck2*1.5*(r1*r1*3.0-1.0)/pow(1.0-eo*eo, 1.5);
+	del1 = temp/(a1*a1);
+	ao = a1*(1.0-del1*(tothrd*0.5+del1*(del1*1.654320987654321+1.0)));
+	delo = temp/(ao*ao);
+
+	xnodp = xno/(delo+1.0);
+
+	// Period of 225 minutes or more
+	if (twopi/xnodp/xmnpda >= .15625)
+		rec->flags |= CATALOG_REC_DEEP;
+
+	rec->crc = catalog_rec_crc(rec);
+}
+
+// Fill tle with the raw TLE in rec.  Returns 0 if rec is damaged or from
+// another version, and tle is not touched.
+int catalog_unpack(const catalog_rec_t *rec, tle_t *tle)
+{
+	if (!catalog_rec_valid(rec))
+		return 0;
+
+	catalog_rec_tle(rec, tle);
+
+	return 1;
+}
+
+// Fill tle with rec converted the way select_ephemeris() converts a raw
+// TLE, and set DEEP_SPACE_EPHEM_FLAG from the record instead of working
+// it out again.  Returns 0 if rec is damaged.
+int catalog_select(const catalog_rec_t *rec, tle_t *tle)
+{
+	double temp = twopi/xmnpda/xmnpda;
+
+	if (!catalog_unpack(rec, tle))
+		return 0;
+
+	tle->xnodeo *= de2ra;
+	tle->omegao *= de2ra;
+	tle->xmo *= de2ra;
+	tle->xincl *= de2ra;
+	tle->xno = tle->xno*temp*xmnpda;
+	tle->xndt2o *= temp;
+	tle->xndd6o = tle->xndd6o*temp/xmnpda;
+	tle->bstar /= ae;
+
+	ClearFlag(ALL_FLAGS);
+	if (rec->flags & CATALOG_REC_DEEP)
+		SetFlag(DEEP_SPACE_EPHEM_FLAG);
+
+	return 1;
+}
+
+static uint32_t catalog_hash(int32_t catnr)
+{
+	return ((uint32_t)catnr * 2654435761u) >> (32 - CATALOG_HASH_BITS);
+}
+
+// Hash slot of catnr, or the empty slot where it would go
+static catalog_idx_t *catalog_slot(catalog_t *cat, int32_t catnr)
+{
+	uint32_t h;
+
+	for (h = catalog_hash(catnr);
+		cat->hash[h].catnr != 0 && cat->hash[h].catnr != catnr;
+		h = (h + 1) & (CATALOG_HASH_SLOTS - 1))
+		;
+
+	return &cat->hash[h];
+}
+
+// Add catnr at record idx to the hash table if there is room.
+static void catalog_index(catalog_t *cat, int32_t catnr, uint32_t idx)
+{
+	catalog_idx_t *slot = catalog_slot(cat, catnr);
+
+	if (slot->catnr == catnr)
+		return;
+
+	if (cat->indexed >= CATALOG_HASH_MAX)
+	{
+		cat->unindexed++;
+		return;
+	}
+
+	slot->catnr = catnr;
+	slot->idx = idx;
+	cat->indexed++;
+}
+
+static int catalog_idx_cmp(const void *a, const void *b)
+{
+	const catalog_idx_t *x = a, *y = b;
+
+	return (x->catnr > y->catnr) - (x->catnr < y->catnr);
+}
+
+static FRESULT catalog_flush(catalog_t *cat)
+{
+	UINT bw;
+
+	if (cat->wbuf_len == 0 || cat->res != FR_OK)
+		return cat->res;
+
+	cat->res = f_write(&cat->out, cat->wbuf, sizeof(catalog_rec_t) * cat->wbuf_len, &bw);
+	if (cat->res == FR_OK && bw < sizeof(catalog_rec_t) * cat->wbuf_len)
+		cat->res = FR_DENIED;
+
+	cat->flushed += cat->wbuf_len;
+	cat->wbuf_len = 0;
+
+	return cat->res;
+}
+
+// Replace record idx with tle if tle has a newer epoch.
+static void catalog_replace(catalog_t *cat, uint32_t idx, tle_t *tle)
+{
+	catalog_rec_t old;
+	UINT br;
+
+	cat->duplicates++;
+
+	if (idx >= cat->flushed)
+	{
+		catalog_rec_t *rec = &cat->wbuf[idx - cat->flushed];
+
+		if (Julian_Date_of_Epoch(tle->epoch) > Julian_Date_of_Epoch(rec->epoch))
+		{
+			catalog_pack(tle, rec);
+			cat->replaced++;
+		}
+
+		return;
+	}
+
+	// Already written, so update it in the file and go back to the end
+	if (catalog_flush(cat) != FR_OK)
+		return;
+
+	cat->res = f_lseek(&cat->out, sizeof(catalog_rec_t) * idx);
+	if (cat->res == FR_OK)
+		cat->res = f_read(&cat->out, &old, sizeof(old), &br);
+
+	// A damaged record is always replaced
+	if (cat->res == FR_OK &&
+		(!catalog_rec_valid(&old) ||
+			Julian_Date_of_Epoch(tle->epoch) > Julian_Date_of_Epoch(old.epoch)))
+	{
+		catalog_pack(tle, &old);
+
+		cat->res = f_lseek(&cat->out, sizeof(catalog_rec_t) * idx);
+		if (cat->res == FR_OK)
+			cat->res = f_write(&cat->out, &old, sizeof(old), &br);
+		cat->replaced++;
+	}
+
+	if (cat->res == FR_OK)
+		cat->res = f_lseek(&cat->out, sizeof(catalog_rec_t) * cat->flushed);
+}
+
+// Add one element set to the catalog, deduplicated by catalog number.
+void catalog_add(catalog_t *cat, tle_t *tle)
+{
+	catalog_idx_t *slot;
+
+	if (tle->catnr == 0)
+	{
+		cat->bad_format++;
+		return;
+	}
+
+	if (cat->hash != NULL)
+	{
+		slot = catalog_slot(cat, tle->catnr);
+		if (slot->catnr == tle->catnr)
+		{
+			catalog_replace(cat, slot->idx, tle);
+			return;
+		}
+
+		catalog_index(cat, tle->catnr, cat->flushed + cat->wbuf_len);
+	}
+	else
+		cat->unindexed++;
+
+	catalog_pack(tle, &cat->wbuf[cat->wbuf_len++]);
+	cat->objects++;
+
+	if (cat->wbuf_len == CATALOG_WRITE_RECS)
+		catalog_flush(cat);
+}
+
+static void catalog_line1(catalog_t *cat, const char *s)
+{
+	tle_t *tle = &cat->tle;
+
+	tle->catnr = catalog_num(s+2, 5);
+	memcpy(tle->idesg, s+9, 8);
+	tle->idesg[8] = 0;
+	tle->epoch = catalog_num(s+18, 14);
+	tle->xndt2o = catalog_num(s+33, 10);
+	tle->xndd6o = catalog_exp(s+44);
+	tle->bstar = catalog_exp(s+53);
+	tle->elset = catalog_num(s+64, 4);
+}
+
+static void catalog_line2(catalog_t *cat, const char *s)
+{
+	tle_t *tle = &cat->tle;
+	char buf[9];
+
+	tle->xincl = catalog_num(s+8, 8);
+	tle->xnodeo = catalog_num(s+17, 8);
+
+	buf[0] = '.';
+	memcpy(buf+1, s+26, 7);
+	buf[8] = 0;
+	tle->eo = atof(buf);
+
+	tle->omegao = catalog_num(s+34, 8);
+	tle->xmo = catalog_num(s+43, 8);
+	tle->xno = catalog_num(s+52, 11);
+	tle->revnum = catalog_num(s+63, 5);
+}
+
+// OMM fields that are used, in the order of catalog_omm_names[]
+enum {
+	OMM_NONE = -1,
+	OMM_OBJECT_NAME,
+	OMM_OBJECT_ID,
+	OMM_EPOCH,
+	OMM_MEAN_MOTION,
+	OMM_ECCENTRICITY,
+	OMM_INCLINATION,
+	OMM_RA_OF_ASC_NODE,
+	OMM_ARG_OF_PERICENTER,
+	OMM_MEAN_ANOMALY,
+	OMM_NORAD_CAT_ID,
+	OMM_ELEMENT_SET_NO,
+	OMM_REV_AT_EPOCH,
+	OMM_BSTAR,
+	OMM_MEAN_MOTION_DOT,
+	OMM_MEAN_MOTION_DDOT,
+	OMM_FIELDS
+};
+
+static const char *catalog_omm_names[OMM_FIELDS] = {
+	"OBJECT_NAME",
+	"OBJECT_ID",
+	"EPOCH",
+	"MEAN_MOTION",
+	"ECCENTRICITY",
+	"INCLINATION",
+	"RA_OF_ASC_NODE",
+	"ARG_OF_PERICENTER",
+	"MEAN_ANOMALY",
+	"NORAD_CAT_ID",
+	"ELEMENT_SET_NO",
+	"REV_AT_EPOCH",
+	"BSTAR",
+	"MEAN_MOTION_DOT",
+	"MEAN_MOTION_DDOT",
+};
+
+// A row must have these to be usable
+#define OMM_REQUIRED ((1 << OMM_EPOCH) | (1 << OMM_MEAN_MOTION) | \
+	(1 << OMM_ECCENTRICITY) | (1 << OMM_INCLINATION) | \
+	(1 << OMM_RA_OF_ASC_NODE) | (1 << OMM_ARG_OF_PERICENTER) | \
+	(1 << OMM_MEAN_ANOMALY) | (1 << OMM_NORAD_CAT_ID))
+
+// Split the next CSV field off of s, removing surrounding quotes.  The
+// field is returned in *field and *flen, and the number of characters
+// consumed including the comma is returned.
+static int catalog_csv_field(const char *s, int len, const char **field, int *flen)
+{
+	int i = 0;
+
+	if (len > 0 && s[0] == '"')
+	{
+		for (i = 1; i < len && s[i] != '"'; i++)
+			;
+
+		*field = s + 1;
+		*flen = i - 1;
+
+		// Skip the closing quote
+		if (i < len)
+			i++;
+	}
+	else
+	{
+		for (i = 0; i < len && s[i] != ','; i++)
+			;
+
+		*field = s;
+		*flen = i;
+	}
+
+	while (i < len && s[i] != ',')
+		i++;
+
+	if (i < len)
+		i++;
+
+	return i;
+}
+
+// Read the header line and map each column to its field.
+static void catalog_omm_header(catalog_t *cat, const char *s, int len)
+{
+	const char *field;
+	int flen, col, i, n;
+
+	for (col = 0; col < CATALOG_OMM_COLS; col++)
+	{
+		cat->omm_col[col] = OMM_NONE;
+
+		if (len <= 0)
+			continue;
+
+		n = catalog_csv_field(s, len, &field, &flen);
+		s += n;
+		len -= n;
+
+		for (i = 0; i < OMM_FIELDS; i++)
+			if (strlen(catalog_omm_names[i]) == flen &&
+				!memcmp(catalog_omm_names[i], field, flen))
+			{
+				cat->omm_col[col] = i;
+				break;
+			}
+	}
+
+	cat->omm = 1;
+}
+
+// Convert an OMM epoch like 2024-01-31T12:00:00.000000 to the TLE epoch
+// format YYDDD.DDDDDDDD.
+static double catalog_omm_epoch(const char *s)
+{
+	static const int days[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
+	int year, mon, day, hour = 0, min = 0, doy;
+	double sec = 0;
+
+	if (strlen(s) < 10 || s[4] != '-' || s[7] != '-')
+		return 0;
+
+	year = atoi(s);
+	mon = atoi(s+5);
+	day = atoi(s+8);
+
+	if (s[10] == 'T' && strlen(s) >= 19)
+	{
+		hour = atoi(s+11);
+		min = atoi(s+14);
+		sec = atof(s+17);
+	}
+
+	if (mon < 1 || mon > 12)
+		return 0;
+
+	doy = days[mon-1] + day;
+	if (mon > 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))
+		doy++;
+
+	return (year % 100) * 1000.0 + doy + (hour * 3600 + min * 60 + sec) / 86400;
+}
+
+// Parse one OMM CSV row.
+static void catalog_omm_row(catalog_t *cat, const char *s, int len)
+{
+	tle_t *tle = &cat->tle;
+	const char *field;
+	char buf[40];
+	int flen, col, n, f, seen = 0;
+	double v;
+
+	memset(tle, 0, sizeof(*tle));
+
+	for (col = 0; col < CATALOG_OMM_COLS && len > 0; col++)
+	{
+		n = catalog_csv_field(s, len, &field, &flen);
+		s += n;
+		len -= n;
+
+		f = cat->omm_col[col];
+		if (f == OMM_NONE || flen == 0)
+			continue;
+
+		if (flen > sizeof(buf) - 1)
+			flen = sizeof(buf) - 1;
+
+		memcpy(buf, field, flen);
+		buf[flen] = 0;
+
+		seen |= 1 << f;
+		v = atof(buf);
+
+		switch (f)
+		{
+			case OMM_OBJECT_NAME:
+				if (flen > sizeof(tle->sat_name) - 1)
+					flen = sizeof(tle->sat_name) - 1;
+				memcpy(tle->sat_name, buf, flen);
+				tle->sat_name[flen] = 0;
+				break;
+
+			// 1998-067A is 98067A in a TLE
+			case OMM_OBJECT_ID:
+				if (flen > 5 && buf[4] == '-')
+					snprintf(tle->idesg, sizeof(tle->idesg), "%.2s%s", buf+2, buf+5);
+				else
+					snprintf(tle->idesg, sizeof(tle->idesg), "%s", buf);
+				break;
+
+			case OMM_EPOCH:             tle->epoch = catalog_omm_epoch(buf); break;
+			case OMM_MEAN_MOTION:       tle->xno = v; break;
+			case OMM_ECCENTRICITY:      tle->eo = v; break;
+			case OMM_INCLINATION:       tle->xincl = v; break;
+			case OMM_RA_OF_ASC_NODE:    tle->xnodeo = v; break;
+			case OMM_ARG_OF_PERICENTER: tle->omegao = v; break;
+			case OMM_MEAN_ANOMALY:      tle->xmo = v; break;
+			case OMM_NORAD_CAT_ID:      tle->catnr = v; break;
+			case OMM_ELEMENT_SET_NO:    tle->elset = v; break;
+			case OMM_REV_AT_EPOCH:      tle->revnum = v; break;
+			case OMM_BSTAR:             tle->bstar = v; break;
+			case OMM_MEAN_MOTION_DOT:   tle->xndt2o = v; break;
+			case OMM_MEAN_MOTION_DDOT:  tle->xndd6o = v; break;
+		}
+	}
+
+	if ((seen & OMM_REQUIRED) != OMM_REQUIRED || tle->epoch == 0 || tle->xno <= 0)
+	{
+		cat->bad_format++;
+		return;
+	}
+
+	if (tle->sat_name[0] == 0)
+		snprintf(tle->sat_name, sizeof(tle->sat_name), "%d", tle->catnr);
+
+	catalog_add(cat, tle);
+	memset(tle, 0, sizeof(*tle));
+}
+
+// True if the line is an OMM CSV header
+static int catalog_omm_is_header(const char *s, int len)
+{
+	static const char key[] = "NORAD_CAT_ID";
+	int i;
+
+	for (i = 0; i + (int)sizeof(key) - 1 <= len; i++)
+		if (!memcmp(s + i, key, sizeof(key) - 1))
+			return 1;
+
+	return 0;
+}
+
+// Handle one line of text without its line ending.
+static void catalog_line(catalog_t *cat, const char *s, int len)
+{
+	tle_t *tle = &cat->tle;
+
+	// xmodem pads the last block with ^Z
+	while (len > 0 && (isspace((unsigned char)s[len-1]) || s[len-1] == 0x1A))
+		len--;
+
+	if (len == 0)
+		return;
+
+	cat->lines++;
+
+	// The header can also be repeated when CSV files are concatenated
+	if (s[0] >= 'A' && s[0] <= 'Z' && catalog_omm_is_header(s, len))
+		catalog_omm_header(cat, s, len);
+	else if (cat->omm)
+		catalog_omm_row(cat, s, len);
+	else if (len >= 69 && s[0] == '1' && s[1] == ' ')
+	{
+		cat->have_line1 = 0;
+		if (!catalog_checksum(s))
+		{
+			cat->bad_checksum++;
+			return;
+		}
+
+		catalog_line1(cat, s);
+		cat->have_line1 = 1;
+	}
+	else if (len >= 69 && s[0] == '2' && s[1] == ' ')
+	{
+		if (!cat->have_line1)
+		{
+			cat->bad_format++;
+			return;
+		}
+
+		cat->have_line1 = 0;
+		if (!catalog_checksum(s))
+		{
+			cat->bad_checksum++;
+			return;
+		}
+
+		if ((int)catalog_num(s+2, 5) != tle->catnr)
+		{
+			cat->bad_format++;
+			return;
+		}
+
+		catalog_line2(cat, s);
+
+		if (!cat->have_name)
+			snprintf(tle->sat_name, sizeof(tle->sat_name), "%d", tle->catnr);
+
+		catalog_add(cat, tle);
+
+		memset(tle, 0, sizeof(*tle));
+		cat->have_name = 0;
+	}
+	else
+	{
+		// Name line, Space-Track's 3LE format starts it with "0 "
+		if (len > 2 && s[0] == '0' && s[1] == ' ')
+		{
+			s += 2;
+			len -= 2;
+		}
+
+		if (len > sizeof(tle->sat_name) - 1)
+			len = sizeof(tle->sat_name) - 1;
+
+		memcpy(tle->sat_name, s, len);
+		tle->sat_name[len] = 0;
+		cat->have_name = 1;
+		cat->have_line1 = 0;
+	}
+}
+
+// The index of tle.bin is tle.idx
+static void catalog_idx_name(catalog_t *cat)
+{
+	char *dot;
+
+	strcpy(cat->idxname, cat->filename);
+
+	dot = strrchr(cat->idxname, '.');
+	if (dot == NULL)
+		dot = cat->idxname + strlen(cat->idxname);
+	if (dot - cat->idxname > sizeof(cat->idxname) - 5)
+		dot = cat->idxname + sizeof(cat->idxname) - 5;
+
+	strcpy(dot, ".idx");
+}
+
+// Start building filename.  Records go to a temporary file until
+// catalog_end().
+FRESULT catalog_begin(catalog_t *cat, const char *filename)
+{
+	memset(cat, 0, sizeof(*cat));
+
+	strncpy(cat->filename, filename, sizeof(cat->filename)-1);
+	catalog_idx_name(cat);
+
+	cat->res = f_open(&cat->out, CATALOG_TMP, FA_CREATE_ALWAYS | FA_WRITE | FA_READ);
+	if (cat->res != FR_OK)
+	{
+		printf("%s: error %d: %s\r\n", CATALOG_TMP, cat->res, ff_strerror(cat->res));
+		return cat->res;
+	}
+
+	// Without memory for the hash table records are not deduplicated
+	cat->hash = calloc(CATALOG_HASH_SLOTS, sizeof(*cat->hash));
+	if (cat->hash == NULL)
+		printf("catalog: not enough memory to deduplicate\r\n");
+
+	cat->start = rtcc_get();
+
+	return FR_OK;
+}
+
+// Fill the hash table from the index.  Returns false if there is no index
+// or it was not written for a catalog of this size.
+static int catalog_load_index(catalog_t *cat)
+{
+	catalog_idx_hdr_t hdr;
+	catalog_idx_t *ent = (catalog_idx_t*)cat->wbuf;
+	uint32_t i, n;
+	FRESULT res;
+	FIL in;
+	UINT br;
+
+	if (f_open(&in, cat->idxname, FA_READ) != FR_OK)
+		return 0;
+
+	res = f_read(&in, &hdr, sizeof(hdr), &br);
+	if (res != FR_OK || br < sizeof(hdr) ||
+		hdr.magic != CATALOG_IDX_MAGIC ||
+		hdr.records != cat->flushed ||
+		hdr.count > CATALOG_HASH_MAX)
+	{
+		f_close(&in);
+		return 0;
+	}
+
+	// The write buffer is still empty, so entries are read through it
+	for (n = 0; n < hdr.count; n += br / sizeof(*ent))
+	{
+		res = f_read(&in, ent, sizeof(cat->wbuf), &br);
+		if (res != FR_OK || br < sizeof(*ent))
+			break;
+
+		for (i = 0; i < br / sizeof(*ent) && n + i < hdr.count; i++)
+			if (ent[i].idx < cat->flushed)
+				catalog_index(cat, ent[i].catnr, ent[i].idx);
+	}
+
+	f_close(&in);
+
+	if (n < hdr.count)
+	{
+		memset(cat->hash, 0, CATALOG_HASH_SLOTS * sizeof(*cat->hash));
+		cat->indexed = 0;
+		cat->unindexed = 0;
+		return 0;
+	}
+
+	return 1;
+}
+
+// Fill the hash table by reading every record of the catalog.
+static FRESULT catalog_scan(catalog_t *cat)
+{
+	uint32_t i, n = 0;
+	UINT br;
+
+	cat->res = f_lseek(&cat->out, 0);
+
+	while (cat->res == FR_OK && n < cat->flushed)
+	{
+		cat->res = f_read(&cat->out, cat->wbuf, sizeof(cat->wbuf), &br);
+
+		for (i = 0; i < br / sizeof(catalog_rec_t) && n < cat->flushed; i++, n++)
+			if (cat->wbuf[i].catnr != 0)
+				catalog_index(cat, cat->wbuf[i].catnr, n);
+
+		if (br < sizeof(cat->wbuf))
+			break;
+	}
+
+	return cat->res;
+}
+
+// Write the index of the hash table to tle.idx through a temporary file.
+// This reorders the hash table, so it cannot be used after this.
+static FRESULT catalog_write_index(catalog_t *cat)
+{
+	catalog_idx_hdr_t hdr;
+	uint32_t h, n = 0;
+	FRESULT res;
+	FIL out;
+	UINT bw;
+
+	f_unlink(cat->idxname);
+
+	// An index that is missing objects would be worse than none
+	if (cat->hash == NULL || cat->unindexed)
+		return FR_OK;
+
+	for (h = 0; h < CATALOG_HASH_SLOTS; h++)
+		if (cat->hash[h].catnr != 0)
+			cat->hash[n++] = cat->hash[h];
+
+	qsort(cat->hash, n, sizeof(*cat->hash), catalog_idx_cmp);
+
+	hdr.magic = CATALOG_IDX_MAGIC;
+	hdr.count = n;
+	hdr.records = cat->flushed;
+
+	res = f_open(&out, CATALOG_IDX_TMP, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res != FR_OK)
+		return res;
+
+	res = f_write(&out, &hdr, sizeof(hdr), &bw);
+	if (res == FR_OK)
+		res = f_write(&out, cat->hash, n * sizeof(*cat->hash), &bw);
+	if (res == FR_OK && bw < n * sizeof(*cat->hash))
+		res = FR_DENIED;
+
+	f_close(&out);
+
+	if (res == FR_OK)
+		res = f_rename(CATALOG_IDX_TMP, cat->idxname);
+	else
+		f_unlink(CATALOG_IDX_TMP);
+
+	return res;
+}
+
+// Start merging into the existing catalog filename, which is created if
+// it does not exist.  Records are updated in place and new objects are
+// appended at catalog_end().  A catalog with more objects than the hash
+// table holds cannot be merged into.
+FRESULT catalog_merge(catalog_t *cat, const char *filename)
+{
+	memset(cat, 0, sizeof(*cat));
+
+	strncpy(cat->filename, filename, sizeof(cat->filename)-1);
+	catalog_idx_name(cat);
+	cat->merge = 1;
+
+	// Records are rewritten in place under the mapping
+	catalog_unmap();
+
+	// Merging without deduplication would append every object again
+	cat->hash = calloc(CATALOG_HASH_SLOTS, sizeof(*cat->hash));
+	if (cat->hash == NULL)
+	{
+		printf("catalog: not enough memory to merge\r\n");
+		return FR_NOT_ENOUGH_CORE;
+	}
+
+	cat->res = f_open(&cat->out, filename, FA_OPEN_ALWAYS | FA_WRITE | FA_READ);
+	if (cat->res != FR_OK)
+	{
+		printf("%s: error %d: %s\r\n", filename, cat->res, ff_strerror(cat->res));
+		free(cat->hash);
+		cat->hash = NULL;
+		return cat->res;
+	}
+
+	cat->start = rtcc_get();
+
+	// A partial record left by an interrupted append is dropped
+	cat->flushed = f_size(&cat->out) / sizeof(catalog_rec_t);
+
+	// Merging into a catalog in another record format would mix them
+	if (cat->flushed > 0)
+	{
+		UINT br;
+
+		cat->res = f_read(&cat->out, cat->wbuf, sizeof(catalog_rec_t), &br);
+		if (cat->res == FR_OK && !catalog_rec_valid(cat->wbuf))
+		{
+			printf("%s: not in record format %d, run `sat import` first\r\n",
+				filename, CATALOG_REC_VERSION);
+			cat->res = FR_INVALID_OBJECT;
+		}
+	}
+
+	if (cat->res == FR_OK && !catalog_load_index(cat))
+		catalog_scan(cat);
+
+	// Objects missing from the hash table would be appended again
+	if (cat->res == FR_OK && cat->unindexed)
+	{
+		printf("%s: too many objects to merge, run `sat import` instead\r\n",
+			filename);
+		cat->res = FR_DENIED;
+	}
+
+	if (cat->res == FR_OK)
+		cat->res = f_lseek(&cat->out, sizeof(catalog_rec_t) * cat->flushed);
+	if (cat->res == FR_OK)
+		cat->res = f_truncate(&cat->out);
+
+	if (cat->res != FR_OK)
+	{
+		printf("%s: error %d: %s\r\n", filename, cat->res, ff_strerror(cat->res));
+		f_close(&cat->out);
+		free(cat->hash);
+		cat->hash = NULL;
+	}
+
+	return cat->res;
+}
+
+// Parse the next chunk of TLE text.
+void catalog_feed(catalog_t *cat, const char *data, int len)
+{
+	const char *end = data + len, *nl;
+	int n;
+
+	cat->bytes += len;
+
+	while (data < end)
+	{
+		nl = memchr(data, '\n', end - data);
+		if (nl == NULL)
+		{
+			// Keep the start of a line until the next chunk
+			n = end - data;
+			if (cat->line_len + n > CATALOG_LINE_MAX)
+				n = CATALOG_LINE_MAX - cat->line_len;
+
+			memcpy(cat->line + cat->line_len, data, n);
+			cat->line_len += n;
+			return;
+		}
+
+		if (cat->line_len > 0)
+		{
+			n = nl - data;
+			if (cat->line_len + n > CATALOG_LINE_MAX)
+				n = CATALOG_LINE_MAX - cat->line_len;
+
+			memcpy(cat->line + cat->line_len, data, n);
+			catalog_line(cat, cat->line, cat->line_len + n);
+			cat->line_len = 0;
+		}
+		else
+			catalog_line(cat, data, nl - data);
+
+		data = nl + 1;
+	}
+}
+
+// catalog_feed() with the chunk callback signature used by xmodem and
+// http_get, ctx is the catalog_t.
+void catalog_chunk(void *ctx, void *buf, int len)
+{
+	catalog_feed((catalog_t*)ctx, buf, len);
+}
+
+// Write the last records, replace the catalog with the new one and print
+// a summary.
+FRESULT catalog_end(catalog_t *cat)
+{
+	FRESULT res;
+	float sec;
+
+	if (cat->line_len > 0)
+		catalog_line(cat, cat->line, cat->line_len);
+
+	catalog_flush(cat);
+
+	f_close(&cat->out);
+
+	catalog_unmap();
+
+	if (cat->merge)
+	{
+		if (cat->res == FR_OK && (cat->objects > 0 || cat->replaced > 0))
+			cat->res = catalog_write_index(cat);
+	}
+	else if (cat->res == FR_OK && cat->objects > 0)
+	{
+		f_unlink(cat->idxname);
+		f_unlink(cat->filename);
+		cat->res = f_rename(CATALOG_TMP, cat->filename);
+
+		if (cat->res == FR_OK)
+			cat->res = catalog_write_index(cat);
+	}
+	else
+		f_unlink(CATALOG_TMP);
+
+	free(cat->hash);
+	cat->hash = NULL;
+
+	sec = rtcc_elapsed_sec(cat->start);
+
+	if (cat->merge)
+		printf("%s: %u records, %u new, %u updated, %u unchanged from %u lines, "
+			"%u bad checksums, %u bad lines",
+			cat->filename, cat->flushed, cat->objects, cat->replaced,
+			cat->duplicates - cat->replaced, cat->lines,
+			cat->bad_checksum, cat->bad_format);
+	else
+		printf("%s: %u objects from %u lines, %u duplicates (%u newer), "
+			"%u bad checksums, %u bad lines",
+			cat->filename, cat->objects, cat->lines, cat->duplicates,
+			cat->replaced, cat->bad_checksum, cat->bad_format);
+	if (cat->unindexed)
+		printf(", %u not deduplicated", cat->unindexed);
+	printf("\r\n");
+
+	if (sec > 0)
+		printf("%u bytes in %.2f seconds: %.0f objects/sec\r\n",
+			cat->bytes, sec, (cat->objects + cat->duplicates) / sec);
+
+	if (cat->res != FR_OK)
+		printf("%s: error %d: %s\r\n", cat->filename, cat->res, ff_strerror(cat->res));
+	else if (cat->objects > 0 || cat->replaced > 0)
+	{
+		// Keep tle.bin where catalog_map() can find it in one piece.
+		// Failing that it is still read through FatFs.
+		if (!strcmp(cat->filename, "tle.bin"))
+		{
+			res = catalog_layout(cat->filename);
+			if (res != FR_OK)
+				printf("%s: layout error %d: %s\r\n", cat->filename, res, ff_strerror(res));
+		}
+
+		pass_invalidate();
+	}
+
+	return cat->res;
+}
+
+// Convert the TLE text or OMM CSV file txt into the binary catalog bin,
+// or merge it into bin.
+FRESULT catalog_import(const char *txt, const char *bin, int merge)
+{
+	static catalog_t cat;
+	static char buf[CATALOG_READ_SIZE];
+
+	FRESULT res;
+	FIL in;
+	UINT br;
+
+	res = f_open(&in, txt, FA_READ);
+	if (res != FR_OK)
+	{
+		printf("%s: error %d: %s\r\n", txt, res, ff_strerror(res));
+		return res;
+	}
+
+	if (merge)
+		res = catalog_merge(&cat, bin);
+	else
+		res = catalog_begin(&cat, bin);
+	if (res != FR_OK)
+	{
+		f_close(&in);
+		return res;
+	}
+
+	do
+	{
+		res = f_read(&in, buf, sizeof(buf), &br);
+		if (res != FR_OK)
+		{
+			printf("%s: error %d: %s\r\n", txt, res, ff_strerror(res));
+			break;
+		}
+
+		catalog_feed(&cat, buf, br);
+	} while (br == sizeof(buf));
+
+	f_close(&in);
+
+	// Keep the old catalog if the text could not be read to the end
+	if (res != FR_OK && !cat.merge && cat.res == FR_OK)
+		cat.res = res;
+
+	return catalog_end(&cat);
+}
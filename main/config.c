@@ -22,6 +22,8 @@
 
 #include "platform.h"
 #include "config.h"
+#include "journal.h"
+#include "sat.h"
 
 config_t config = {
 	// Observer's geodetic co-ordinates.
@@ -36,23 +38,89 @@ config_t config = {
 	.wifi_pass = "",
 	.wifi_auto = false,
 	.manual = true,
+	.sat_interp = true,
 };
 
 config_t config_saved = {0};
 
+// Field numbers are stored in config.jnl, never reuse or renumber them.
+static const journal_field_t config_fields[] = {
+	JOURNAL_FIELD(1, config_t, observer.lat),
+	JOURNAL_FIELD(2, config_t, observer.lon),
+	JOURNAL_FIELD(3, config_t, observer.alt),
+	JOURNAL_FIELD_STR(4, config_t, username),
+	JOURNAL_FIELD(5, config_t, uplink_mhz),
+	JOURNAL_FIELD(6, config_t, downlink_mhz),
+	JOURNAL_FIELD(7, config_t, i2c_freq),
+	JOURNAL_FIELD(8, config_t, lcd_freq),
+	JOURNAL_FIELD(9, config_t, gnss_debug),
+	JOURNAL_FIELD(10, config_t, gnss_passthrough),
+	JOURNAL_FIELD_STR(11, config_t, wifi_ssid),
+	JOURNAL_FIELD_STR(12, config_t, wifi_pass),
+	JOURNAL_FIELD(13, config_t, wifi_auto),
+	JOURNAL_FIELD(14, config_t, manual),
+	JOURNAL_FIELD(15, config_t, gnss_pos),
+	JOURNAL_FIELD(16, config_t, gnss_time),
+	JOURNAL_FIELD_STR(17, config_t, startscript),
+	JOURNAL_FIELD(18, config_t, sat_interp),
+};
+
+#define CONFIG_FIELDS (sizeof(config_fields) / sizeof(config_fields[0]))
+
+static void config_journal_load(journal_t *j, uint16_t tag, const void *data, int len)
+{
+	if (JOURNAL_TAG_GROUP(tag) == 0)
+		journal_get_field(config_fields, CONFIG_FIELDS, &config, JOURNAL_TAG_FIELD(tag), data, len);
+}
+
+static void config_journal_save(journal_t *j)
+{
+	journal_put_fields(j, 0, config_fields, CONFIG_FIELDS, &config);
+}
+
+static journal_tag_t config_tags[CONFIG_FIELDS + 8];
+
+journal_t config_journal = {
+	.filename = "config.jnl",
+	.tmpname = "config.jnt",
+	.schema = 1,
+	.max = 4096,
+	.tags = config_tags,
+	.tags_max = sizeof(config_tags) / sizeof(config_tags[0]),
+	.load = config_journal_load,
+	.save = config_journal_save,
+};
+
+// Only the settings that changed since the last save are appended to
+// config.jnl, so frequent saves like GNSS position updates are cheap.
 FRESULT config_save()
 {
 	config_saved = config;
-	return f_write_file("config.bin", &config, sizeof(config));
+	return journal_save(&config_journal);
 }
 
 FRESULT config_load()
 {
-	FRESULT ret;
-	ret = f_read_file("config.bin", &config, sizeof(config));
+	FRESULT ret, res;
+
+	ret = journal_load(&config_journal);
+
+	// Convert a config.bin from before config.jnl, or fall back to it
+	// when config.jnl is damaged
+	if (ret != FR_OK)
+	{
+		res = f_read_file("config.bin", &config, sizeof(config));
+		if (res == FR_OK)
+		{
+			printf("config.bin: converting to %s\r\n", config_journal.filename);
+			ret = journal_save(&config_journal);
+		}
+	}
 
 	config_saved = config;
 
+	sat_observer_invalidate();
+
 	return ret;
 }
 
@@ -74,7 +142,8 @@ void config_detail()
 			"gnsspassthrough: %d\r\n"
 			"gnsspos:         %d\r\n"
 			"gnsstime:        %d\r\n"
-			"startscript:     %s\r\n",
+			"startscript:     %s\r\n"
+			"satinterp:       %d\r\n",
 			Degrees(config.observer.lat),
 			Degrees(config.observer.lon),
 			config.observer.alt,
@@ -91,6 +160,7 @@ void config_detail()
 			config.gnss_passthrough,
 			config.gnss_pos,
 			config.gnss_time,
-			config.startscript
+			config.startscript,
+			config.sat_interp
 			);
 }
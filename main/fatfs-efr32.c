@@ -31,6 +31,9 @@
 
 // Our includes
 #include "flash.h"
+#include "ftl.h"
+#include "nor-sim.h"
+#include "fatfs-util.h"
 
 #define lba_to_ptr(lba)		((void *)(FLASH_FAT_BASE + lba*FLASH_FAT_LBA_SIZE))
 #define lba_page(lba)		((void *)((uint32_t)lba_to_ptr(lba) & (~(FLASH_PAGE_SIZE-1))))
@@ -38,6 +41,14 @@
 
 static int global_status = STA_NOINIT;
 
+#ifndef __EFR32__
+// Without flash the volume is on the emulated NOR flash in nor-sim.c, so
+// `fat mkfs` on Linux and the host tools in tools/ work with the same FAT
+// code as the device, and `fat nor` shows the time and wear it costs.
+#define NOR_LBA_PER_PAGE	(FLASH_PAGE_SIZE / FLASH_FAT_LBA_SIZE)
+#define NOR_LBA_COUNT		(nor_sim_pages() * NOR_LBA_PER_PAGE)
+#endif
+
 
 DSTATUS disk_status(BYTE pdrv)
 {
@@ -48,6 +59,13 @@ DSTATUS disk_initialize(BYTE pdrv)
 {
 #ifdef __EFR32__
 	flash_init();
+#else
+	if (nor_sim_init())
+		return global_status;
+#endif
+#ifdef USE_FTL
+	if (ftl_mount())
+		return global_status;
 #endif
 	global_status = 0;
 
@@ -56,8 +74,16 @@ DSTATUS disk_initialize(BYTE pdrv)
 
 DRESULT disk_read(BYTE pdrv, BYTE *buf, LBA_t sector, UINT count)
 {
-#ifdef __EFR32__
+#ifdef USE_FTL
+	return ftl_read(buf, sector, count) ? RES_ERROR : RES_OK;
+#elif defined(__EFR32__)
 	memcpy(buf, lba_to_ptr(sector), count*FLASH_FAT_LBA_SIZE);
+#else
+	if (sector + count > NOR_LBA_COUNT)
+		return RES_PARERR;
+
+	if (nor_sim_read(sector*FLASH_FAT_LBA_SIZE, buf, count*FLASH_FAT_LBA_SIZE))
+		return RES_ERROR;
 #endif
 
 	return RES_OK;
@@ -94,9 +120,22 @@ DRESULT msc_erase_write(uint32_t *page, unsigned char *buf)
 	return RES_OK;
 }
 
-DRESULT disk_write(BYTE pdrv, const BYTE *buf, LBA_t sector, UINT count)
+#ifndef __EFR32__
+static DRESULT nor_erase_write(uint32_t page, unsigned char *buf)
 {
-#ifdef __EFR32__
+	if (nor_sim_erase(page) ||
+		nor_sim_program(page*FLASH_PAGE_SIZE, buf, FLASH_PAGE_SIZE))
+		return RES_ERROR;
+
+	return RES_OK;
+}
+#endif
+
+static DRESULT disk_write_sectors(const BYTE *buf, LBA_t sector, UINT count)
+{
+#ifdef USE_FTL
+	return ftl_write(buf, sector, count) ? RES_ERROR : RES_OK;
+#elif defined(__EFR32__)
 	DRESULT status;
 	unsigned char tmp[FLASH_PAGE_SIZE];
 	LBA_t i, offset;
@@ -129,7 +168,53 @@ DRESULT disk_write(BYTE pdrv, const BYTE *buf, LBA_t sector, UINT count)
 	status = msc_erase_write((uint32_t *)page, tmp);
 	return status;
 #else
-	return RES_OK;
+	// Same as the EFR32: each page that is written is read, erased and
+	// programmed again
+	DRESULT status;
+	static unsigned char tmp[FLASH_PAGE_SIZE];
+	LBA_t i;
+	uint32_t prev_page, page;
+
+	if (sector + count > NOR_LBA_COUNT)
+		return RES_PARERR;
+
+	prev_page = page = sector / NOR_LBA_PER_PAGE;
+	nor_sim_read(page*FLASH_PAGE_SIZE, tmp, FLASH_PAGE_SIZE);
+
+	for (i = sector; i < sector+count; i++)
+	{
+		page = i / NOR_LBA_PER_PAGE;
+
+		if (page != prev_page)
+		{
+			status = nor_erase_write(prev_page, tmp);
+			if (status != RES_OK)
+				return status;
+
+			nor_sim_read(page*FLASH_PAGE_SIZE, tmp, FLASH_PAGE_SIZE);
+		}
+
+		memcpy(tmp + (i % NOR_LBA_PER_PAGE)*FLASH_FAT_LBA_SIZE,
+			buf + (i-sector)*FLASH_FAT_LBA_SIZE, FLASH_FAT_LBA_SIZE);
+		prev_page = page;
+	}
+
+	return nor_erase_write(page, tmp);
+#endif
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buf, LBA_t sector, UINT count)
+{
+#ifdef __EFR32__
+	return disk_write_sectors(buf, sector, count);
+#else
+	uint64_t busy = nor_sim_stats.busy_us;
+	DRESULT res;
+
+	res = disk_write_sectors(buf, sector, count);
+	nor_sim_latency(nor_sim_stats.busy_us - busy);
+
+	return res;
 #endif
 }
 
@@ -137,7 +222,30 @@ DRESULT disk_write(BYTE pdrv, const BYTE *buf, LBA_t sector, UINT count)
 
 DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buf)
 {
+#ifdef USE_FTL
+	switch (cmd)
+	{
+		case CTRL_SYNC:
 #ifdef __EFR32__
+			return ftl_sync() ? RES_ERROR : RES_OK;
+#else
+		{
+			// The FTL programs its cache here, so count it as a write
+			uint64_t busy = nor_sim_stats.busy_us;
+			int ret = ftl_sync();
+
+			if (nor_sim_stats.busy_us != busy)
+				nor_sim_latency(nor_sim_stats.busy_us - busy);
+
+			return ret ? RES_ERROR : RES_OK;
+		}
+#endif
+		case GET_SECTOR_COUNT: *(LBA_t*)buf = ftl_sectors(); return RES_OK;
+		case GET_SECTOR_SIZE: *(WORD*)buf = FTL_SECTOR_SIZE; return RES_OK;
+		case GET_BLOCK_SIZE: *(DWORD*)buf = 1; return RES_OK;
+		case CTRL_TRIM: return RES_OK;
+	}
+#elif defined(__EFR32__)
 	LBA_t *lba = buf;
 	WORD *word = buf;
 	DWORD *dword = buf;
@@ -169,7 +277,97 @@ DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buf)
 			printf("FLASH_TRIM: not implemented, lba=%lu\r\n", *lba);
 			return RES_OK;
 	}
+#else
+	switch (cmd)
+	{
+		case CTRL_SYNC: return RES_OK;
+		case GET_SECTOR_COUNT: *(LBA_t*)buf = NOR_LBA_COUNT; return RES_OK;
+		case GET_SECTOR_SIZE: *(WORD*)buf = FLASH_FAT_LBA_SIZE; return RES_OK;
+		case GET_BLOCK_SIZE: *(DWORD*)buf = FLASH_PAGE_SIZE / FLASH_FAT_LBA_SIZE; return RES_OK;
+		case CTRL_TRIM: return RES_OK;
+	}
 #endif
 
 	return RES_PARERR;
 }
+
+// The raw volume is linear in flash.  Through the FTL a sector can be
+// anywhere, so nothing is mapped.
+const void *disk_map(LBA_t sector, UINT count)
+{
+#ifdef USE_FTL
+	return NULL;
+#elif defined(__EFR32__)
+	if (sector + count > FLASH_FAT_LBA_COUNT)
+		return NULL;
+
+	return lba_to_ptr(sector);
+#else
+	if (sector + count > NOR_LBA_COUNT)
+		return NULL;
+
+	return nor_sim_map(sector*FLASH_FAT_LBA_SIZE, count*FLASH_FAT_LBA_SIZE);
+#endif
+}
+
+#ifdef USE_FTL
+// Raw page access for the FTL
+
+uint32_t ftl_flash_pages()
+{
+#ifdef __EFR32__
+	return FLASH_FAT_SIZE / FLASH_PAGE_SIZE;
+#else
+	return nor_sim_pages();
+#endif
+}
+
+int ftl_flash_read(uint32_t page, uint32_t offset, void *buf, uint32_t len)
+{
+#ifdef __EFR32__
+	memcpy(buf, (void *)(FLASH_FAT_BASE + page*FLASH_PAGE_SIZE + offset), len);
+#else
+	return nor_sim_read(page*FLASH_PAGE_SIZE + offset, buf, len);
+#endif
+
+	return 0;
+}
+
+// Programming can only clear bits, so buf is written over erased flash.
+int ftl_flash_program(uint32_t page, uint32_t offset, const void *buf, uint32_t len)
+{
+#ifdef __EFR32__
+	int status;
+
+	status = MSC_WriteWord((uint32_t *)(FLASH_FAT_BASE + page*FLASH_PAGE_SIZE + offset),
+		buf, len);
+	if (status != mscReturnOk)
+	{
+		printf("ftl_flash_program: page %lu: %s\r\n", page, flash_status(status));
+		return -1;
+	}
+#else
+	return nor_sim_program(page*FLASH_PAGE_SIZE + offset, buf, len);
+#endif
+
+	return 0;
+}
+
+int ftl_flash_erase(uint32_t page)
+{
+#ifdef __EFR32__
+	int status;
+
+	status = MSC_ErasePage((uint32_t *)(FLASH_FAT_BASE + page*FLASH_PAGE_SIZE));
+	if (status != mscReturnOk)
+	{
+		printf("ftl_flash_erase: page %lu: %s\r\n", page, flash_status(status));
+		return -1;
+	}
+#else
+	return nor_sim_erase(page);
+#endif
+
+	return 0;
+}
+#endif
@@ -24,10 +24,12 @@
 #include <stdint.h>
 
 #include "platform.h"
+#include "rtcc.h"
 
 // fatfs includes
 #include "ff.h"
 #include "diskio.h"
+#include "fatfs-util.h"
 
 FRESULT scan_files(char *path	/* Start node to be scanned (***also used as
 				   work area***) */
@@ -152,3 +154,294 @@ FRESULT f_write_file(char *filename, void *data, size_t len)
 
 	return res;
 }
+
+// Buffered text streams.
+//
+// f_gets() reads one character at a time through f_read(), and writing
+// a line at a time costs one f_write() per line.  An f_stream_t reads
+// the file in large chunks into the caller's buffer and f_stream_gets()
+// returns each line in place, so only a line split across two chunks is
+// moved.  Reads are sized to end on a sector boundary, so FatFs copies
+// whole sectors straight into the buffer instead of going through its
+// sector cache.  Writes are collected and flushed in whole buffers.
+//
+// Open a stream with mode FA_READ to read lines, or with FA_WRITE and
+// any of FA_CREATE_ALWAYS, FA_OPEN_APPEND, etc. to write.
+FRESULT f_stream_open(f_stream_t *s, const char *filename, BYTE mode, void *buf, UINT size)
+{
+	memset(s, 0, sizeof(*s));
+
+	s->buf = buf;
+	s->size = size;
+	s->mode = mode;
+
+	s->res = f_open(&s->fp, filename, mode);
+	if (s->res != FR_OK)
+		printf("%s: open error %d: %s\r\n", filename, s->res, ff_strerror(s->res));
+
+	return s->res;
+}
+
+// Fill the buffer after the unread data.  One byte is kept free for the
+// terminator f_stream_gets() adds.
+static FRESULT f_stream_fill(f_stream_t *s)
+{
+	UINT n, br;
+
+	if (s->pos > 0)
+	{
+		memmove(s->buf, s->buf + s->pos, s->len - s->pos);
+		s->len -= s->pos;
+		s->pos = 0;
+	}
+
+	n = s->size - 1 - s->len;
+
+	// End the read on a sector boundary
+	if (n >= 512)
+		n -= (f_tell(&s->fp) + n) % 512;
+
+	s->res = f_read(&s->fp, s->buf + s->len, n, &br);
+	s->reads++;
+	if (s->res != FR_OK || br < n)
+		s->eof = 1;
+
+	s->len += br;
+
+	return s->res;
+}
+
+// Return the next line without its line ending, or NULL at the end of
+// the file or on error.  The line is in the stream buffer and stays
+// valid until the next call.  Lines longer than the buffer are split.
+char *f_stream_gets(f_stream_t *s, UINT *len)
+{
+	char *line, *nl;
+	UINT n;
+
+	nl = memchr(s->buf + s->pos, '\n', s->len - s->pos);
+	while (nl == NULL && !s->eof && (s->pos > 0 || s->len < s->size - 1))
+	{
+		f_stream_fill(s);
+		nl = memchr(s->buf + s->pos, '\n', s->len - s->pos);
+	}
+
+	line = s->buf + s->pos;
+	if (nl != NULL)
+	{
+		n = nl - line;
+		s->pos += n + 1;
+
+		if (n > 0 && line[n-1] == '\r')
+			n--;
+	}
+	else if (s->pos < s->len)
+	{
+		// Last line without a newline, or a line that fills the buffer
+		n = s->len - s->pos;
+		s->pos = s->len;
+	}
+	else
+		return NULL;
+
+	line[n] = 0;
+
+	if (len != NULL)
+		*len = n;
+
+	return line;
+}
+
+FRESULT f_stream_flush(f_stream_t *s)
+{
+	UINT bw;
+
+	if (s->len == 0 || s->res != FR_OK)
+		return s->res;
+
+	s->res = f_write(&s->fp, s->buf, s->len, &bw);
+	s->writes++;
+	if (s->res == FR_OK && bw < s->len)
+		s->res = FR_DENIED;
+
+	s->len = 0;
+
+	return s->res;
+}
+
+FRESULT f_stream_write(f_stream_t *s, const void *data, UINT len)
+{
+	const char *p = data;
+	UINT n, bw;
+
+	while (len > 0 && s->res == FR_OK)
+	{
+		// Whole buffers pass straight through
+		if (s->len == 0 && len >= s->size)
+		{
+			n = len - len % s->size;
+			s->res = f_write(&s->fp, p, n, &bw);
+			s->writes++;
+			if (s->res == FR_OK && bw < n)
+				s->res = FR_DENIED;
+		}
+		else
+		{
+			n = s->size - s->len;
+			if (n > len)
+				n = len;
+
+			memcpy(s->buf + s->len, p, n);
+			s->len += n;
+
+			if (s->len == s->size)
+				f_stream_flush(s);
+		}
+
+		p += n;
+		len -= n;
+	}
+
+	return s->res;
+}
+
+FRESULT f_stream_puts(f_stream_t *s, const char *str)
+{
+	return f_stream_write(s, str, strlen(str));
+}
+
+FRESULT f_stream_close(f_stream_t *s)
+{
+	FRESULT res;
+
+	if (s->mode & FA_WRITE)
+		f_stream_flush(s);
+
+	res = f_close(&s->fp);
+	if (s->res == FR_OK)
+		s->res = res;
+
+	return s->res;
+}
+
+#define F_BENCH_TMP "bench.tmp"
+
+// Read filename line by line with f_gets() and with an f_stream_t of
+// size bytes, then copy it a line at a time with f_write() and with
+// f_stream_write(), and print the time each one took.  Both copies read
+// with f_stream_gets() so only the writes differ.
+FRESULT f_bench(const char *filename, UINT size)
+{
+	FIL fp;
+	f_stream_t s, w;
+	FRESULT res;
+	UINT n, bw;
+	char *buf, *line, text[256];
+	long bytes = 0;
+	int lines = 0, stream_lines = 0, writes = 0;
+	uint64_t start;
+	float sec;
+
+	buf = malloc(size * 2);
+	if (buf == NULL)
+		return FR_NOT_ENOUGH_CORE;
+
+	// f_gets()
+	res = f_open(&fp, filename, FA_READ);
+	if (res != FR_OK)
+	{
+		printf("%s: open error %d: %s\r\n", filename, res, ff_strerror(res));
+		free(buf);
+		return res;
+	}
+
+	start = rtcc_get();
+	while (f_gets(text, sizeof(text), &fp))
+	{
+		bytes += strlen(text);
+		lines++;
+	}
+	sec = rtcc_elapsed_sec(start);
+	f_close(&fp);
+
+	printf("%s: %d lines, %ld bytes\r\n", filename, lines, bytes);
+	printf("read  f_gets:          %8.3f sec %8.1f KB/s\r\n",
+		sec, bytes / 1024.0 / sec);
+
+	// f_stream_gets()
+	res = f_stream_open(&s, filename, FA_READ, buf, size);
+	if (res != FR_OK)
+		goto out;
+
+	start = rtcc_get();
+	while (f_stream_gets(&s, NULL) != NULL)
+		stream_lines++;
+	sec = rtcc_elapsed_sec(start);
+	res = f_stream_close(&s);
+
+	printf("read  f_stream_gets:   %8.3f sec %8.1f KB/s  %lu reads of %u bytes\r\n",
+		sec, bytes / 1024.0 / sec, (unsigned long)s.reads, size);
+
+	// f_gets() splits lines longer than sizeof(text)
+	if (stream_lines != lines)
+		printf("line count mismatch: %d != %d\r\n", stream_lines, lines);
+
+	// f_write() per line
+	res = f_stream_open(&s, filename, FA_READ, buf, size);
+	if (res != FR_OK)
+		goto out;
+
+	res = f_open(&fp, F_BENCH_TMP, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res != FR_OK)
+	{
+		printf("%s: open error %d: %s\r\n", F_BENCH_TMP, res, ff_strerror(res));
+		f_stream_close(&s);
+		goto out;
+	}
+
+	start = rtcc_get();
+	while (res == FR_OK && (line = f_stream_gets(&s, &n)) != NULL)
+	{
+		line[n++] = '\n';
+		res = f_write(&fp, line, n, &bw);
+		writes++;
+	}
+	f_close(&fp);
+	sec = rtcc_elapsed_sec(start);
+	f_stream_close(&s);
+
+	printf("write f_write:         %8.3f sec %8.1f KB/s  %d writes\r\n",
+		sec, bytes / 1024.0 / sec, writes);
+
+	// f_stream_write()
+	res = f_stream_open(&s, filename, FA_READ, buf, size);
+	if (res != FR_OK)
+		goto out;
+
+	res = f_stream_open(&w, F_BENCH_TMP, FA_CREATE_ALWAYS | FA_WRITE, buf + size, size);
+	if (res != FR_OK)
+	{
+		f_stream_close(&s);
+		goto out;
+	}
+
+	start = rtcc_get();
+	while (res == FR_OK && (line = f_stream_gets(&s, &n)) != NULL)
+	{
+		line[n++] = '\n';
+		res = f_stream_write(&w, line, n);
+	}
+	res = f_stream_close(&w);
+	sec = rtcc_elapsed_sec(start);
+	f_stream_close(&s);
+
+	printf("write f_stream_write:  %8.3f sec %8.1f KB/s  %lu writes of %u bytes\r\n",
+		sec, bytes / 1024.0 / sec, (unsigned long)w.writes, size);
+
+	f_unlink(F_BENCH_TMP);
+
+out:
+	free(buf);
+
+	return res;
+}
@@ -24,20 +24,25 @@
 
 #include "ff.h"
 #include "xmodem.h"
+#include "zmodem.h"
 
 #include "serial.h"
 #include "systick.h"
+#include "rtcc.h"
 
 #include "fatfs-util.h"
 #include "rotor.h"
 
 
+// Called while waiting for serial data during a transfer
+static void (*transfer_idle)() = NULL;
+
 // msec timeout
 int _inbyte(unsigned short timeout)
 {
 	unsigned char c = 0;
 
-	if (serial_read_timeout(&c, 1, timeout / 1000.0) == 0)
+	if (serial_read_timeout_idle(&c, 1, timeout / 1000.0, transfer_idle) == 0)
 		return -1;
 
 	return c;
@@ -63,7 +68,63 @@ void xmodem_rx_chunk(void *ctx, void *buf, int len)
 		printf("Chunk Write Error: Only %d of %d bytes were written\r\n", bw, len);
 }
 
-int xmodem_rx(char *filename)
+static uint64_t transfer_start;
+
+#ifdef __ESP32__
+static UBaseType_t transfer_priority;
+#endif
+
+// Tracking keeps running during a transfer: pid_update() still runs from
+// systick and idle() is called while waiting for serial data.  The jitter
+// counters are reset so transfer_end() can show whether either one fell
+// behind.
+static void transfer_begin(void (*idle)())
+{
+	transfer_idle = idle;
+
+	jitter_reset(&pid_jitter);
+	jitter_reset(&tracking_jitter);
+
+#ifdef __ESP32__
+	// Drop to the priority of the tracking thread so flash writes and
+	// protocol work never hold it off.
+	transfer_priority = uxTaskPriorityGet(NULL);
+	vTaskPrioritySet(NULL, tskIDLE_PRIORITY);
+#endif
+
+	transfer_start = rtcc_get();
+}
+
+static void transfer_end(long bytes)
+{
+	float sec = rtcc_elapsed_sec(transfer_start);
+
+#ifdef __ESP32__
+	vTaskPrioritySet(NULL, transfer_priority);
+#endif
+
+	transfer_idle = NULL;
+
+	printf("\r\n%ld bytes in %.1f sec, %.0f bytes/sec\r\n",
+		bytes, sec, sec > 0 ? bytes / sec : 0);
+	jitter_print("pid_update", &pid_jitter);
+	jitter_print("tracking_update", &tracking_jitter);
+}
+
+// Receive into chunk(ctx, buf, len) as each block arrives instead of into
+// a file, so the data can be parsed while it is received.
+int xmodem_rx_cb(void (*chunk)(void *ctx, void *buf, int len), void *ctx, void (*idle)())
+{
+	int len;
+
+	transfer_begin(idle);
+	len = XmodemReceive(chunk, ctx, 1024*1024, 1, 0);
+	transfer_end(len > 0 ? len : 0);
+
+	return len;
+}
+
+int xmodem_rx(char *filename, void (*idle)())
 {
 	FIL out;
 	FRESULT fr;          /* FatFs function common result code */
@@ -77,25 +138,7 @@ int xmodem_rx(char *filename)
 		return -(fr+10);
 	}
 
-
-#ifdef __EFR32__
-	// IADC and systick handlers drown the CPU in IRQ triggers
-	// so turn them off while transferring:
-	int iadc = NVIC_GetEnableIRQ(IADC_IRQn);
-	if (iadc)
-	{
-		NVIC_DisableIRQ(IADC_IRQn);
-		NVIC_ClearPendingIRQ(IADC_IRQn);
-	}
-#endif
-	systick_bypass(1);
-	
-	len = XmodemReceive(xmodem_rx_chunk, &out, 1024*1024, 1, 0);
-
-	systick_bypass(0);
-#ifdef __EFR32__
-	if (iadc) NVIC_EnableIRQ(IADC_IRQn);
-#endif
+	len = xmodem_rx_cb(xmodem_rx_chunk, &out, idle);
 
 	f_close(&out);
 
@@ -118,7 +161,7 @@ void xmodem_tx_chunk(void *ctx, void *buf, int len)
 }
 
 
-int xmodem_tx(char *filename)
+int xmodem_tx(char *filename, void (*idle)())
 {
 	FIL in;
 	FRESULT fr;          /* FatFs function common result code */
@@ -133,27 +176,148 @@ int xmodem_tx(char *filename)
 	}
 	printf("sending %s: %d bytes\r\n", filename, (int)f_size(&in));
 
+	transfer_begin(idle);
+	len = XmodemTransmit(xmodem_tx_chunk, &in, (int)f_size(&in), 1, 0);
+	transfer_end(len > 0 ? len : 0);
+
+	f_close(&in);
+
+	return len;
+}
+
+struct zmodem_file
+{
+	FIL fp;
+
+	// Name given to `fat rz`, or NULL to use the sender's
+	const char *filename;
+
+	FRESULT res;
+};
 
-#ifdef __EFR32__
-	// IADC and systick handlers drown the CPU in IRQ triggers
-	// so turn them off while transferring:
-	int iadc = NVIC_GetEnableIRQ(IADC_IRQn);
-	if (iadc)
+static long zmodem_file_open(void *ctx, const char *name, long size, int resume)
+{
+	struct zmodem_file *zf = ctx;
+	FSIZE_t len;
+
+	if (zf->filename != NULL)
+		name = zf->filename;
+
+	// Continue a partial file if the sender asks to
+	if (resume && f_open(&zf->fp, name, FA_WRITE | FA_OPEN_EXISTING) == FR_OK)
 	{
-		NVIC_DisableIRQ(IADC_IRQn);
-		NVIC_ClearPendingIRQ(IADC_IRQn);
+		len = f_size(&zf->fp);
+		if (size < 0 || (long)len <= size)
+		{
+			zf->res = f_lseek(&zf->fp, len);
+			if (zf->res == FR_OK)
+				return len;
+		}
+
+		f_close(&zf->fp);
 	}
-#endif
-	systick_bypass(1);
-	
-	len = XmodemTransmit(xmodem_tx_chunk, &in, (int)f_size(&in), 1, 0);
 
-	systick_bypass(0);
-#ifdef __EFR32__
-	if (iadc) NVIC_EnableIRQ(IADC_IRQn);
-#endif
+	zf->res = f_open(&zf->fp, name, FA_WRITE | FA_CREATE_ALWAYS);
+	if (zf->res != FR_OK)
+		return -1;
 
-	f_close(&in);
+	return 0;
+}
 
-	return len;
+static int zmodem_file_write(void *ctx, const void *buf, int len)
+{
+	struct zmodem_file *zf = ctx;
+	UINT bw;
+
+	zf->res = f_write(&zf->fp, buf, len, &bw);
+	if (zf->res == FR_OK && (int)bw < len)
+		zf->res = FR_DENIED;
+
+	return zf->res == FR_OK ? 0 : -1;
+}
+
+static void zmodem_file_close(void *ctx, int complete)
+{
+	struct zmodem_file *zf = ctx;
+
+	f_close(&zf->fp);
+}
+
+static void zmodem_print(int ret, zmodem_stats_t *stats)
+{
+	printf("%s: %d files, %ld bytes, %d errors\r\n",
+		ret < 0 ? "cancelled" : "received",
+		stats->files, stats->bytes, stats->errors);
+}
+
+// Receive files with ZMODEM.  If filename is NULL each file keeps the
+// name it was sent with.
+int zmodem_rx(const char *filename, void (*idle)())
+{
+	struct zmodem_file zf = { .filename = filename, .res = FR_OK };
+	zmodem_sink_t sink = {
+		.open = zmodem_file_open,
+		.write = zmodem_file_write,
+		.close = zmodem_file_close,
+		.ctx = &zf,
+	};
+	zmodem_stats_t stats;
+	int ret;
+
+	transfer_begin(idle);
+	ret = zmodem_receive(&sink, &stats, idle);
+	transfer_end(stats.bytes);
+
+	zmodem_print(ret, &stats);
+	if (zf.res != FR_OK)
+		printf("error %d: %s\r\n", zf.res, ff_strerror(zf.res));
+
+	return ret < 0 ? ret : stats.bytes;
+}
+
+struct zmodem_chunk
+{
+	void (*chunk)(void *ctx, void *buf, int len);
+	void *ctx;
+};
+
+static long zmodem_chunk_open(void *ctx, const char *name, long size, int resume)
+{
+	return 0;
+}
+
+static int zmodem_chunk_write(void *ctx, const void *buf, int len)
+{
+	struct zmodem_chunk *zc = ctx;
+
+	zc->chunk(zc->ctx, (void*)buf, len);
+
+	return 0;
+}
+
+static void zmodem_chunk_close(void *ctx, int complete)
+{
+}
+
+// ZMODEM version of xmodem_rx_cb().  Every file in a batch is passed to
+// chunk() in turn, and a resume request starts the file over.
+int zmodem_rx_cb(void (*chunk)(void *ctx, void *buf, int len), void *ctx, void (*idle)())
+{
+	struct zmodem_chunk zc = { .chunk = chunk, .ctx = ctx };
+	zmodem_sink_t sink = {
+		.open = zmodem_chunk_open,
+		.write = zmodem_chunk_write,
+		.close = zmodem_chunk_close,
+		.ctx = &zc,
+	};
+	zmodem_stats_t stats;
+	int ret;
+
+	transfer_begin(idle);
+	ret = zmodem_receive(&sink, &stats, idle);
+	transfer_end(stats.bytes);
+
+	zmodem_print(ret, &stats);
+
+	return ret < 0 ? ret : stats.bytes;
 }
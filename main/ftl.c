@@ -0,0 +1,604 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+
+// Log-structured flash translation layer:
+//
+// The EFR32 can only erase whole flash pages, so writing a FAT sector in
+// place costs a page erase, and the FAT and directory sectors that are
+// written most wear out first.  Instead, sectors are appended to the
+// current write page and a table in RAM maps each logical sector to the
+// slot holding its newest copy.  Superseded copies are reclaimed by
+// garbage collection, which moves the live sectors out of the page with
+// the fewest of them and erases it.
+//
+// Writes go through a small write-back cache that is flushed when it is
+// full or FatFs syncs a file, so several sector writes are programmed
+// into one page together.
+//
+// Wear levelling: new write pages are the free pages with the lowest
+// erase count, and when the most and least worn pages drift more than
+// FTL_WEAR_DELTA erases apart the least worn used page is collected each
+// time a write page is opened, so its static data moves onto a worn page
+// and the page itself goes back into use.
+//
+// Power loss: a slot's tag is written after its data and a page's header
+// after its erase, so an interrupted write leaves either the old or the
+// new copy.  The map is rebuilt at mount from the page headers, taking
+// the copy in the page with the highest sequence number.  A page with
+// an unreadable header is erased again, and so is a page marked dead by
+// garbage collection before its erase.
+
+#ifdef USE_FTL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "ftl.h"
+
+// Erase count spread that triggers static wear levelling
+#define FTL_WEAR_DELTA  64
+
+#define FTL_UNMAPPED    0xFFFF
+
+ftl_stats_t ftl_stats;
+
+static struct {
+	int mounted;
+	uint32_t pages, sectors;
+
+	// Physical slot (page * FTL_SLOTS + slot) of each logical sector
+	uint16_t *map;
+
+	// Per page: sequence number (FTL_ERASED if free), erase count and
+	// live sectors
+	uint32_t *seq, *erases;
+	uint8_t *live;
+
+	uint32_t next_seq, free_pages;
+
+	// Page being written and its next free slot, -1 if none
+	int head, head_slot;
+
+	// True while garbage collecting, when the last free page may be used
+	int gc;
+} ftl;
+
+static struct {
+	uint32_t lba;
+	uint8_t data[FTL_SECTOR_SIZE];
+} ftl_cache[FTL_CACHE];
+
+static int ftl_cache_len;
+
+// Scratch sector for garbage collection
+static uint8_t ftl_buf[FTL_SECTOR_SIZE];
+
+#define FTL_TAG_OFFSET(slot) (offsetof(ftl_page_t, tag) + (slot) * sizeof(uint32_t))
+#define FTL_SLOT_OFFSET(slot) (((slot) + 1) * FTL_SECTOR_SIZE)
+
+uint32_t ftl_sectors()
+{
+	return ftl.sectors;
+}
+
+// Erase a page and write its header with the new erase count.
+static int ftl_erase(uint32_t page)
+{
+	ftl_page_t hdr;
+
+	if (ftl_flash_erase(page))
+		return -1;
+
+	ftl.erases[page]++;
+	ftl_stats.erases++;
+
+	hdr.magic = FTL_MAGIC;
+	hdr.erases = ftl.erases[page];
+
+	if (ftl_flash_program(page, 0, &hdr, 2 * sizeof(uint32_t)))
+		return -1;
+
+	ftl.seq[page] = FTL_ERASED;
+	ftl.live[page] = 0;
+	ftl.free_pages++;
+
+	return 0;
+}
+
+static void ftl_wear_range()
+{
+	uint32_t i;
+
+	ftl_stats.min_erases = FTL_ERASED;
+	ftl_stats.max_erases = 0;
+
+	for (i = 0; i < ftl.pages; i++)
+	{
+		if (ftl.erases[i] < ftl_stats.min_erases)
+			ftl_stats.min_erases = ftl.erases[i];
+		if (ftl.erases[i] > ftl_stats.max_erases)
+			ftl_stats.max_erases = ftl.erases[i];
+	}
+}
+
+static int ftl_gc(int wear);
+
+// Make the free page with the fewest erases the write page.
+static int ftl_open_head()
+{
+	uint32_t i, seq;
+	int best = -1;
+
+	// Keep one free page for garbage collection to copy into
+	while (ftl.free_pages < (ftl.gc ? 1 : 2))
+		if (ftl_gc(0))
+			return -1;
+
+	if (!ftl.gc)
+	{
+		ftl_wear_range();
+		if (ftl_stats.max_erases - ftl_stats.min_erases > FTL_WEAR_DELTA &&
+			ftl_gc(1))
+			return -1;
+	}
+
+	for (i = 0; i < ftl.pages; i++)
+		if (ftl.seq[i] == FTL_ERASED && (int)i != ftl.head &&
+			(best < 0 || ftl.erases[i] < ftl.erases[best]))
+			best = i;
+
+	if (best < 0)
+		return -1;
+
+	seq = ftl.next_seq++;
+	if (ftl_flash_program(best, offsetof(ftl_page_t, seq), &seq, sizeof(seq)))
+		return -1;
+
+	ftl.seq[best] = seq;
+	ftl.free_pages--;
+	ftl.head = best;
+	ftl.head_slot = 0;
+
+	return 0;
+}
+
+// Append one sector to the write page and point lba at it.
+static int ftl_program(uint32_t lba, const uint8_t *data)
+{
+	uint32_t phys, old;
+
+	if (ftl.head < 0 || ftl.head_slot >= FTL_SLOTS)
+		if (ftl_open_head())
+			return -1;
+
+	if (ftl_flash_program(ftl.head, FTL_SLOT_OFFSET(ftl.head_slot), data, FTL_SECTOR_SIZE) ||
+		ftl_flash_program(ftl.head, FTL_TAG_OFFSET(ftl.head_slot), &lba, sizeof(lba)))
+		return -1;
+
+	ftl_stats.programs++;
+
+	phys = ftl.head * FTL_SLOTS + ftl.head_slot++;
+
+	old = ftl.map[lba];
+	if (old != FTL_UNMAPPED)
+		ftl.live[old / FTL_SLOTS]--;
+
+	ftl.map[lba] = phys;
+	ftl.live[ftl.head]++;
+
+	return 0;
+}
+
+// Reclaim the used page with the fewest live sectors, or the least worn
+// one if wear is true.
+static int ftl_gc(int wear)
+{
+	uint32_t i, lba, tag, dead = 0;
+	int victim = -1, slot, gc;
+
+	ftl_stats.gc_runs++;
+
+	for (i = 0; i < ftl.pages; i++)
+	{
+		if (ftl.seq[i] == FTL_ERASED || (int)i == ftl.head)
+			continue;
+
+		if (victim < 0 ||
+			(wear && ftl.erases[i] < ftl.erases[victim]) ||
+			(!wear && ftl.live[i] < ftl.live[victim]))
+			victim = i;
+	}
+
+	if (victim < 0)
+		return wear ? 0 : -1;
+
+	// The least worn page is free already and is used next
+	if (wear && ftl.erases[victim] > ftl_stats.min_erases)
+		return 0;
+
+	// A collection that ran out of free pages can only be helped by a
+	// page with nothing to copy
+	if (ftl.gc && ftl.live[victim] > 0)
+		return -1;
+
+	// Opening a write page can collect another page first, so the flag is
+	// restored rather than cleared.
+	gc = ftl.gc;
+	ftl.gc = 1;
+	for (slot = 0; slot < FTL_SLOTS && ftl.live[victim] > 0; slot++)
+	{
+		if (ftl_flash_read(victim, FTL_TAG_OFFSET(slot), &tag, sizeof(tag)))
+			break;
+
+		lba = tag;
+		if (lba >= ftl.sectors || ftl.map[lba] != victim * FTL_SLOTS + slot)
+			continue;
+
+		// Open the write page before ftl_buf is filled, a nested
+		// collection would reuse it.
+		if (ftl.head < 0 || ftl.head_slot >= FTL_SLOTS)
+			if (ftl_open_head())
+				break;
+
+		if (ftl_flash_read(victim, FTL_SLOT_OFFSET(slot), ftl_buf, FTL_SECTOR_SIZE) ||
+			ftl_program(lba, ftl_buf))
+			break;
+
+		ftl_stats.gc_copies++;
+	}
+	ftl.gc = gc;
+
+	if (ftl.live[victim] > 0)
+		return -1;
+
+	if (ftl_flash_program(victim, offsetof(ftl_page_t, dead), &dead, sizeof(dead)))
+		return -1;
+
+	return ftl_erase(victim);
+}
+
+// Erase every page.  All data is lost.
+int ftl_format()
+{
+	uint32_t i;
+
+	printf("ftl: formatting %lu pages\r\n", (unsigned long)ftl.pages);
+
+	ftl.free_pages = 0;
+	for (i = 0; i < ftl.pages; i++)
+		if (ftl_erase(i))
+			return -1;
+
+	for (i = 0; i < ftl.sectors; i++)
+		ftl.map[i] = FTL_UNMAPPED;
+
+	ftl.head = -1;
+	ftl.next_seq = 0;
+	ftl_cache_len = 0;
+
+	return 0;
+}
+
+static int ftl_seq_cmp(const void *a, const void *b)
+{
+	uint32_t x = ftl.seq[*(const uint32_t *)a], y = ftl.seq[*(const uint32_t *)b];
+
+	return (x > y) - (x < y);
+}
+
+// Free the tables of a mount that failed
+static void ftl_release()
+{
+	free(ftl.map);
+	free(ftl.seq);
+	free(ftl.erases);
+	free(ftl.live);
+
+	ftl.map = NULL;
+	ftl.seq = NULL;
+	ftl.erases = NULL;
+	ftl.live = NULL;
+}
+
+// Rebuild the map from the page headers.  Flash that holds no FTL pages
+// at all is formatted.
+int ftl_mount()
+{
+	ftl_page_t hdr;
+	uint32_t i, j, slot, lba, *order, max_erases = 0, found = 0;
+
+	if (ftl.mounted)
+		return 0;
+
+	ftl.pages = ftl_flash_pages();
+	ftl.sectors = (ftl.pages - FTL_SPARE_PAGES) * FTL_SLOTS;
+
+	ftl.map = malloc(ftl.sectors * sizeof(*ftl.map));
+	ftl.seq = malloc(ftl.pages * sizeof(*ftl.seq));
+	ftl.erases = calloc(ftl.pages, sizeof(*ftl.erases));
+	ftl.live = calloc(ftl.pages, sizeof(*ftl.live));
+	order = malloc(ftl.pages * sizeof(*order));
+	if (ftl.map == NULL || ftl.seq == NULL || ftl.erases == NULL ||
+		ftl.live == NULL || order == NULL)
+	{
+		printf("ftl: not enough memory\r\n");
+		free(order);
+		ftl_release();
+		return -1;
+	}
+
+	for (i = 0; i < ftl.sectors; i++)
+		ftl.map[i] = FTL_UNMAPPED;
+
+	ftl.head = -1;
+	ftl.next_seq = 0;
+	ftl.free_pages = 0;
+
+	for (i = 0; i < ftl.pages; i++)
+	{
+		if (ftl_flash_read(i, 0, &hdr, sizeof(hdr)))
+			hdr.magic = 0;
+
+		// A header whose erase count was never written is an interrupted
+		// erase too
+		if (hdr.magic == FTL_MAGIC && hdr.erases != FTL_ERASED)
+		{
+			found++;
+			ftl.seq[i] = hdr.seq;
+			ftl.erases[i] = hdr.erases;
+			if (hdr.erases > max_erases)
+				max_erases = hdr.erases;
+
+			// Collected but the erase did not finish
+			if (hdr.dead != FTL_ERASED)
+			{
+				ftl.seq[i] = FTL_ERASED;
+				if (ftl_erase(i))
+				{
+					free(order);
+					ftl_release();
+					return -1;
+				}
+				continue;
+			}
+
+			if (hdr.seq == FTL_ERASED)
+				ftl.free_pages++;
+			else if (hdr.seq >= ftl.next_seq)
+				ftl.next_seq = hdr.seq + 1;
+		}
+		else
+		{
+			// Erase count is unknown, so it is erased again below
+			ftl.seq[i] = FTL_ERASED;
+			ftl.erases[i] = FTL_ERASED;
+		}
+	}
+
+	if (!found)
+	{
+		free(order);
+		for (i = 0; i < ftl.pages; i++)
+			ftl.erases[i] = 0;
+
+		if (ftl_format())
+		{
+			ftl_release();
+			return -1;
+		}
+
+		ftl.mounted = 1;
+		return 0;
+	}
+
+	// Interrupted erases
+	for (i = 0; i < ftl.pages; i++)
+	{
+		if (ftl.erases[i] != FTL_ERASED)
+			continue;
+
+		ftl.erases[i] = max_erases;
+		if (ftl_erase(i))
+		{
+			free(order);
+			ftl_release();
+			return -1;
+		}
+	}
+
+	// Used pages in the order they were written
+	for (i = j = 0; i < ftl.pages; i++)
+		if (ftl.seq[i] != FTL_ERASED)
+			order[j++] = i;
+
+	qsort(order, j, sizeof(*order), ftl_seq_cmp);
+
+	for (i = 0; i < j; i++)
+	{
+		if (ftl_flash_read(order[i], 0, &hdr, sizeof(hdr)))
+			continue;
+
+		for (slot = 0; slot < FTL_SLOTS; slot++)
+		{
+			lba = hdr.tag[slot];
+			if (lba >= ftl.sectors)
+				continue;
+
+			if (ftl.map[lba] != FTL_UNMAPPED)
+				ftl.live[ftl.map[lba] / FTL_SLOTS]--;
+
+			ftl.map[lba] = order[i] * FTL_SLOTS + slot;
+			ftl.live[order[i]]++;
+		}
+	}
+
+	// Writing continues in the last write page after its last tagged
+	// slot.  The slot after that may hold data whose tag was never
+	// written, so it is skipped.  Without this, power lost during garbage
+	// collection could leave no free page to finish it with.
+	ftl.head = -1;
+	if (j > 0 && ftl_flash_read(order[j-1], 0, &hdr, sizeof(hdr)) == 0)
+	{
+		for (slot = FTL_SLOTS; slot > 0 && hdr.tag[slot-1] == FTL_ERASED; slot--)
+			;
+
+		if (slot + 1 < FTL_SLOTS)
+		{
+			ftl.head = order[j-1];
+			ftl.head_slot = slot + 1;
+		}
+	}
+
+	free(order);
+
+	// Power lost during garbage collection may have left the last free
+	// page in use, and the next collection would need it
+	if (ftl.free_pages < 1)
+		ftl_gc(0);
+
+	ftl.mounted = 1;
+
+	return 0;
+}
+
+static int ftl_cache_find(uint32_t lba)
+{
+	int i;
+
+	for (i = 0; i < ftl_cache_len; i++)
+		if (ftl_cache[i].lba == lba)
+			return i;
+
+	return -1;
+}
+
+int ftl_read(uint8_t *buf, uint32_t lba, uint32_t count)
+{
+	uint32_t phys;
+	int c;
+
+	for (; count > 0; count--, lba++, buf += FTL_SECTOR_SIZE)
+	{
+		if (lba >= ftl.sectors)
+			return -1;
+
+		ftl_stats.reads++;
+
+		c = ftl_cache_find(lba);
+		if (c >= 0)
+		{
+			ftl_stats.cache_hits++;
+			memcpy(buf, ftl_cache[c].data, FTL_SECTOR_SIZE);
+			continue;
+		}
+
+		phys = ftl.map[lba];
+		if (phys == FTL_UNMAPPED)
+			memset(buf, 0xFF, FTL_SECTOR_SIZE);
+		else if (ftl_flash_read(phys / FTL_SLOTS, FTL_SLOT_OFFSET(phys % FTL_SLOTS),
+				buf, FTL_SECTOR_SIZE))
+			return -1;
+	}
+
+	return 0;
+}
+
+// Program the cached sectors into flash.
+int ftl_sync()
+{
+	int i;
+
+	for (i = 0; i < ftl_cache_len; i++)
+		if (ftl_program(ftl_cache[i].lba, ftl_cache[i].data))
+			return -1;
+
+	ftl_cache_len = 0;
+
+	return 0;
+}
+
+int ftl_write(const uint8_t *buf, uint32_t lba, uint32_t count)
+{
+	int c;
+
+	for (; count > 0; count--, lba++, buf += FTL_SECTOR_SIZE)
+	{
+		if (lba >= ftl.sectors)
+			return -1;
+
+		ftl_stats.writes++;
+
+		c = ftl_cache_find(lba);
+		if (c < 0)
+		{
+			if (ftl_cache_len == FTL_CACHE && ftl_sync())
+				return -1;
+
+			c = ftl_cache_len++;
+			ftl_cache[c].lba = lba;
+		}
+		else
+			ftl_stats.cache_hits++;
+
+		memcpy(ftl_cache[c].data, buf, FTL_SECTOR_SIZE);
+	}
+
+	return 0;
+}
+
+void ftl_status()
+{
+	uint32_t i, live = 0, free_slots;
+
+	if (!ftl.mounted)
+	{
+		printf("ftl: not mounted\r\n");
+		return;
+	}
+
+	ftl_wear_range();
+
+	for (i = 0; i < ftl.pages; i++)
+		live += ftl.live[i];
+
+	free_slots = ftl.free_pages * FTL_SLOTS;
+	if (ftl.head >= 0)
+		free_slots += FTL_SLOTS - ftl.head_slot;
+
+	printf("pages:       %lu of %d bytes, %lu free, %d slots each\r\n"
+		"sectors:     %lu logical, %lu live, %lu free slots\r\n"
+		"reads:       %lu (%lu cache hits)\r\n"
+		"writes:      %lu, %lu programmed\r\n"
+		"erases:      %lu, %lu to %lu per page\r\n"
+		"gc:          %lu runs, %lu sectors copied\r\n",
+		(unsigned long)ftl.pages, FLASH_PAGE_SIZE, (unsigned long)ftl.free_pages, FTL_SLOTS,
+		(unsigned long)ftl.sectors, (unsigned long)live, (unsigned long)free_slots,
+		(unsigned long)ftl_stats.reads, (unsigned long)ftl_stats.cache_hits,
+		(unsigned long)ftl_stats.writes, (unsigned long)ftl_stats.programs,
+		(unsigned long)ftl_stats.erases,
+		(unsigned long)ftl_stats.min_erases, (unsigned long)ftl_stats.max_erases,
+		(unsigned long)ftl_stats.gc_runs, (unsigned long)ftl_stats.gc_copies);
+}
+
+#endif
@@ -0,0 +1,159 @@
+#!/usr/bin/perl
+
+# Generate the packed star catalog header from stars.csv:
+#
+#   gen-stars.pl stars.csv stars-gen.h
+#
+# The output defines three read-only tables for stars.c:
+#   stars[]         - hot data used for tracking: a float J2000 unit vector,
+#                     visual magnitude x100 and offsets into stars_strings[]
+#   stars_info[]    - cold metadata that is only shown to the user
+#   stars_strings[] - every name and spectral type, NUL terminated
+#
+# It also builds the sky index used by stars.c: star indexes sorted by
+# declination band and then by RA, with the start of each band and the
+# packed RA of every entry so a band can be binary searched.
+
+use strict;
+use warnings;
+
+use POSIX qw/floor/;
+
+my $pi = 4 * atan2(1, 1);
+
+# Number of declination bands in the sky index
+my $bands = 18;
+
+my ($in, $out) = @ARGV;
+die "usage: $0 stars.csv stars-gen.h\n" if !defined($out);
+
+open(my $fh, '<', $in) or die "$in: $!\n";
+
+my (@cols, @stars);
+while (my $line = <$fh>)
+{
+	$line =~ s/\r?\n$//;
+	next if $line =~ /^\s*(#|$)/;
+
+	my @f = split(/,/, $line, -1);
+
+	if (!@cols)
+	{
+		@cols = @f;
+		next;
+	}
+
+	die "$in:$.: expected " . scalar(@cols) . " columns, found " . scalar(@f) . "\n"
+		if @f != @cols;
+
+	my %s;
+	@s{@cols} = @f;
+	push @stars, \%s;
+}
+close($fh);
+
+die "$in: no stars found\n" if !@stars;
+
+# Pack every string once into the pool.
+my (%offset, @pool);
+my $pool_len = 0;
+sub pool
+{
+	my $str = shift;
+
+	if (!defined($offset{$str}))
+	{
+		$offset{$str} = $pool_len;
+		push @pool, $str;
+		$pool_len += length($str) + 1;
+	}
+
+	die "string pool is larger than 64k\n" if $pool_len > 65535;
+
+	return $offset{$str};
+}
+
+sub c_str
+{
+	my $str = shift;
+	$str =~ s/(["\\])/\\$1/g;
+	return "\"$str\\0\"";
+}
+
+sub c_float
+{
+	my $v = shift;
+	return "NAN" if $v =~ /nan/i;
+	$v = sprintf("%.9g", $v);
+	$v .= ".0" if $v !~ /[.e]/;
+	return "${v}f";
+}
+
+my (@hot, @cold);
+foreach my $s (@stars)
+{
+	my $ra = $s->{ra} * $pi / 12;
+	my $dec = $s->{dec} * $pi / 180;
+
+	my $name = pool($s->{name});
+	my $spec = pool($s->{spec_type});
+
+	push @hot, sprintf("\t{ %s, %s, %s, %d, %d, %d }, // %s",
+		c_float(cos($dec) * cos($ra)),
+		c_float(cos($dec) * sin($ra)),
+		c_float(sin($dec)),
+		floor($s->{mag_vis} * 100 + 0.5),
+		$name, $spec,
+		$s->{name});
+
+	push @cold, sprintf("\t{ %s },",
+		join(', ', map { c_float($s->{$_}) }
+			qw/gal_lat gal_long mag_abs hip_parlx hip_parlx_err dist_ly/));
+}
+
+# Sky index
+my @band_of = map {
+		my $b = floor(($_->{dec} + 90) / (180 / $bands));
+		$b < 0 ? 0 : $b >= $bands ? $bands - 1 : $b;
+	} @stars;
+
+my @ra_of = map {
+		my $ra = $_->{ra};
+		$ra -= 24 while $ra >= 24;
+		$ra += 24 while $ra < 0;
+		floor($ra * 65536 / 24);
+	} @stars;
+
+my @order = sort { $band_of[$a] <=> $band_of[$b] || $ra_of[$a] <=> $ra_of[$b] } (0 .. $#stars);
+
+my @band_start = (0) x ($bands + 1);
+$band_start[$band_of[$_] + 1]++ foreach (0 .. $#stars);
+$band_start[$_] += $band_start[$_ - 1] foreach (1 .. $bands);
+
+open($fh, '>', $out) or die "$out: $!\n";
+
+print $fh "// Generated by gen-stars.pl from stars.csv, do not edit.\n\n";
+print $fh "#define STARS_COUNT " . scalar(@stars) . "\n\n";
+
+print $fh "const char stars_strings[] =\n";
+print $fh join("\n", map { "\t" . c_str($_) } @pool) . ";\n\n";
+
+print $fh "const star_t stars[] = {\n" . join("\n", @hot) . "\n};\n\n";
+
+print $fh "const star_info_t stars_info[] = {\n" . join("\n", @cold) . "\n};\n\n";
+
+print $fh "#define STARS_BANDS $bands\n\n";
+
+print $fh "const uint16_t stars_band_start[] = {\n\t" . join(", ", @band_start) . "\n};\n\n";
+
+print $fh "const uint16_t stars_band_idx[] = {\n";
+print $fh "\t" . join(", ", @order[$band_start[$_] .. $band_start[$_ + 1] - 1]) . ",\n"
+	foreach grep { $band_start[$_] < $band_start[$_ + 1] } (0 .. $bands - 1);
+print $fh "};\n\n";
+
+print $fh "const uint16_t stars_band_ra[] = {\n";
+print $fh "\t" . join(", ", map { $ra_of[$_] } @order[$band_start[$_] .. $band_start[$_ + 1] - 1]) . ",\n"
+	foreach grep { $band_start[$_] < $band_start[$_ + 1] } (0 .. $bands - 1);
+print $fh "};\n";
+
+close($fh);
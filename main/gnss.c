@@ -25,6 +25,7 @@
 
 #include "minmea.h"
 #include "config.h"
+#include "sat.h"
 
 #define GNSS_BAUD_RATE 115200
 #define BUF_SIZE 1024
@@ -102,6 +103,8 @@ void gnss_parse(char *line)
 				if (!isnan(minmea_tocoord(&frame.longitude)))
 					config.observer.lon = Radians(minmea_tocoord(&frame.longitude));
 
+				sat_observer_invalidate();
+
 				// Update saved poition every 11.1 kilometers or every .1 kilometers of altitude
 				if (Degrees(fabs(config_saved.observer.lat - config.observer.lat)) > 0.1 ||
 					Degrees(fabs(config_saved.observer.lon - config.observer.lon)) > 0.1 ||
@@ -156,6 +159,7 @@ void gnss_parse(char *line)
 					// config.observer expects kilometers,
 					// but frame.altitude gives meters
 					config.observer.alt = minmea_tofloat(&frame.altitude)/1000;
+					sat_observer_invalidate();
 				}
 
 				if (config.gnss_debug == true)
@@ -8,25 +8,45 @@
    https://github.com/espressif/esp-idf/blob/master/examples/protocols/http_request/main/http_request_example_main.c
 */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
 
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "platform.h"
+
+#ifdef __ESP32__
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
 #include "nvs_flash.h"
 
-#include "ff.h"
-#include "fatfs-util.h"
-
 #include "lwip/err.h"
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
 #include "lwip/netdb.h"
 #include "lwip/dns.h"
-#include "sdkconfig.h"
+#else
+// The Linux build uses the host's sockets so downloads can be tested
+// against a local HTTP server.
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define ESP_LOGE(tag, fmt, ...) printf("%s: " fmt "\r\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) printf("%s: " fmt "\r\n", tag, ##__VA_ARGS__)
+#endif
+
+#include "ff.h"
+#include "fatfs-util.h"
+#include "rtcc.h"
+#include "http_get.h"
 
 static const char *TAG = "http_get";
 
@@ -70,7 +90,220 @@ void http_parse_url(char *url, char **server, char **path, char **port)
 		*port = "80";
 }
 
-int http_get(char *file_name, const char *orig_url)
+// http_body() states
+enum {
+	HTTP_BODY_DATA,
+	HTTP_BODY_SIZE,
+	HTTP_BODY_EXT,
+	HTTP_BODY_CRLF,
+	HTTP_BODY_TRAILER,
+	HTTP_BODY_DONE,
+};
+
+typedef struct {
+	void (*chunk)(void *ctx, void *buf, int len);
+	void *ctx;
+
+	// Transfer-Encoding: chunked
+	int chunked;
+
+	int state;
+
+	// Bytes left in the body or in the current chunk, or -1 to read
+	// until the server closes the connection
+	long left;
+
+	// Hex digits of the chunk size, or length of a trailer line
+	int count;
+
+	// Body bytes passed to chunk()
+	long bytes;
+} http_body_t;
+
+// The chunk-size line has ended
+static int http_chunk_size(http_body_t *b)
+{
+	if (b->count == 0)
+		return -1;
+
+	b->count = 0;
+
+	// The last chunk has size 0 and is followed by optional trailers
+	b->state = b->left > 0 ? HTTP_BODY_DATA : HTTP_BODY_TRAILER;
+
+	return 0;
+}
+
+// Decode len bytes of the body at p.  The data is passed to chunk() where
+// it lies in the receive buffer, chunked encoding only adds a small state
+// machine around it.  Returns -1 if the chunked encoding is malformed.
+static int http_body(http_body_t *b, char *p, int len)
+{
+	int c, n;
+
+	while (len > 0 && b->state != HTTP_BODY_DONE)
+	{
+		if (b->state == HTTP_BODY_DATA)
+		{
+			n = len;
+			if (b->left >= 0 && n > b->left)
+				n = b->left;
+
+			b->chunk(b->ctx, p, n);
+			b->bytes += n;
+			p += n;
+			len -= n;
+
+			if (b->left < 0)
+				continue;
+
+			b->left -= n;
+			if (b->left == 0)
+				b->state = b->chunked ? HTTP_BODY_CRLF : HTTP_BODY_DONE;
+
+			continue;
+		}
+
+		c = *p++;
+		len--;
+
+		switch (b->state)
+		{
+			case HTTP_BODY_SIZE:
+				if (isxdigit(c))
+				{
+					// Nothing sent to a 1 MB device is this large
+					if (++b->count > 7)
+						return -1;
+
+					b->left = b->left * 16 + (isdigit(c) ? c - '0' : tolower(c) - 'a' + 10);
+				}
+				else if (c == '\n')
+				{
+					if (http_chunk_size(b) < 0)
+						return -1;
+				}
+				else if (c == ';' || c == ' ' || c == '\t')
+					b->state = HTTP_BODY_EXT;
+				else if (c != '\r')
+					return -1;
+				break;
+
+			// Chunk extensions are ignored
+			case HTTP_BODY_EXT:
+				if (c == '\n' && http_chunk_size(b) < 0)
+					return -1;
+				break;
+
+			// CRLF after the chunk data
+			case HTTP_BODY_CRLF:
+				if (c == '\n')
+				{
+					b->state = HTTP_BODY_SIZE;
+					b->left = 0;
+				}
+				else if (c != '\r')
+					return -1;
+				break;
+
+			// Trailer fields end with an empty line
+			case HTTP_BODY_TRAILER:
+				if (c == '\n')
+				{
+					if (b->count == 0)
+						b->state = HTTP_BODY_DONE;
+
+					b->count = 0;
+				}
+				else if (c != '\r')
+					b->count++;
+				break;
+		}
+	}
+
+	return 0;
+}
+
+// Copy a validator if it fits.  A cut off ETag would never match, so it
+// is left empty instead.
+static void http_header_copy(char *dst, int size, const char *value)
+{
+	dst[0] = '\0';
+
+	if (strlen(value) < (size_t)size)
+		strcpy(dst, value);
+}
+
+// Parse the NUL terminated response header.  Returns the status code.
+static int http_headers(char *hdr, http_body_t *b, http_cache_t *cache)
+{
+	char *line, *next, *value, *end;
+	int status = -1, len;
+
+	for (line = hdr; *line; line = next)
+	{
+		next = strstr(line, "\r\n");
+		*next = '\0';
+		next += 2;
+
+		if (line == hdr)
+		{
+			printf("%s\r\n", line);
+
+			if (sscanf(line, "HTTP/%*d.%*d %d", &status) != 1)
+				return -1;
+
+			continue;
+		}
+
+		value = strchr(line, ':');
+		if (value == NULL)
+			continue;
+
+		*value++ = '\0';
+		while (*value == ' ' || *value == '\t')
+			value++;
+
+		end = value + strlen(value);
+		while (end > value && (end[-1] == ' ' || end[-1] == '\t'))
+			*--end = '\0';
+
+		if (!strcasecmp(line, "Content-Length"))
+			b->left = atol(value);
+		else if (!strcasecmp(line, "Transfer-Encoding"))
+		{
+			// chunked is always the last coding
+			len = strlen(value);
+			b->chunked = len >= 7 && !strcasecmp(value + len - 7, "chunked");
+		}
+		else if (cache != NULL && !strcasecmp(line, "ETag"))
+			http_header_copy(cache->etag, sizeof(cache->etag), value);
+		else if (cache != NULL && !strcasecmp(line, "Last-Modified"))
+			http_header_copy(cache->modified, sizeof(cache->modified), value);
+	}
+
+	// Chunked encoding overrides Content-Length
+	if (b->chunked)
+	{
+		b->state = HTTP_BODY_SIZE;
+		b->left = 0;
+	}
+	else if (b->left == 0)
+		b->state = HTTP_BODY_DONE;
+
+	return status;
+}
+
+// Download orig_url and pass the body to chunk(ctx, buf, len) as it is
+// received.  If cache has validators from an earlier download the request
+// is conditional, and on a 200 response cache gets the new ones so the
+// caller can http_cache_save() them once it has stored the body.
+//
+// Returns the HTTP status: 200 once the whole body was passed to chunk(),
+// 304 if it has not changed, or -1 if the download failed.  The body of
+// any other status is not passed to chunk().
+int http_get_cb(const char *orig_url, http_cache_t *cache,
+	void (*chunk)(void *ctx, void *buf, int len), void *ctx)
 {
 	const struct addrinfo hints = {
 		.ai_family = AF_INET,
@@ -80,18 +313,23 @@ int http_get(char *file_name, const char *orig_url)
 	struct addrinfo *res;
 	struct in_addr *addr;
 	int s;
-	char recv_buf[128];
+
+	http_body_t b = {
+		.chunk = chunk,
+		.ctx = ctx,
+		.state = HTTP_BODY_DATA,
+		.left = -1,
+	};
 
 	char *request = NULL;
 	char *server = NULL;
 	char *path = NULL;
 	char *port = "80";
 	char *url;
-	int ret = 0;
-
-	FIL fil;              /* File object */
-	FRESULT f_res = FR_OK;  /* API result code */
-	UINT bw;          /* Bytes written */
+	char *buf, *hdr, *body;
+	int ret = 0, req_len, len, n, status;
+	uint64_t start;
+	float sec;
 
 	int url_len = strlen(orig_url);
 
@@ -103,7 +341,7 @@ int http_get(char *file_name, const char *orig_url)
 		ret = -1;
 		goto out;
 	}
-		
+
 	strcpy(url, orig_url);
 
 	http_parse_url(url, &server, &path, &port);
@@ -128,7 +366,7 @@ int http_get(char *file_name, const char *orig_url)
 	   Code to print the resolved IP.
 
 	   Note: inet_ntoa is non-reentrant, look at ipaddr_ntoa_r
-	   for "real" code 
+	   for "real" code
 	 */
 	addr = &((struct sockaddr_in *) res->ai_addr)->sin_addr;
 	ESP_LOGI(TAG, "DNS lookup succeeded. IP=%s", inet_ntoa(*addr));
@@ -153,7 +391,9 @@ int http_get(char *file_name, const char *orig_url)
 
 	ESP_LOGI(TAG, "... connected");
 
-	request = malloc(url_len + 128);
+	// Room for the path, host and both validators
+	req_len = url_len + 384;
+	request = malloc(req_len);
 	if (request == NULL)
 	{
 		ESP_LOGE(TAG, "... failed to allocate request memory");
@@ -162,9 +402,23 @@ int http_get(char *file_name, const char *orig_url)
 		goto out_close;
 	}
 
-	snprintf(request, url_len + 128, "GET /%s HTTP/1.0\r\nHost: %s\r\n\r\n",
-		path, server);
-	if (write(s, request, strlen(request)) < 0)
+	n = snprintf(request, req_len, "GET /%s HTTP/1.1\r\n"
+		"Host: %s%s%s\r\n"
+		"User-Agent: space-ham\r\n"
+		"Connection: close\r\n",
+		path, server,
+		strcmp(port, "80") ? ":" : "",
+		strcmp(port, "80") ? port : "");
+
+	if (cache != NULL && cache->etag[0])
+		n += snprintf(request + n, req_len - n, "If-None-Match: %s\r\n", cache->etag);
+
+	if (cache != NULL && cache->modified[0])
+		n += snprintf(request + n, req_len - n, "If-Modified-Since: %s\r\n", cache->modified);
+
+	n += snprintf(request + n, req_len - n, "\r\n");
+
+	if (write(s, request, n) < n)
 	{
 		ESP_LOGE(TAG, "... socket send failed");
 
@@ -188,45 +442,108 @@ int http_get(char *file_name, const char *orig_url)
 	}
 	ESP_LOGI(TAG, "... set socket receiving timeout success");
 
-	FILE *fp = fdopen(s, "r");
-
-	if (fp == NULL)
+	buf = malloc(HTTP_BUF_SIZE);
+	if (buf == NULL)
 	{
-		ESP_LOGE(TAG, "... failed to open socket as a FILE handle");
+		ESP_LOGE(TAG, "... failed to allocate receive buffer");
 
 		ret = -1;
 		goto out_req;
 	}
 
-	f_res = f_open(&fil, file_name, FA_CREATE_ALWAYS | FA_WRITE);
-	if (f_res != FR_OK)
+	// Read until the end of the header, the start of the body usually
+	// arrives with it.
+	len = 0;
+	hdr = NULL;
+	while (hdr == NULL)
 	{
-		ESP_LOGE(TAG, "... failed to open %s: %s", file_name, ff_strerror(f_res));
+		if (len >= HTTP_BUF_SIZE - 1)
+		{
+			ESP_LOGE(TAG, "... response header is too large");
+
+			ret = -1;
+			goto out_buf;
+		}
+
+		n = recv(s, buf + len, HTTP_BUF_SIZE - 1 - len, 0);
+		if (n <= 0)
+		{
+			ESP_LOGE(TAG, "... no response header");
+
+			ret = -1;
+			goto out_buf;
+		}
 
+		len += n;
+		buf[len] = '\0';
+
+		hdr = strstr(buf, "\r\n\r\n");
+	}
+
+	body = hdr + 4;
+	hdr[2] = '\0';
+
+	// Validators are only kept from this response
+	if (cache != NULL)
+	{
+		cache->etag[0] = '\0';
+		cache->modified[0] = '\0';
+	}
+
+	status = http_headers(buf, &b, cache);
+	if (status == 304)
+	{
+		printf("%s: not modified\r\n", orig_url);
+
+		ret = 304;
+		goto out_buf;
+	}
+	else if (status != 200)
+	{
 		ret = -1;
-		goto out_req;
+		goto out_buf;
 	}
 
-	bool header_done = false;
+	start = rtcc_get();
 
-	while (fgets(recv_buf, sizeof(recv_buf)-1, fp) != NULL)
+	n = len - (body - buf);
+	for (;;)
 	{
-		if (!header_done && strcmp(recv_buf, "\r\n") == 0)
+		if (n > 0 && http_body(&b, body, n) < 0)
 		{
-			header_done = true;
+			ESP_LOGE(TAG, "... bad chunked encoding");
 
-			continue;
+			ret = -1;
+			goto out_buf;
 		}
 
-		if (header_done == true)
-		{
-			f_write(&fil, recv_buf, strlen(recv_buf), &bw);
-		}
-		else
-			printf("%s", recv_buf);
+		if (b.state == HTTP_BODY_DONE)
+			break;
+
+		n = recv(s, buf, HTTP_BUF_SIZE, 0);
+		if (n <= 0)
+			break;
+
+		body = buf;
+	}
+
+	sec = rtcc_elapsed_sec(start);
+	printf("%ld bytes in %.2f sec, %.0f bytes/sec\r\n",
+		b.bytes, sec, sec > 0 ? b.bytes / sec : 0);
+
+	// Without a length or chunked encoding the body ends when the server
+	// closes the connection.
+	if (b.state == HTTP_BODY_DONE || (b.left < 0 && n == 0))
+		ret = 200;
+	else
+	{
+		ESP_LOGE(TAG, "... download was cut short");
+
+		ret = -1;
 	}
 
-	f_close(&fil);
+out_buf:
+	free(buf);
 
 out_req:
 	free(request);
@@ -243,3 +560,185 @@ out_url:
 out:
 	return ret;
 }
+
+static http_cache_t http_cache[HTTP_CACHE_MAX];
+
+static void http_cache_load()
+{
+	FIL fp;
+	UINT br;
+
+	memset(http_cache, 0, sizeof(http_cache));
+
+	if (f_open(&fp, HTTP_CACHE_FILE, FA_READ) != FR_OK)
+		return;
+
+	if (f_read(&fp, http_cache, sizeof(http_cache), &br) != FR_OK || br != sizeof(http_cache))
+		memset(http_cache, 0, sizeof(http_cache));
+
+	f_close(&fp);
+}
+
+// Set the size and timestamp of cache->file, all zero if it is missing
+static void http_cache_stat(http_cache_t *cache)
+{
+	FILINFO fno;
+
+	if (f_stat(cache->file, &fno) != FR_OK)
+		memset(&fno, 0, sizeof(fno));
+
+	cache->size = fno.fsize;
+	cache->fdate = fno.fdate;
+	cache->ftime = fno.ftime;
+}
+
+static int http_cache_same(const http_cache_t *a, const http_cache_t *b)
+{
+	return a->size == b->size && a->fdate == b->fdate && a->ftime == b->ftime;
+}
+
+// Fill cache with the validators of the last download of url into file,
+// if file has not changed since.  Returns 1 if the request can be
+// conditional.
+int http_cache_find(http_cache_t *cache, const char *file, const char *url)
+{
+	int i;
+
+	memset(cache, 0, sizeof(*cache));
+
+	// Names that do not fit are never cached
+	if (strlen(file) >= sizeof(cache->file) || strlen(url) >= sizeof(cache->url))
+		return 0;
+
+	strcpy(cache->file, file);
+	strcpy(cache->url, url);
+	http_cache_stat(cache);
+
+	http_cache_load();
+
+	for (i = 0; i < HTTP_CACHE_MAX; i++)
+	{
+		if (!strcmp(http_cache[i].file, file) &&
+			!strcmp(http_cache[i].url, url) &&
+			http_cache_same(&http_cache[i], cache))
+		{
+			strcpy(cache->etag, http_cache[i].etag);
+			strcpy(cache->modified, http_cache[i].modified);
+
+			return cache->etag[0] || cache->modified[0];
+		}
+	}
+
+	return 0;
+}
+
+// Remember the validators once cache->file holds the body of a 200
+// response.  A merge adds to the file, so the entries of other URLs merged
+// into it stay valid.  Otherwise the file now only holds this download and
+// they are dropped.
+void http_cache_save(http_cache_t *cache, int merge)
+{
+	http_cache_t before = *cache;
+	int i, slot = -1;
+
+	if (cache->url[0] == '\0')
+		return;
+
+	http_cache_stat(cache);
+	http_cache_load();
+
+	for (i = 0; i < HTTP_CACHE_MAX; i++)
+	{
+		if (strcmp(http_cache[i].file, cache->file))
+			continue;
+
+		if (merge && strcmp(http_cache[i].url, cache->url) &&
+			http_cache_same(&http_cache[i], &before))
+		{
+			http_cache[i].size = cache->size;
+			http_cache[i].fdate = cache->fdate;
+			http_cache[i].ftime = cache->ftime;
+		}
+		else
+			memset(&http_cache[i], 0, sizeof(http_cache[i]));
+	}
+
+	if (cache->etag[0] || cache->modified[0])
+	{
+		for (i = 0; i < HTTP_CACHE_MAX && slot < 0; i++)
+			if (http_cache[i].file[0] == '\0')
+				slot = i;
+
+		// Forget the first entry when it is full
+		if (slot < 0)
+		{
+			memmove(&http_cache[0], &http_cache[1], sizeof(http_cache[0]) * (HTTP_CACHE_MAX - 1));
+			slot = HTTP_CACHE_MAX - 1;
+		}
+
+		http_cache[slot] = *cache;
+	}
+
+	f_write_file(HTTP_CACHE_FILE, http_cache, sizeof(http_cache));
+}
+
+struct http_get_file
+{
+	FIL fp;
+	FRESULT res;
+};
+
+static void http_get_file_chunk(void *ctx, void *buf, int len)
+{
+	struct http_get_file *hf = ctx;
+	UINT bw;
+
+	if (hf->res != FR_OK)
+		return;
+
+	hf->res = f_write(&hf->fp, buf, len, &bw);
+	if (hf->res == FR_OK && (int)bw < len)
+		hf->res = FR_DENIED;
+}
+
+// Download orig_url into file_name.  The old file is kept if it has not
+// changed on the server or the download fails.
+int http_get(char *file_name, const char *orig_url)
+{
+	struct http_get_file hf;
+	http_cache_t cache;
+	int ret;
+
+	http_cache_find(&cache, file_name, orig_url);
+
+	hf.res = f_open(&hf.fp, HTTP_TMP, FA_CREATE_ALWAYS | FA_WRITE);
+	if (hf.res != FR_OK)
+	{
+		ESP_LOGE(TAG, "... failed to open %s: %s", HTTP_TMP, ff_strerror(hf.res));
+
+		return -1;
+	}
+
+	ret = http_get_cb(orig_url, &cache, http_get_file_chunk, &hf);
+
+	f_close(&hf.fp);
+
+	if (ret == 200 && hf.res == FR_OK)
+	{
+		f_unlink(file_name);
+		hf.res = f_rename(HTTP_TMP, file_name);
+		if (hf.res == FR_OK)
+			http_cache_save(&cache, 0);
+	}
+	else
+		f_unlink(HTTP_TMP);
+
+	if (hf.res != FR_OK)
+	{
+		ESP_LOGE(TAG, "... %s: %s", file_name, ff_strerror(hf.res));
+
+		return -1;
+	}
+
+	return ret;
+}
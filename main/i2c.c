@@ -129,6 +129,7 @@ i2c_req_t *i2c_handle_req(i2c_req_t *req)
 	if (req->status == i2cTransferDone)
 	{
 		req->complete_time = rtcc_get_sec();
+		req->complete_ticks = rtcc_get();
 		req->sample_count++;
 		req->valid = 1;
 		if (req->result != NULL && req->result != req->data)
@@ -122,7 +122,9 @@ void initIADC(void)
 	// Enable Scan interrupts
 	IADC_enableInt(IADC0, IADC_IEN_SCANTABLEDONE);
 
-	// Enable ADC interrupts
+	// Enable ADC interrupts below USART RX so a scan never delays
+	// serial data.
+	NVIC_SetPriority(IADC_IRQn, 1);
 	NVIC_ClearPendingIRQ(IADC_IRQn);
 	NVIC_EnableIRQ(IADC_IRQn);
 
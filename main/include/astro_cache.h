@@ -0,0 +1,58 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+#include "sgp4sdp4.h"
+#include "astronomy.h"
+
+// Number of Chebyshev coefficients per axis
+#define ASTRO_CACHE_ORDER 10
+
+// Length of each fitted window in days (4 hours)
+#define ASTRO_CACHE_WINDOW (4.0/24)
+
+typedef struct {
+	// Body and observer that the coefficients were fitted for
+	astro_body_t body;
+	astro_observer_t observer;
+
+	// True if the coefficients are valid
+	int valid;
+
+	// UT window [ut_start, ut_start+ASTRO_CACHE_WINDOW] in days
+	double ut_start;
+
+	// Greenwich apparent sidereal time (hours) at ut_start
+	double gast_start;
+
+	// Chebyshev coefficients of the topocentric equator-of-date
+	// position vector (AU) for x, y and z.
+	double coef[3][ASTRO_CACHE_ORDER];
+
+	// Statistics
+	unsigned int fits, evals;
+} astro_cache_t;
+
+void astro_cache_reset(astro_cache_t *cache);
+
+astro_status_t astro_cache_horizon(astro_cache_t *cache,
+	astro_body_t body, astro_observer_t observer, astro_time_t *time,
+	double *azimuth, double *altitude);
+
+void astro_cache_status(astro_cache_t *cache);
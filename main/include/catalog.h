@@ -0,0 +1,160 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+#include <stdint.h>
+
+#include "sgp4sdp4.h"
+#include "ff.h"
+
+// Number of records written at once, three 512 byte sectors
+#define CATALOG_WRITE_RECS 16
+
+// Format of the records in tle.bin, in each record's version field
+#define CATALOG_REC_VERSION 2
+
+// catalog_rec_t flags: select_ephemeris() chooses SDP4
+#define CATALOG_REC_DEEP    0x01
+
+// Catalog numbers are deduplicated through a hash table with
+// 1 << CATALOG_HASH_BITS slots, which limits the number of objects that
+// can be deduplicated in one import or merge to 3/4 of that.
+#if defined(__EFR32__)
+#define CATALOG_HASH_BITS 11
+#elif defined(__ESP32__)
+#define CATALOG_HASH_BITS 14
+#else
+#define CATALOG_HASH_BITS 16
+#endif
+
+#define CATALOG_HASH_SLOTS (1 << CATALOG_HASH_BITS)
+#define CATALOG_HASH_MAX   (CATALOG_HASH_SLOTS / 4 * 3)
+
+// Longest text line that is kept when it is split between two chunks.
+// Space-Track's OMM CSV header is about 500 characters.
+#define CATALOG_LINE_MAX 512
+
+// Most OMM CSV columns that are looked at, the rest are ignored
+#define CATALOG_OMM_COLS 40
+
+// Index file written next to the catalog, tle.idx for tle.bin: a
+// catalog_idx_hdr_t followed by one catalog_idx_t per object, sorted by
+// catalog number.
+#define CATALOG_IDX_MAGIC 0x58444954 // "TIDX"
+
+typedef struct {
+	uint32_t magic, count;
+
+	// Number of records in the catalog the index was written for
+	uint32_t records;
+} catalog_idx_hdr_t;
+
+typedef struct {
+	// Catalog number, 0 is an empty hash slot
+	int32_t catnr;
+
+	// Record number in the catalog
+	uint32_t idx;
+} catalog_idx_t;
+
+// One object in tle.bin.  The mean elements are in TLE units, with the
+// epoch and mean motion as doubles and the rest as floats, which keep
+// more digits than TLE text has.  CATALOG_REC_DEEP is what
+// select_ephemeris() works out, so catalog_select() prepares a record for
+// SGP4/SDP4 without its pow() calls.  Only that choice is stored: SGP4()
+// and SDP4() work out their own init terms on the first call after the
+// flags are cleared and cannot be given them, and sgp4f_init() and
+// prefilter_init() start from the elements.
+typedef struct catalog_rec {
+	// CRC-32 of the rest of the record
+	uint32_t crc;
+
+	int32_t catnr;
+
+	// YYDDD.DDDDDDDD and revolutions per day
+	double epoch, xno;
+
+	float xndt2o, xndd6o, bstar, xincl, xnodeo, eo, omegao, xmo;
+
+	uint32_t revnum;
+	uint16_t elset;
+	uint8_t version, flags;
+
+	// Not NUL terminated when they fill the field
+	char sat_name[24], idesg[8];
+} catalog_rec_t;
+
+typedef struct {
+	// Output file name and the temporary file it is built in, or the
+	// catalog itself when merging
+	char filename[16], idxname[16];
+	FIL out;
+	int merge;
+
+	// Records not yet written, and the number already in the file
+	catalog_rec_t wbuf[CATALOG_WRITE_RECS];
+	int wbuf_len;
+	uint32_t flushed;
+
+	// Line that was split between two chunks
+	char line[CATALOG_LINE_MAX];
+	int line_len;
+
+	// TLE being assembled from its name line, line 1 and line 2
+	tle_t tle;
+	int have_name, have_line1;
+
+	// Once an OMM CSV header line is seen the following lines are CSV
+	// rows, and omm_col[] holds the field of each column.
+	int omm;
+	int8_t omm_col[CATALOG_OMM_COLS];
+
+	// Catalog number hash table and the number of slots in use
+	catalog_idx_t *hash;
+	uint32_t indexed;
+
+	uint64_t start;
+	FRESULT res;
+
+	// Counters for the summary
+	uint32_t lines, bytes, objects, duplicates, replaced, bad_checksum,
+		bad_format, unindexed;
+} catalog_t;
+
+FRESULT catalog_begin(catalog_t *cat, const char *filename);
+FRESULT catalog_merge(catalog_t *cat, const char *filename);
+void catalog_feed(catalog_t *cat, const char *data, int len);
+void catalog_chunk(void *ctx, void *buf, int len);
+void catalog_add(catalog_t *cat, tle_t *tle);
+FRESULT catalog_end(catalog_t *cat);
+FRESULT catalog_import(const char *txt, const char *bin, int merge);
+
+void catalog_pack(const tle_t *tle, catalog_rec_t *rec);
+int catalog_unpack(const catalog_rec_t *rec, tle_t *tle);
+int catalog_select(const catalog_rec_t *rec, tle_t *tle);
+int catalog_rec_valid(const catalog_rec_t *rec);
+
+// tle.bin mapped from flash, see catalog-map.c
+void catalog_map_init();
+const catalog_rec_t *catalog_map(uint32_t *count);
+void catalog_unmap();
+const catalog_rec_t *catalog_get(uint32_t idx, catalog_rec_t *buf);
+void catalog_check();
+FRESULT catalog_layout(const char *filename);
+void catalog_map_status();
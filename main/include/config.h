@@ -39,11 +39,16 @@ typedef struct
 	bool gnss_pos;
 	bool gnss_time;
 	char startscript[128];
+	bool sat_interp;
 } config_t;
 
 extern config_t config;
 extern config_t config_saved;
 
+// journal_t from journal.h
+struct journal;
+extern struct journal config_journal;
+
 FRESULT config_load();
 FRESULT config_save();
 
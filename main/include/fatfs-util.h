@@ -18,12 +18,53 @@
 //  The official website and doumentation for space-ham is available here:
 //    https://www.kj7nll.radio/
 //
+#ifndef __FATFS_UTIL_H
+#define __FATFS_UTIL_H
+
 #include "ff.h"
 
 char *ff_strerror(FRESULT r);
 FRESULT scan_files(char *path);   /* Start node to be scanned (***also used as work area***) */
-int xmodem_rx(char *filename);
-int xmodem_tx(char *filename);
+int xmodem_rx(char *filename, void (*idle)());
+int xmodem_rx_cb(void (*chunk)(void *ctx, void *buf, int len), void *ctx, void (*idle)());
+int xmodem_tx(char *filename, void (*idle)());
+int zmodem_rx(const char *filename, void (*idle)());
+int zmodem_rx_cb(void (*chunk)(void *ctx, void *buf, int len), void *ctx, void (*idle)());
 
 FRESULT f_write_file(char *filename, void *data, size_t len);
 FRESULT f_read_file(char *filename, void *data, size_t len);
+
+// Address of count sectors in memory-mapped flash, or NULL if they are
+// not mapped in one piece (fatfs-efr32.c)
+const void *disk_map(LBA_t sector, UINT count);
+
+// Buffered text stream over a FIL, see fatfs-util.c
+typedef struct {
+	FIL fp;
+	FRESULT res;
+
+	// Caller's buffer.  Writers flush it in whole sectors, so use a
+	// multiple of 512 bytes.
+	char *buf;
+	UINT size;
+
+	// Reading: unread data is buf[pos..len).  Writing: len bytes are
+	// waiting to be flushed.
+	UINT pos, len;
+
+	BYTE mode;
+	int eof;
+
+	// Number of f_read()/f_write() calls
+	uint32_t reads, writes;
+} f_stream_t;
+
+FRESULT f_stream_open(f_stream_t *s, const char *filename, BYTE mode, void *buf, UINT size);
+char *f_stream_gets(f_stream_t *s, UINT *len);
+FRESULT f_stream_write(f_stream_t *s, const void *data, UINT len);
+FRESULT f_stream_puts(f_stream_t *s, const char *str);
+FRESULT f_stream_flush(f_stream_t *s);
+FRESULT f_stream_close(f_stream_t *s);
+FRESULT f_bench(const char *filename, UINT size);
+
+#endif
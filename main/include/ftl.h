@@ -0,0 +1,83 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+#include <stdint.h>
+
+#include "platform.h"
+
+// Flash translation layer between FatFs and the flash pages of the FAT
+// area, see ftl.c.  Enabled with USE_FTL in the top level CMakeLists.txt.
+
+#define FTL_SECTOR_SIZE 512
+
+// Each page starts with an ftl_page_t header in its first sector and the
+// rest of the page holds FTL_SLOTS sectors.
+#define FTL_SLOTS       (FLASH_PAGE_SIZE / FTL_SECTOR_SIZE - 1)
+
+// Pages that are not counted in the logical size, so garbage collection
+// always has somewhere to copy to and finds pages with few live sectors.
+#define FTL_SPARE_PAGES 4
+
+// Sectors held in the write-back cache
+#define FTL_CACHE       4
+
+#define FTL_MAGIC       0x4C544653 // "SFTL"
+
+// All words of a page header are written once after an erase
+#define FTL_ERASED      0xFFFFFFFF
+
+typedef struct {
+	// FTL_MAGIC and the erase count are written after the page is erased
+	uint32_t magic, erases;
+
+	// Written when the page becomes the write page.  The newest copy of
+	// a sector is in the page with the highest sequence number.
+	uint32_t seq;
+
+	// Logical sector in each slot, written after the slot's data
+	uint32_t tag[FTL_SLOTS];
+
+	// Written before garbage collection erases the page, so a page
+	// whose erase was cut off is not read back as data
+	uint32_t dead;
+} ftl_page_t;
+
+typedef struct {
+	uint32_t reads, writes, cache_hits, programs, erases, gc_runs,
+		gc_copies, min_erases, max_erases;
+} ftl_stats_t;
+
+extern ftl_stats_t ftl_stats;
+
+int ftl_mount();
+int ftl_format();
+int ftl_read(uint8_t *buf, uint32_t lba, uint32_t count);
+int ftl_write(const uint8_t *buf, uint32_t lba, uint32_t count);
+int ftl_sync();
+uint32_t ftl_sectors();
+void ftl_status();
+
+// Raw flash access provided by the disk backend (fatfs-efr32.c).  Pages
+// are numbered from the start of the FAT area and return 0 on success.
+uint32_t ftl_flash_pages();
+int ftl_flash_read(uint32_t page, uint32_t offset, void *buf, uint32_t len);
+int ftl_flash_program(uint32_t page, uint32_t offset, const void *buf, uint32_t len);
+int ftl_flash_erase(uint32_t page);
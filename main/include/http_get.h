@@ -18,4 +18,38 @@
 //  The official website and doumentation for space-ham is available here:
 //    https://www.kj7nll.radio/
 
+#include <stdint.h>
+
+// Socket receive buffer.  The body is passed to chunk() straight from it,
+// so this is also the largest chunk a parser sees.
+#define HTTP_BUF_SIZE 4096
+
+// Validators of the last download into each file are kept in
+// HTTP_CACHE_FILE so an unchanged file costs one request.
+#define HTTP_CACHE_FILE "http.bin"
+#define HTTP_CACHE_MAX 4
+
+// File that http_get() downloads into before it replaces the old one
+#define HTTP_TMP "http.tmp"
+
+typedef struct {
+	// Local file the URL was downloaded into
+	char file[13];
+	char url[128];
+
+	// ETag and Last-Modified of the response, sent back as If-None-Match
+	// and If-Modified-Since.  Empty if the server did not send them.
+	char etag[64];
+	char modified[32];
+
+	// Size and FAT timestamp of file after the download, so the entry is
+	// not used once something else has replaced the file.
+	uint32_t size;
+	uint16_t fdate, ftime;
+} http_cache_t;
+
 int http_get(char *file, const char *orig_url);
+int http_get_cb(const char *orig_url, http_cache_t *cache,
+	void (*chunk)(void *ctx, void *buf, int len), void *ctx);
+int http_cache_find(http_cache_t *cache, const char *file, const char *url);
+void http_cache_save(http_cache_t *cache, int merge);
@@ -97,6 +97,9 @@ typedef volatile struct i2c_req_t
 
 	uint64_t complete_time;
 
+	// rtcc_get() at completion, low 32 bits
+	uint32_t complete_ticks;
+
 	int sample_count, err_count;
 } i2c_req_t;
 
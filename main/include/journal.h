@@ -0,0 +1,163 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ff.h"
+
+// A journal is an append-only file of small records, one per field of the
+// structures it stores.  Saving appends only the fields that changed since
+// the last save followed by a commit record, so an update costs a few
+// dozen bytes and a power cut during a save loses at most that save.
+// Loading replays the journal up to the last commit and applies only the
+// latest record of each field.  Once the file grows past journal_t.max it
+// is compacted into a fresh file holding one record per field.
+//
+// File format: a journal_hdr_t followed by records.  Each record is a
+// journal_rec_t followed by len bytes of data.
+
+#define JOURNAL_MAGIC   0x4C4E524A // "JRNL"
+#define JOURNAL_VERSION 1
+
+// Record tags are (group << 8) | field so that one journal can hold
+// several copies of a structure, for example one group per rotor.
+#define JOURNAL_TAG(group, field) (((group) << 8) | (field))
+#define JOURNAL_TAG_GROUP(tag)    ((tag) >> 8)
+#define JOURNAL_TAG_FIELD(tag)    ((tag) & 0xFF)
+
+// Ends each save.  Its data is the 32-bit commit sequence number.
+#define JOURNAL_TAG_COMMIT 0xFFFF
+
+// Longest record, enough for all ROTOR_CAL_NUM rotor calibration points
+#define JOURNAL_REC_MAX 1152
+
+typedef struct
+{
+	uint32_t magic;
+
+	// JOURNAL_VERSION
+	uint16_t version;
+
+	// Schema of the stored fields, from journal_t.schema
+	uint16_t schema;
+} journal_hdr_t;
+
+typedef struct
+{
+	// CRC-32 of tag, len and the data
+	uint32_t crc;
+
+	uint16_t tag;
+	uint16_t len;
+} journal_rec_t;
+
+// Latest committed record of a tag
+typedef struct
+{
+	uint16_t tag;
+	uint16_t len;
+	uint32_t crc;
+
+	// File offset of the journal_rec_t
+	uint32_t offset;
+} journal_tag_t;
+
+enum {
+	JOURNAL_RAW,
+
+	// NUL-terminated string: only the characters are stored
+	JOURNAL_STR,
+};
+
+// A structure member that is saved as one record
+typedef struct
+{
+	uint8_t field;
+	uint8_t type;
+	uint16_t offset;
+	uint16_t size;
+} journal_field_t;
+
+#define JOURNAL_FIELD(field, type, member) \
+	{ field, JOURNAL_RAW, offsetof(type, member), sizeof(((type *)0)->member) }
+
+#define JOURNAL_FIELD_STR(field, type, member) \
+	{ field, JOURNAL_STR, offsetof(type, member), sizeof(((type *)0)->member) }
+
+typedef struct journal
+{
+	char *filename;
+
+	// Compaction writes this file and then renames it to filename
+	char *tmpname;
+
+	// Schema of the fields this build saves.  Increment it when a field
+	// changes meaning; load() can check file_schema to convert old
+	// records, and the next save compacts the file to the new schema.
+	uint16_t schema;
+
+	// Compact once the file is larger than this many bytes
+	uint32_t max;
+
+	// Table of the latest record of each tag, tags_max entries
+	journal_tag_t *tags;
+	int tags_max;
+
+	// Called by journal_load() with the latest record of each tag
+	void (*load)(struct journal *j, uint16_t tag, const void *data, int len);
+
+	// Called by journal_save() to journal_put() every field
+	void (*save)(struct journal *j);
+
+	// The rest is state, zero it when defining a journal
+
+	int tags_n;
+
+	// Schema of the loaded file
+	uint16_t file_schema;
+
+	// Bytes up to the end of the last commit, 0 if nothing was loaded
+	uint32_t size;
+
+	// Bytes after the last commit when the file was loaded
+	uint32_t torn;
+
+	uint32_t seq;
+
+	// Valid during a save
+	FIL fp;
+	int open;
+	uint32_t pos;
+	FRESULT res;
+
+	// Statistics
+	uint32_t saves, puts, skipped, compactions;
+} journal_t;
+
+FRESULT journal_load(journal_t *j);
+FRESULT journal_save(journal_t *j);
+FRESULT journal_compact(journal_t *j);
+void journal_status(journal_t *j);
+
+void journal_put(journal_t *j, uint16_t tag, const void *data, int len);
+void journal_put_fields(journal_t *j, int group, const journal_field_t *f, int n, const void *base);
+int journal_get_field(const journal_field_t *f, int n, void *base, int field, const void *data, int len);
@@ -0,0 +1,72 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+#include <stdint.h>
+
+#include "platform.h"
+
+// Emulated NOR flash for the Linux build, see nor-sim.c.  fatfs-efr32.c
+// puts the FAT volume on it so storage behaviour can be measured on the
+// host with the same FatFs and FTL code as the EFR32.
+
+// Size of the FAT area on the EFR32MG21 (1 MB flash, FLASH_FAT_BASE 256 kB)
+#define NOR_SIM_SIZE        (768*1024)
+
+// Backing file in the working directory
+#define NOR_SIM_FILE        "flash.img"
+
+// Typical EFR32 Series 1/2 datasheet timing, in microseconds
+#define NOR_SIM_ERASE_US    20000
+#define NOR_SIM_WORD_US     20
+
+// Rated erase cycles per page
+#define NOR_SIM_ENDURANCE   10000
+
+typedef struct {
+	// Raw operations since the last reset
+	uint64_t reads, read_bytes, programs, program_bytes, erases;
+
+	// Words programmed that were not erased, corrupting data on real NOR
+	uint64_t reprograms;
+
+	// Modeled time the flash was busy programming and erasing
+	uint64_t busy_us;
+
+	// Modeled latency of each disk write, from the disk_* layer
+	uint64_t writes, write_us, write_us_max;
+
+	// Disk writes that took <1 ms, <10 ms, <100 ms and longer
+	uint32_t write_hist[4];
+} nor_sim_stats_t;
+
+extern nor_sim_stats_t nor_sim_stats;
+
+int nor_sim_open(const char *path, uint32_t pages);
+int nor_sim_init();
+void nor_sim_close();
+uint32_t nor_sim_pages();
+int nor_sim_read(uint32_t addr, void *buf, uint32_t len);
+int nor_sim_program(uint32_t addr, const void *buf, uint32_t len);
+int nor_sim_erase(uint32_t page);
+const void *nor_sim_map(uint32_t addr, uint32_t len);
+void nor_sim_latency(uint64_t us);
+void nor_sim_reset();
+void nor_sim_status();
@@ -0,0 +1,86 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+#include <stdint.h>
+
+#include "sgp4sdp4.h"
+
+// Number of passes kept in the table.  When there are more passes in the
+// window than this, the ones with the latest AOS are dropped and the
+// window ends at the last AOS kept until there is room again.
+#ifdef __EFR32__
+#define PASS_MAX 256
+#else
+#define PASS_MAX 1024
+#endif
+
+// The pass began before the window start
+#define PASS_OPEN_AOS 0x01
+
+// The pass continues after the window end
+#define PASS_OPEN_LOS 0x02
+
+// The satellite is sunlit while the sun is below PASS_SUN_DARK for the
+// observer at some point of the pass, so it can be seen by eye
+#define PASS_VISIBLE 0x04
+
+// Sun elevation of civil twilight (degrees)
+#define PASS_SUN_DARK -6.0
+
+typedef struct {
+	// Acquisition and loss of signal (unix time)
+	uint32_t aos, los;
+
+	// Maximum elevation during the pass (degrees)
+	float max_el;
+
+	// Index of the satellite in tle.bin
+	uint16_t idx;
+
+	// PASS_OPEN_AOS, PASS_OPEN_LOS, PASS_VISIBLE
+	uint16_t flags;
+} pass_t;
+
+typedef struct {
+	uint32_t magic, version;
+
+	// Size of tle.bin the table was built from
+	uint32_t tle_size;
+
+	// Observer the table was built for (radians)
+	float lat, lon;
+
+	// Time window the table covers (unix time)
+	uint32_t start, end;
+
+	// Number of pass_t records that follow
+	uint32_t count;
+} pass_hdr_t;
+
+void pass_init();
+void pass_step();
+void pass_invalidate();
+int pass_count();
+const pass_t *pass_get(int i);
+int pass_tle(int idx, tle_t *tle);
+void pass_print(int n, int visible);
+void pass_status();
+int pass_build(uint32_t start, int part, int parts);
+void pass_import(pass_t *p, int n, int max, uint32_t start);
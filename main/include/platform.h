@@ -59,7 +59,8 @@ inline static void platform_sleep()
 
 #else
 
-#define FLASH_PAGE_SIZE 4096
+// Same as the EFR32MG21, for the emulated flash in nor-sim.c
+#define FLASH_PAGE_SIZE 8192
 typedef void* TIMER_TypeDef;
 typedef int I2C_TransferReturn_TypeDef;
 
@@ -0,0 +1,70 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+#include "sgp4sdp4.h"
+
+typedef struct {
+	// Julian date of the epoch
+	double jul_epoch;
+
+	// Mean elements and their secular J2 rates (radians and
+	// radians/minute) and the drag term of the mean anomaly
+	// (radians/minute^2)
+	double e, incl, raan, argp, m, n, raan_dot, argp_dot, m_dot, drag;
+
+	// Semi-major axis (km)
+	double a;
+
+	// Largest central angle from the sub-satellite point at which it is
+	// above min_el, plus the model margin (radians)
+	double reach;
+
+	// Upper bound for the rate at which the central angle between the
+	// satellite and the observer can change (radians/minute)
+	double rate;
+
+	// Observer geocentric latitude and longitude (radians)
+	double lat, lon;
+
+	// True if only the latitude test applies (deep space)
+	int deep_space;
+} prefilter_t;
+
+typedef struct {
+	// Satellites passed to prefilter_init()
+	unsigned int sats;
+
+	// Satellites that can never be seen: inclination too low for the
+	// observer's latitude, or perigee below the atmosphere
+	unsigned int latitude, decayed;
+
+	// Satellites rejected by prefilter_next() at the requested time
+	unsigned int window;
+
+	// Propagations that were skipped because of the above
+	unsigned int saved;
+} prefilter_stats_t;
+
+extern prefilter_stats_t prefilter_stats;
+
+int prefilter_init(prefilter_t *pf, const tle_t *tle, const geodetic_t *obs, double min_el);
+double prefilter_next(const prefilter_t *pf, double jul);
+int prefilter_now(const tle_t *tle, double min_el);
+void prefilter_status();
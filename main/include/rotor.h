@@ -171,6 +171,10 @@ extern struct rotor rotors[NUM_ROTORS];
 // These motors will reference the motor in each rotor.
 extern struct motor *motors[NUM_ROTORS];
 
+// journal_t from journal.h, the rotor settings in cal.jnl
+struct journal;
+extern struct journal rotor_journal;
+
 void initRotors();
 
 void motor_init(struct motor *m);
@@ -25,6 +25,7 @@ int rtcc_init(int tps);
 void rtcc_set(uint64_t newticks);
 uint64_t rtcc_get();
 uint64_t rtcc_get_sec();
+int rtcc_ticks_per_sec();
 void rtcc_set_sec(uint64_t t);
 void rtcc_delay_sec(float sec, void (*idle)());
 void rtcc_delay_ticks(uint64_t delay, void (*idle)());
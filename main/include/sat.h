@@ -18,6 +18,8 @@
 //  The official website and doumentation for space-ham is available here:
 //    https://www.kj7nll.radio/
 //
+#include <stdint.h>
+
 #include "sgp4sdp4.h"
 
 typedef struct {
@@ -30,11 +32,23 @@ typedef struct {
 		// Satellite's observed position, range, range rate
 		sat_az, sat_el, sat_range, sat_range_rate,
 
+		// Rate of change of the observed azimuth and elevation (deg/sec)
+		sat_az_rate, sat_el_rate,
+
 		// Satellites geodetic position and velocityg
 		sat_lat, sat_long, sat_alt, sat_vel,
 
 		// Solar azmuth and elvationg
-		sun_az, sun_el;
+		sun_az, sun_el,
+
+		// Julian UTC date of the last update
+		jul_utc,
+
+		// Julian date of the TLE epoch
+		jul_epoch;
+
+	// ECI position of the last update (km)
+	vector_t pos;
 
 	int
 		// True if the TLE is valid for tracking
@@ -47,14 +61,52 @@ typedef struct {
 		deep_space;
 } sat_t;
 
+typedef struct {
+	// True once calculated
+	int valid;
+
+	// rtcc tick count this context was calculated for
+	uint64_t ticks;
+
+	// Julian UTC date
+	double jul_utc;
+
+	// Greenwich mean sidereal time (radians)
+	double gmst;
+} sat_tick_t;
+
+typedef struct {
+	// Julian UTC date the solar position was calculated for
+	double jul_utc;
+
+	// Solar ECI position vector (km)
+	vector_t pos;
+
+	// Solar azimuth and elevation from the observer (degrees)
+	double sun_az, sun_el;
+} sat_solar_t;
+
 void tle_info(tle_t *s);
 void tle_detail(tle_t *s);
 int tle_csum(char *s);
 
+// catalog_rec_t from catalog.h
+struct catalog_rec;
+
 const sat_t *sat_init(tle_t *tle);
+const sat_t *sat_init_rec(const struct catalog_rec *rec);
 const sat_t *sat_update();
+const sat_t *sat_update_exact();
 void sat_status();
 int sat_tle_line(tle_t *tle, int line, char *tle_set, char *buf);
 void sat_tle_to_bin();
 void sat_reset();
+void sat_reselect();
 const sat_t *sat_get();
+const sat_solar_t *sat_solar(double jul_utc);
+int sat_sunlit(double jul_utc, vector_t *pos, double *depth);
+const sat_tick_t *sat_tick_now();
+void sat_observer_invalidate();
+void sat_lock_init();
+void sat_lock();
+void sat_unlock();
@@ -27,6 +27,7 @@ void serial_write(void *s, int len);
 void serial_read(void *s, int len);
 void serial_read_idle(void *s, int len, void (*idle)());
 int serial_read_timeout(void *s, int len, float timeout);
+int serial_read_timeout_idle(void *s, int len, float timeout, void (*idle)());
 int serial_read_line(char *s, int len);
 int serial_read_done();
 void serial_read_async(void *s, int len);
@@ -0,0 +1,41 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+#include "sgp4sdp4.h"
+
+// Mixed-precision SGP4 state for one near-earth satellite.  Values that
+// multiply the time since epoch are kept in double so the mean anomaly,
+// node and perigee do not lose precision days away from the epoch;
+// everything else is single precision.
+typedef struct {
+	// Epoch elements and secular rates (radians, radians/minute)
+	double xmo, omegao, xnodeo, xmdot, omgdot, xnodot, xnodcf, xnodp;
+
+	float eo, xincl, bstar, aodp, aycof, c1, c4, c5, cosio, sinio,
+		d2, d3, d4, delmo, omgcof, eta, sinmo, t2cof, t3cof, t4cof,
+		t5cof, x1mth2, x3thm1, x7thm1, xmcof, xlcof;
+
+	// True if perigee is below 220 km and the drag terms are truncated
+	int simple;
+} sgp4f_t;
+
+void sgp4f_init(sgp4f_t *sgp, tle_t *tle);
+void sgp4f(sgp4f_t *sgp, double tsince, vector_t *pos, vector_t *vel);
+void sgp4f_check(double days, double step_min);
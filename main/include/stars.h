@@ -1,41 +1,69 @@
-typedef struct star_t { 
-	// Name for the star (followed by its "proper" name in parenthesis).
-	char *name;
+#include <stdint.h>
 
-	// Spectral classification of the main stars in the system.
-	char *spec_type;
+#include "astronomy.h"
 
-	// Right Ascension in hours and minutes for epoch 2000.
-	double ra;
+// The catalog itself lives in stars.csv and is turned into read-only
+// tables by gen-stars.pl at build time.  Use the star_*() accessors below
+// rather than the tables where possible.
 
-	// Declination in degrees for epoch 2000.
-	double dec;
+// Hot data used for tracking and batched horizon calculations.
+typedef struct star_t {
+	// J2000 equatorial unit vector.
+	float x, y, z;
 
-	// Galactic longitude of the star.
-	double gal_lat;
+	// Visual magnitude of the star (x100).
+	int16_t mag_vis;
 
-	// Galactic latitude of the star.
-	double gal_long;
+	// Offsets of the name (followed by its "proper" name in parenthesis)
+	// and the spectral classification in stars_strings[].
+	uint16_t name, spec_type;
+} star_t;
 
-	// Visual magnitude of the star.
-	double mag_vis;
+// Cold metadata that is only displayed.
+typedef struct star_info_t {
+	// Galactic latitude and longitude in degrees (NAN if unknown).
+	float gal_lat;
+	float gal_long;
 
 	// Absolute magnitude of the star.
-	double mag_abs;
+	float mag_abs;
 
 	// The Hipparcos parallax of the star (x1000).
-	double hip_parlx;
+	float hip_parlx;
 
 	// The error in the parallax (x1000).
-	double hip_parlx_err;
+	float hip_parlx_err;
 
 	// The distance in light years (=3.2616/parallax).
-	double dist_ly;
+	float dist_ly;
 
-} star_t;
+} star_info_t;
 
 extern const star_t stars[];
+extern const star_info_t stars_info[];
+extern const char stars_strings[];
+
+// Sky index: star indexes sorted by declination band and then by RA.
+// The entries of band b are stars_band_idx[stars_band_start[b]] up to
+// stars_band_start[b+1]-1, and stars_band_ra[] holds the RA of each entry
+// scaled to 0..65535 for binary search.
+extern const uint16_t stars_band_start[];
+extern const uint16_t stars_band_idx[];
+extern const uint16_t stars_band_ra[];
 int _num_stars();
 
 #define NUM_STARS _num_stars()
 
+const char *star_name(int i);
+const char *star_spec_type(int i);
+double star_ra(int i);
+double star_dec(int i);
+double star_mag(int i);
+const star_info_t *star_info(int i);
+void star_define(astro_body_t body, int i);
+
+int stars_horizon(astro_time_t *time, astro_observer_t observer, double min_alt,
+	void (*cb)(int idx, double az, double alt, void *arg), void *arg);
+int stars_near(astro_time_t *time, astro_observer_t observer,
+	double az, double el, double radius,
+	void (*cb)(int idx, double az, double alt, void *arg), void *arg);
@@ -18,9 +18,13 @@
 //  The official website and doumentation for space-ham is available here:
 //    https://www.kj7nll.radio/
 //
+#include <stdint.h>
+
 int match(char *a, char *b);
 int longest_length(char **a);
 void shift_right(char *s, int pos);
 void shift_left(char *s, int pos);
 int parse_args(char *s, char **args, int argc);
 char *lltoa(long long val, int base);
+uint32_t crc32_ieee(const void *data, int len);
+uint32_t crc32_ieee_update(uint32_t crc, const void *data, int len);
@@ -18,7 +18,32 @@
 //  The official website and doumentation for space-ham is available here:
 //    https://www.kj7nll.radio/
 //
+#include <stdint.h>
 
 int systick_update();
 void systick_bypass(int b);
 int systick_init(int tps);
+int systick_hz();
+
+// Interval statistics of a periodic job, see jitter_mark()
+typedef struct {
+	// systick_clock() of the last run
+	uint32_t last;
+	int started;
+
+	// Intervals in systick_clock() units
+	uint32_t count, late;
+	uint32_t min, max;
+	uint64_t sum;
+} jitter_t;
+
+extern jitter_t pid_jitter;
+
+// Rotor target updates by tracking_update() in main.c
+extern jitter_t tracking_jitter;
+
+uint32_t systick_clock();
+uint32_t systick_clock_hz();
+void jitter_mark(jitter_t *j, uint32_t period_us);
+void jitter_reset(jitter_t *j);
+void jitter_print(const char *name, jitter_t *j);
@@ -0,0 +1,126 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+#include <stdint.h>
+
+// Rotor telemetry log: pid_update() puts one tlog_sample_t per rotor and
+// tick into a RAM ring, and tlog_step() compresses them into 512 byte
+// blocks that are written to a file.  See tlog.c for the encoding and
+// tools/tlog-dump.c to convert a log to CSV.
+
+#define TLOG_MAGIC   0x4C54 // "TL"
+#define TLOG_VERSION 1
+
+#define TLOG_FILE "tlog.bin"
+
+// One FAT sector, so every block write is sector aligned
+#define TLOG_BLOCK_SIZE 512
+
+// Samples buffered between pid_update() and tlog_step().  Two rotors at
+// 100 Hz fill 256 samples in 1.28 seconds.
+#ifdef __EFR32__
+#define TLOG_RING 256
+#else
+#define TLOG_RING 1024
+#endif
+
+// CPU budget of one tlog_step(): at most this many samples are encoded
+// and at most one block is written.
+#define TLOG_CHUNK 64
+
+// Call f_sync() every this many blocks so a power cut loses little
+#define TLOG_SYNC_BLOCKS 32
+
+// Degrees are logged in 1/TLOG_DEG_SCALE units and the motor output
+// (-1 to 1) in 1/TLOG_OUT_SCALE units.
+#define TLOG_DEG_SCALE 100
+#define TLOG_OUT_SCALE 1000
+
+// tlog_sample_t.age when the sensor has no timestamp
+#define TLOG_AGE_UNKNOWN 255
+
+// tlog_sample_t flags: rotor_pos() failed and pos is not valid
+#define TLOG_POS_NAN 0x01
+
+// tlog_sample_t flags: samples were dropped before this one because the
+// ring was full
+#define TLOG_GAP     0x02
+
+typedef struct
+{
+	// pid_update() tick count
+	uint32_t tick;
+
+	// rtcc_get() when the sample was taken, low 32 bits
+	uint32_t rtcc;
+
+	// Target and position (1/TLOG_DEG_SCALE degrees).  The PID error is
+	// target - pos.
+	int32_t target, pos;
+
+	// Motor speed (1/TLOG_OUT_SCALE)
+	int16_t out;
+
+	uint8_t rotor;
+
+	// TLOG_POS_NAN, TLOG_GAP
+	uint8_t flags;
+
+	// rtcc ticks since the position sensor's last reading, up to 254
+	uint8_t age;
+} tlog_sample_t;
+
+typedef struct
+{
+	// CRC-32 of the block after this field, up to len bytes of samples
+	uint32_t crc;
+
+	uint16_t magic;
+	uint8_t version;
+
+	// pid_update() ticks per second
+	uint8_t hz;
+
+	// Bytes of encoded samples and number of samples after the header
+	uint16_t len, count;
+
+	// Block number in the log
+	uint32_t seq;
+
+	// The first sample's tick is encoded relative to this one
+	uint32_t tick;
+
+	// Unix time of the first sample: time + frac/tps
+	uint32_t time;
+	uint16_t frac, tps;
+
+	// Samples dropped since the log was started
+	uint32_t dropped;
+} tlog_block_t;
+
+void tlog_sample(uint32_t tick, int rotor, float pos, float out);
+void tlog_step();
+
+int tlog_start(char *filename);
+void tlog_stop();
+void tlog_status();
+
+int tlog_decode(const void *block, void (*cb)(const tlog_block_t *b, const tlog_sample_t *s, void *arg), void *arg);
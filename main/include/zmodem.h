@@ -0,0 +1,65 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+
+// ZMODEM receiver, see zmodem.c.  Received data is passed to a
+// zmodem_sink_t so it can go to a file or straight into a parser.
+
+// Bytes the sender may send before it waits for an acknowledgement.
+// Data is held in RAM until then, so the sink can write to flash while
+// the line is idle and nothing is lost from the 1 kB serial ring.
+#ifdef __EFR32__
+#define ZMODEM_WINDOW 2048
+#else
+#define ZMODEM_WINDOW 8192
+#endif
+
+// Seconds to wait for a header before asking again, and how many times
+#define ZMODEM_TIMEOUT 10
+#define ZMODEM_RETRIES 10
+
+typedef struct {
+	// A file is starting.  size is -1 if the sender did not send it, and
+	// resume is set if the sender asked to continue a partial file (sz -r).
+	// Return the offset to receive from, 0 for the whole file, or -1 to
+	// skip the file.
+	long (*open)(void *ctx, const char *name, long size, int resume);
+
+	// Data in file order, only after its CRC was checked.  Return 0, or
+	// -1 to cancel the transfer.
+	int (*write)(void *ctx, const void *buf, int len);
+
+	// The file ended.  complete is 0 if the transfer was cancelled.
+	void (*close)(void *ctx, int complete);
+
+	void *ctx;
+} zmodem_sink_t;
+
+typedef struct {
+	int files;
+	long bytes;
+
+	// Data subpackets or headers that were retransmitted after an error
+	int errors;
+} zmodem_stats_t;
+
+// idle() is called while waiting for serial data, it may be NULL.
+int zmodem_receive(const zmodem_sink_t *sink, zmodem_stats_t *stats, void (*idle)());
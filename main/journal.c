@@ -0,0 +1,433 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+#include <stdio.h>
+#include <string.h>
+
+#include "ff.h"
+#include "fatfs-util.h"
+
+#include "journal.h"
+#include "strutil.h"
+
+// Holds one record while it is written or read
+static uint8_t journal_buf[sizeof(journal_rec_t) + JOURNAL_REC_MAX];
+
+static journal_tag_t *journal_tag(journal_t *j, uint16_t tag)
+{
+	int i;
+
+	for (i = 0; i < j->tags_n; i++)
+		if (j->tags[i].tag == tag)
+			return &j->tags[i];
+
+	return NULL;
+}
+
+// Record the latest record of a tag.  Returns 0 if the table is full.
+static int journal_tag_set(journal_t *j, const journal_rec_t *rec, uint32_t offset)
+{
+	journal_tag_t *t = journal_tag(j, rec->tag);
+
+	if (t == NULL)
+	{
+		if (j->tags_n >= j->tags_max)
+			return 0;
+
+		t = &j->tags[j->tags_n++];
+		t->tag = rec->tag;
+	}
+
+	t->len = rec->len;
+	t->crc = rec->crc;
+	t->offset = offset;
+
+	return 1;
+}
+
+// Read the record at the current position into journal_buf and check it.
+// Returns its total size, or 0 at the end of the file or a torn record.
+static int journal_read_rec(FIL *fp)
+{
+	journal_rec_t *rec = (journal_rec_t *)journal_buf;
+	FRESULT res;
+	UINT br;
+
+	res = f_read(fp, rec, sizeof(*rec), &br);
+	if (res != FR_OK || br != sizeof(*rec) || rec->len > JOURNAL_REC_MAX)
+		return 0;
+
+	res = f_read(fp, rec + 1, rec->len, &br);
+	if (res != FR_OK || br != rec->len)
+		return 0;
+
+	if (crc32_ieee(&rec->tag, sizeof(*rec) - sizeof(rec->crc) + rec->len) != rec->crc)
+		return 0;
+
+	return sizeof(*rec) + rec->len;
+}
+
+// Replay j->filename: find the last commit, index the latest record of
+// each tag before it, then pass only those records to j->load().  A
+// missing or damaged file returns an error and leaves j empty so that the
+// next save writes a complete new file.
+FRESULT journal_load(journal_t *j)
+{
+	journal_rec_t *rec = (journal_rec_t *)journal_buf;
+	journal_hdr_t h;
+	FILINFO fno;
+	FRESULT res;
+	FIL in;
+	UINT br;
+	uint32_t pos;
+	int len, i;
+
+	j->tags_n = 0;
+	j->size = 0;
+	j->torn = 0;
+	j->seq = 0;
+	j->file_schema = 0;
+
+	res = f_open(&in, j->filename, FA_READ);
+
+	// A compaction that was cut off before the rename
+	if (res == FR_NO_FILE && f_stat(j->tmpname, &fno) == FR_OK)
+	{
+		printf("%s: recovering from %s\r\n", j->filename, j->tmpname);
+		f_rename(j->tmpname, j->filename);
+		res = f_open(&in, j->filename, FA_READ);
+	}
+	else if (res == FR_OK)
+		f_unlink(j->tmpname);
+
+	if (res != FR_OK)
+		return res;
+
+	res = f_read(&in, &h, sizeof(h), &br);
+	if (res == FR_OK && (br != sizeof(h) || h.magic != JOURNAL_MAGIC || h.version != JOURNAL_VERSION))
+		res = FR_INVALID_OBJECT;
+
+	if (res != FR_OK)
+	{
+		printf("%s: invalid journal header: %s\r\n", j->filename, ff_strerror(res));
+		f_close(&in);
+		return res;
+	}
+
+	j->file_schema = h.schema;
+
+	// Everything after the last commit belongs to a save that did not
+	// finish.
+	pos = sizeof(h);
+	while ((len = journal_read_rec(&in)) > 0)
+	{
+		pos += len;
+		if (rec->tag == JOURNAL_TAG_COMMIT && rec->len == sizeof(j->seq))
+		{
+			memcpy(&j->seq, rec + 1, sizeof(j->seq));
+			j->size = pos;
+		}
+	}
+
+	if (j->size == 0)
+	{
+		printf("%s: no commits\r\n", j->filename);
+		f_close(&in);
+		return FR_INVALID_OBJECT;
+	}
+
+	j->torn = f_size(&in) - j->size;
+
+	// The records were checked above, so only the headers are read here
+	pos = sizeof(h);
+	f_lseek(&in, pos);
+	while (pos < j->size)
+	{
+		res = f_read(&in, rec, sizeof(*rec), &br);
+		if (res != FR_OK || br != sizeof(*rec))
+			break;
+
+		if (rec->tag != JOURNAL_TAG_COMMIT && !journal_tag_set(j, rec, pos))
+			printf("%s: tag table full, %04X dropped\r\n", j->filename, rec->tag);
+
+		pos += sizeof(*rec) + rec->len;
+		f_lseek(&in, pos);
+	}
+
+	for (i = 0; res == FR_OK && i < j->tags_n; i++)
+	{
+		f_lseek(&in, j->tags[i].offset);
+		if (journal_read_rec(&in) > 0)
+			j->load(j, rec->tag, rec + 1, rec->len);
+		else
+			res = FR_INT_ERR;
+	}
+
+	f_close(&in);
+
+	if (res != FR_OK)
+	{
+		printf("%s: read error %d: %s\r\n", j->filename, res, ff_strerror(res));
+		j->tags_n = 0;
+		j->size = 0;
+	}
+
+	return res;
+}
+
+// Append a record unless the latest record of tag already holds the same
+// data.  Only valid from the j->save() callback; errors are kept in j->res
+// and returned by journal_save().
+void journal_put(journal_t *j, uint16_t tag, const void *data, int len)
+{
+	journal_rec_t *rec = (journal_rec_t *)journal_buf;
+	journal_tag_t *t;
+	UINT bw;
+
+	if (j->res != FR_OK)
+		return;
+
+	if (len > JOURNAL_REC_MAX)
+	{
+		printf("%s: record %04X too long: %d\r\n", j->filename, tag, len);
+		j->res = FR_INVALID_PARAMETER;
+		return;
+	}
+
+	rec->tag = tag;
+	rec->len = len;
+	memcpy(rec + 1, data, len);
+	rec->crc = crc32_ieee(&rec->tag, sizeof(*rec) - sizeof(rec->crc) + len);
+
+	t = journal_tag(j, tag);
+	if (t != NULL && t->len == rec->len && t->crc == rec->crc)
+	{
+		j->skipped++;
+		return;
+	}
+
+	// The file is opened on the first change so that a save without
+	// changes does not touch it.
+	if (!j->open)
+	{
+		j->res = f_open(&j->fp, j->filename, FA_OPEN_ALWAYS | FA_WRITE);
+		if (j->res == FR_OK)
+			j->res = f_lseek(&j->fp, j->size);
+
+		// Drop a torn save or the records of a failed one
+		if (j->res == FR_OK && f_size(&j->fp) > j->size)
+			j->res = f_truncate(&j->fp);
+
+		if (j->res != FR_OK)
+		{
+			printf("%s: open error %d: %s\r\n", j->filename, j->res, ff_strerror(j->res));
+			return;
+		}
+
+		j->open = 1;
+		j->pos = j->size;
+		j->torn = 0;
+	}
+
+	j->res = f_write(&j->fp, rec, sizeof(*rec) + len, &bw);
+	if (j->res == FR_OK && bw != sizeof(*rec) + len)
+		j->res = FR_DENIED;
+
+	if (j->res != FR_OK)
+	{
+		printf("%s: write error %d: %s\r\n", j->filename, j->res, ff_strerror(j->res));
+		return;
+	}
+
+	if (tag != JOURNAL_TAG_COMMIT)
+	{
+		journal_tag_set(j, rec, j->pos);
+		j->puts++;
+	}
+
+	j->pos += sizeof(*rec) + len;
+}
+
+// Write the commit record and close the file.  Returns the first error of
+// the save.
+static FRESULT journal_commit(journal_t *j)
+{
+	FRESULT res;
+	uint32_t seq = j->seq + 1;
+
+	// Nothing changed
+	if (!j->open && j->res == FR_OK)
+		return FR_OK;
+
+	if (j->open)
+	{
+		journal_put(j, JOURNAL_TAG_COMMIT, &seq, sizeof(seq));
+
+		res = f_close(&j->fp);
+		if (j->res == FR_OK)
+			j->res = res;
+
+		j->open = 0;
+	}
+
+	if (j->res == FR_OK)
+	{
+		j->seq = seq;
+		j->size = j->pos;
+	}
+	else
+	{
+		// The tag table now describes records that were not committed,
+		// so forget it and write every field next time.
+		j->tags_n = 0;
+	}
+
+	return j->res;
+}
+
+// Write every field into j->tmpname and replace j->filename with it
+FRESULT journal_compact(journal_t *j)
+{
+	journal_hdr_t h;
+	FRESULT res;
+	UINT bw;
+
+	j->res = f_open(&j->fp, j->tmpname, FA_CREATE_ALWAYS | FA_WRITE);
+	if (j->res != FR_OK)
+	{
+		printf("%s: open error %d: %s\r\n", j->tmpname, j->res, ff_strerror(j->res));
+		return j->res;
+	}
+
+	h.magic = JOURNAL_MAGIC;
+	h.version = JOURNAL_VERSION;
+	h.schema = j->schema;
+
+	j->res = f_write(&j->fp, &h, sizeof(h), &bw);
+	if (j->res == FR_OK && bw != sizeof(h))
+		j->res = FR_DENIED;
+
+	j->open = 1;
+	j->pos = sizeof(h);
+	j->tags_n = 0;
+
+	if (j->res == FR_OK)
+		j->save(j);
+
+	res = journal_commit(j);
+	if (res == FR_OK)
+	{
+		res = f_unlink(j->filename);
+		if (res == FR_NO_FILE)
+			res = FR_OK;
+	}
+
+	if (res == FR_OK)
+		res = f_rename(j->tmpname, j->filename);
+
+	if (res != FR_OK)
+	{
+		printf("%s: compaction failed %d: %s\r\n", j->filename, res, ff_strerror(res));
+		j->tags_n = 0;
+		j->size = 0;
+		return res;
+	}
+
+	j->file_schema = j->schema;
+	j->torn = 0;
+	j->compactions++;
+
+	return FR_OK;
+}
+
+// Append the fields that changed since the last save or load.  A journal
+// that was never loaded, has an old schema or has grown past j->max is
+// compacted instead.
+FRESULT journal_save(journal_t *j)
+{
+	j->saves++;
+
+	if (j->size == 0 || j->file_schema != j->schema || j->size > j->max)
+		return journal_compact(j);
+
+	j->res = FR_OK;
+	j->save(j);
+
+	return journal_commit(j);
+}
+
+// Put the members f[0..n-1] of the structure at base as tags in group
+void journal_put_fields(journal_t *j, int group, const journal_field_t *f, int n, const void *base)
+{
+	const char *p;
+	int i;
+
+	for (i = 0; i < n; i++)
+	{
+		p = (const char *)base + f[i].offset;
+
+		if (f[i].type == JOURNAL_STR)
+			journal_put(j, JOURNAL_TAG(group, f[i].field), p, strnlen(p, f[i].size));
+		else
+			journal_put(j, JOURNAL_TAG(group, f[i].field), p, f[i].size);
+	}
+}
+
+// Copy the data of a record for field into the structure at base.  Returns
+// 0 if field is not in f[0..n-1] or its size does not match.
+int journal_get_field(const journal_field_t *f, int n, void *base, int field, const void *data, int len)
+{
+	char *p;
+	int i;
+
+	for (i = 0; i < n; i++)
+	{
+		if (f[i].field != field)
+			continue;
+
+		p = (char *)base + f[i].offset;
+
+		if (f[i].type == JOURNAL_STR && len < f[i].size)
+		{
+			memcpy(p, data, len);
+			memset(p + len, 0, f[i].size - len);
+			return 1;
+		}
+
+		if (len != f[i].size)
+			return 0;
+
+		memcpy(p, data, len);
+		return 1;
+	}
+
+	return 0;
+}
+
+void journal_status(journal_t *j)
+{
+	printf("%s: %lu bytes, schema %d/%d, %d/%d tags, commit %lu, %lu torn bytes\r\n"
+		"  %lu saves, %lu records written, %lu unchanged, %lu compactions\r\n",
+		j->filename, (unsigned long)j->size, j->file_schema, j->schema,
+		j->tags_n, j->tags_max, (unsigned long)j->seq, (unsigned long)j->torn,
+		(unsigned long)j->saves, (unsigned long)j->puts,
+		(unsigned long)j->skipped, (unsigned long)j->compactions);
+}
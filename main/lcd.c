@@ -19,6 +19,8 @@
 //    https://www.kj7nll.radio/
 
 #include <stdio.h>
+#include <stdint.h>
+#include <time.h>
 
 #include "platform.h"
 #include "esp_lcd_panel_io.h"
@@ -30,8 +32,11 @@
 #include "lcd.h"
 
 #include "astronomy.h"
+#include "astro_cache.h"
 #include "stars.h"
 #include "sat.h"
+#include "pass.h"
+#include "catalog.h"
 #include "config.h"
 #include "main.h"
 
@@ -55,6 +60,7 @@
 // These definetions are defined in main.c
 extern char *astro_tracked_name;
 extern astro_body_t astro_tracked_body;
+extern astro_cache_t astro_tracked_cache;
 
 lv_indev_t *indev_keypad;
 lv_indev_drv_t indev_drv;
@@ -210,6 +216,7 @@ void stop_track()
 	sat_reset();
 	astro_tracked_name = NULL;
 	astro_tracked_body = BODY_INVALID;
+	astro_cache_reset(&astro_tracked_cache);
 }
 
 void ev_label_scroll_cb(lv_event_t * e)
@@ -247,11 +254,10 @@ void ev_track_star_cb(lv_event_t *e)
 {
 	stop_track(); // Stop the current track to start a new one
 
-	star_t *star = lv_event_get_user_data(e);
+	int star_idx = (intptr_t)lv_event_get_user_data(e);
 
-	Astronomy_DefineStar(BODY_STAR1,
-		stars->ra, star->dec, star->dist_ly);
-	astro_tracked_name = star->name;
+	star_define(BODY_STAR1, star_idx);
+	astro_tracked_name = (char*)star_name(star_idx);
 	astro_tracked_body = BODY_STAR1;
 
 	set_status_bar_label(astro_tracked_name);
@@ -261,44 +267,19 @@ void ev_track_sat_cb(lv_event_t *e)
 {
 	stop_track(); // Stop the current track to start a new one
 
-	int sat_idx = (int)lv_event_get_user_data(e);
+	int sat_idx = (intptr_t)lv_event_get_user_data(e);
 
-	// API result code
-	FRESULT res = FR_OK;
-	// File object
-	FIL in;
-	// Bytes read
-	UINT br;
+	const catalog_rec_t *rec;
+	catalog_rec_t rec_buf;
 
-	tle_t tle_tmp;
-
-	res = f_open(&in, "tle.bin", FA_READ);
-	if (res != FR_OK)
-	{
-		printf("tle.bin: error %d: %s\r\n", res, ff_strerror(res));
-		f_close(&in);
-		return;
-	}
-
-	res = f_lseek(&in, sizeof(tle_tmp) * sat_idx);
-	if (res != FR_OK)
+	rec = catalog_get(sat_idx, &rec_buf);
+	if (rec == NULL || sat_init_rec(rec) == NULL)
 	{
-		printf("tle.bin: seek error %d: %s\r\n", res, ff_strerror(res));
-		f_close(&in);
+		printf("tle.bin: cannot read record %d\r\n", sat_idx);
 		return;
 	}
 
-	res = f_read(&in, &tle_tmp, sizeof(tle_tmp), &br);
-	if (res != FR_OK)
-	{
-		printf("tle.bin: read error %d: %s\r\n", res, ff_strerror(res));
-		f_close(&in);
-		return;
-	}
-
-	sat_init(&tle_tmp);
-
-	set_status_bar_label(tle_tmp.sat_name);
+	set_status_bar_label(sat_get()->tle.sat_name);
 }
 
 void ev_cal_mag_cb(lv_event_t *e)
@@ -438,48 +419,52 @@ void lvgl_menu()
 		lv_obj_t *sub_page_star = lv_menu_page_create(menu, NULL);
 		lv_obj_t *sub_page_config = lv_menu_page_create(menu, NULL);
 
-		// API result code
-		FRESULT res = FR_OK;
-		// File object
-		FIL in;
-		// Bytes read
-		UINT br;
-
+		const catalog_rec_t *rec;
+		catalog_rec_t rec_buf;
 		tle_t tle_tmp;
 
 		int i, count;
 
-		res = f_open(&in, "tle.bin", FA_READ);
-		if (res != FR_OK)
-		{
-			printf("tle.bin: error %d: %s\r\n", res, ff_strerror(res));
-			f_close(&in);
-			return;
-		}
-
-		i = 0;
+		// List upcoming passes from the pass table when it is ready,
+		// otherwise the first satellites in tle.bin.
 		count = 0;
-
-		do
+		for (i = 0; i < pass_count() && count < 10; i++)
 		{
-			res = f_read(&in, &tle_tmp, sizeof(tle_tmp), &br);
-			if (br < sizeof(tle_tmp))
-				break;
+			const pass_t *p = pass_get(i);
+			struct tm aos;
+			time_t t = p->aos;
+			char label[48];
+
+			if (p->los < time(NULL) || !pass_tle(p->idx, &tle_tmp))
+				continue;
 
-			//if (strcasestr(tle_tmp.sat_name, "oresat")
-			//	|| strcasestr(tle_tmp.sat_name, "iss")
-			//	|| strcasestr(tle_tmp.sat_name, "zarya")
-			//	   )
-			//{
-				cont = menu_item(group, menu, sub_page_sat, NULL, &style, tle_tmp.sat_name);
-				lv_obj_add_event_cb(cont, ev_track_sat_cb, LV_EVENT_PRESSED, (void*)i);
-				count++;
-			//}
+			gmtime_r(&t, &aos);
+			snprintf(label, sizeof(label), "%02d:%02d %s",
+				aos.tm_hour, aos.tm_min, tle_tmp.sat_name);
 
-			i++;
-		} while (res == FR_OK && count < 10);
+			cont = menu_item(group, menu, sub_page_sat, NULL, &style, label);
+			lv_obj_add_event_cb(cont, ev_track_sat_cb, LV_EVENT_PRESSED, (void*)(int)p->idx);
+			count++;
+		}
 
-		f_close(&in);
+		if (count == 0)
+		{
+			for (i = 0; count < 10 && (rec = catalog_get(i, &rec_buf)) != NULL; i++)
+			{
+				if (!catalog_unpack(rec, &tle_tmp))
+					continue;
+
+				//if (strcasestr(tle_tmp.sat_name, "oresat")
+				//	|| strcasestr(tle_tmp.sat_name, "iss")
+				//	|| strcasestr(tle_tmp.sat_name, "zarya")
+				//	   )
+				//{
+					cont = menu_item(group, menu, sub_page_sat, NULL, &style, tle_tmp.sat_name);
+					lv_obj_add_event_cb(cont, ev_track_sat_cb, LV_EVENT_PRESSED, (void*)(intptr_t)i);
+					count++;
+				//}
+			}
+		}
 
 		for (i = 0; i < num_bodies; i++)
 		{
@@ -489,8 +474,8 @@ void lvgl_menu()
 
 		for (i = 0; i < 5; i++)
 		{
-			cont = menu_item(group, menu, sub_page_star, NULL, &style, stars[i].name);
-			lv_obj_add_event_cb(cont, ev_track_star_cb, LV_EVENT_PRESSED, &stars[i]);
+			cont = menu_item(group, menu, sub_page_star, NULL, &style, star_name(i));
+			lv_obj_add_event_cb(cont, ev_track_star_cb, LV_EVENT_PRESSED, (void*)(intptr_t)i);
 		}
 
 		menu_item(group, menu, main_page, sub_page_sat, &style, "Satellite");
@@ -32,6 +32,7 @@
 #include "fatfs-util.h"
 
 #include "astronomy.h"
+#include "astro_cache.h"
 
 #include "linklist.h"
 #include "serial.h"
@@ -40,6 +41,8 @@
 #include "rotor.h"
 #include "pwm.h"
 #include "flash.h"
+#include "ftl.h"
+#include "nor-sim.h"
 #include "systick.h"
 #include "rtcc.h"
 #include "gnss.h"
@@ -56,9 +59,16 @@
 #include "lcd.h"
 
 #include "sat.h"
+#include "sgp4f.h"
+#include "sgp4-verify.h"
+#include "pass.h"
+#include "prefilter.h"
+#include "catalog.h"
 #include "stars.h"
 
 #include "config.h"
+#include "journal.h"
+#include "tlog.h"
 
 #define LED_PORT gpioPortB
 #define LED0_PIN 0
@@ -70,12 +80,25 @@ time_t boot_time;
 
 char *astro_tracked_name = NULL;
 astro_body_t astro_tracked_body = BODY_INVALID;
+astro_cache_t astro_tracked_cache;
 
 void dispatch(int argc, char **args, struct linklist *history);
 void vi(char *filename);
 void run_script(const char *filename);
 int idle_counts = 0;
+
+// tracking_update() interval on the ESP32.  The EFR32 calls it whenever it
+// is idle, so this is only used to count late updates there.
+#define TRACKING_MS 10
+
+// Interval between rotor target updates by tracking_update()
+jitter_t tracking_jitter;
+
+// Rotors that point in azimuth and elevation
+static int az_rotor_idx = 0;
+static int el_rotor_idx = 1;
 void main_idle();
+void transfer_idle();
 void meminfo();
 
 #ifdef __EFR32__
@@ -184,10 +207,11 @@ void help()
 		"rotor <rotor_name> (cal|detail|pid|target|ramptime|adc)         # Rotor commands\r\n"
 		"calmag <sec>                                                    # Calibrate magentometer\r\n"
 		"pc <command_prefix>                                             # prefix a command\r\n"
-		"flash (save|load)                                               # Save to flash\r\n"
+		"flash (save|load|status|compact)                                # Save to flash\r\n"
+		"tlog (start [file]|stop|status)                                 # Log rotor telemetry\r\n"
 		"mv <motor_name> <([+-]deg|n|e|s|w)>                             # Moves antenna\r\n"
 		"sat (load|rx|demo|track|list|search)                            # Track satellites\r\n"
-		"astro (list|search <body>|track <body>)                         # Track celestial bodies\r\n"
+		"astro (list|search <body>|track <body>|cache)                   # Track celestial bodies\r\n"
 		"fat (mkfs|mount|rx <file>|cat <file>|load <file>|find|umount)   # FAT filesystem\r\n"
 		"hist|history                                                    # History of commands\r\n"
 		"reset|reboot                                                    # Reset the CPU (reboot)\r\n"
@@ -1047,12 +1071,46 @@ void mv(int argc, char **args)
 	r->target = deg;
 }
 
+void tlog(int argc, char **args)
+{
+	if (argc < 2)
+	{
+		print("Usage: tlog (start [file]|stop|status)\r\n"
+			"start [file]     # Log the rotor control loop to file (default " TLOG_FILE ")\r\n"
+			"stop             # Stop logging and write what is left\r\n"
+			"status           # Show the logging statistics\r\n"
+			"\r\n"
+			"Stop the log before reading it with `fat tx`.\r\n");
+
+		return;
+	}
+
+	if (match(args[1], "start"))
+	{
+		if (tlog_start(argc > 2 ? args[2] : TLOG_FILE) == 0)
+			printf("Logging to %s\r\n", argc > 2 ? args[2] : TLOG_FILE);
+	}
+	else if (match(args[1], "stop"))
+	{
+		tlog_stop();
+		tlog_status();
+	}
+	else if (match(args[1], "status"))
+	{
+		tlog_status();
+	}
+	else
+	{
+		printf("Unkown argument: %s\r\n", args[1]);
+	}
+}
+
 void flash(int argc, char **args)
 {
 
 	if (argc < 2)
 	{
-		print("Usage: flash (save|load)\r\n");
+		print("Usage: flash (save|load|status|compact)\r\n");
 
 		return;
 	}
@@ -1067,6 +1125,16 @@ void flash(int argc, char **args)
 	{
 		rotor_cal_load();
 	}
+	else if (match(args[1], "status"))
+	{
+		journal_status(&rotor_journal);
+		journal_status(&config_journal);
+	}
+	else if (match(args[1], "compact"))
+	{
+		journal_compact(&rotor_journal);
+		journal_compact(&config_journal);
+	}
 	else
 	{
 		printf("Unkown argument: %s\r\n", args[1]);
@@ -1158,8 +1226,6 @@ void cmd_prefix(int argc, char **args, struct linklist *history)
 void sat(int argc, char **args)
 {
 	FRESULT res = FR_OK;  /* API result code */
-	FIL in;              /* File object */
-	UINT br;          /* Bytes written */
 
 	tle_t tle;
 
@@ -1169,13 +1235,24 @@ void sat(int argc, char **args)
 
 	if (argc < 2)
 	{
-		 print("usage: sat (load|rx|search|list|track|demo)\r\n"
+		 print("usage: sat (load|rx|rz|search|list|track|demo)\r\n"
 			"load                  # Paste a single TLE for for tracking\r\n"
-			"rx                    # Recieve TLEs via xmodem\r\n"
+			"rx [merge]            # Recieve TLEs or OMM CSV via xmodem\r\n"
+			"rz [merge]            # Recieve TLEs or OMM CSV via zmodem (sz)\r\n"
+			"download <url> [merge] # Download TLEs or OMM CSV into tle.bin\r\n"
+			"import [<file>]       # Convert TLE text or OMM CSV (tle.txt) to tle.bin\r\n"
+			"merge [<file>]        # Merge newer and new element sets into tle.bin\r\n"
+			"map                   # Lay out tle.bin for zero-copy access and show it\r\n"
+			"check                 # Check the CRC and SGP4 constants of each record\r\n"
 			"list                  # Show all loaded satellites\r\n"
 			"search <text>         # Find satellite by name\r\n"
 			"track <satname|N>     # Track a satellite by name or number\r\n"
 			"demo [<seconds>]      # Track each satellite for N seconds\r\n"
+			"sgp4f [<days> [<min>]] # Compare single-precision SGP4 to SGP4\r\n"
+			"verify [<seconds>]    # Check SGP4/SDP4 against published vectors\r\n"
+			"passes [<n>]          # Show the next N passes from the pass table\r\n"
+			"passes status|rebuild # Show or rebuild the pass table\r\n"
+			"visible               # Show satellites that are above the horizon\r\n"
 		 );
 
 		 return;
@@ -1202,11 +1279,94 @@ void sat(int argc, char **args)
 	}
 	else if (match(args[1], "rx"))
 	{
-		print ("Begin sending your TLE text file via xmodem\r\n");
-		int br = xmodem_rx("tle.txt");
+		static catalog_t cat;
+
+		// Parsed into tle.bin as it arrives, see catalog.c
+		if (argc >= 3 && match(args[2], "merge"))
+			res = catalog_merge(&cat, "tle.bin");
+		else
+			res = catalog_begin(&cat, "tle.bin");
+
+		if (res != FR_OK)
+			return;
+
+		print ("Begin sending your TLE text or OMM CSV file via xmodem\r\n");
+		int br = xmodem_rx_cb(catalog_chunk, &cat, transfer_idle);
 
 		printf("Receved %d bytes\r\n", br);
-		sat_tle_to_bin();
+
+		// Keep the old tle.bin if the transfer was cancelled or failed
+		if (br < 0 && !cat.merge && cat.res == FR_OK)
+			cat.res = FR_INT_ERR;
+
+		catalog_end(&cat);
+	}
+	else if (match(args[1], "rz"))
+	{
+		static catalog_t cat;
+
+		if (argc >= 3 && match(args[2], "merge"))
+			res = catalog_merge(&cat, "tle.bin");
+		else
+			res = catalog_begin(&cat, "tle.bin");
+
+		if (res != FR_OK)
+			return;
+
+		print ("Begin sending your TLE text or OMM CSV file via zmodem\r\n");
+
+		// Keep the old tle.bin if the transfer was cancelled or failed
+		if (zmodem_rx_cb(catalog_chunk, &cat, transfer_idle) < 0 &&
+			!cat.merge && cat.res == FR_OK)
+			cat.res = FR_INT_ERR;
+
+		catalog_end(&cat);
+	}
+#ifndef __EFR32__
+	else if (argc >= 3 && match(args[1], "download"))
+	{
+		static catalog_t cat;
+		static http_cache_t cache;
+		int ret;
+
+#ifdef __ESP32__
+		if (!is_wifi_up())
+		{
+			printf("Wifi is not connected. Connect using `wifi connect`\r\n");
+			return;
+		}
+#endif
+
+		if (argc >= 4 && match(args[3], "merge"))
+			res = catalog_merge(&cat, "tle.bin");
+		else
+			res = catalog_begin(&cat, "tle.bin");
+
+		if (res == FR_OK)
+		{
+			// The body is parsed into tle.bin as it arrives, and a
+			// catalog that has not changed is not sent again.
+			http_cache_find(&cache, "tle.bin", args[2]);
+			ret = http_get_cb(args[2], &cache, catalog_chunk, &cat);
+
+			// Keep the old tle.bin if the download was cut short
+			if (ret < 0 && !cat.merge && cat.res == FR_OK)
+				cat.res = FR_INT_ERR;
+
+			catalog_end(&cat);
+
+			if (ret == 200 && cat.res == FR_OK)
+				http_cache_save(&cache, cat.merge);
+		}
+	}
+#endif
+	else if (match(args[1], "import"))
+	{
+		catalog_import(argc >= 3 ? args[2] : "tle.txt", "tle.bin", 0);
+	}
+	else if (match(args[1], "merge"))
+	{
+		catalog_import(argc >= 3 ? args[2] : "tle.txt", "tle.bin", 1);
 	}
 	else if (match(args[1], "tle_to_bin"))
 	{
@@ -1221,15 +1381,16 @@ void sat(int argc, char **args)
 		match(args[1], "search") ||
 		match(args[1], "track"))
 	{
-		res = f_open(&in, "tle.bin", FA_READ);
+		res = f_stat("tle.bin", NULL);
 		if (res != FR_OK)
 		{
 			printf("tle.bin: error %d: %s\r\n", res, ff_strerror(res));
-			f_close(&in);
 			return;
 		}
 		
 		const sat_t *sat;
+		const catalog_rec_t *rec;
+		catalog_rec_t rec_buf;
 		tle_t tle_tmp;
 
 		i = 1;
@@ -1245,11 +1406,19 @@ void sat(int argc, char **args)
 
 		printf("  n. [CAT #] SATELLITE                   AZI    ELE\r\n");
 		printf("===================================================\r\n");
-		do
-		{
-			res = f_read(&in, &tle_tmp, sizeof(tle_tmp), &br);
-			if (br < sizeof(tle_tmp))
-				break;
+		// Records are read in place when tle.bin is mapped, and a
+		// record already holds what sat_init() would work out.
+		while ((rec = catalog_get(i-1, &rec_buf)) != NULL)
+		{
+			// With `list above <degrees>` satellites that cannot be
+			// that high now are skipped without propagating them.
+			if (!catalog_unpack(rec, &tle_tmp) ||
+				(argc >= 4 && isfinite(degrees) &&
+				!prefilter_now(&tle_tmp, degrees)))
+			{
+				i++;
+				continue;
+			}
 
 			if (n == i ||
 				n == tle.catnr ||
@@ -1258,7 +1427,7 @@ void sat(int argc, char **args)
 				argc >= 4 || argc < 3)
 			{
 				tle = tle_tmp;
-				sat = sat_init(&tle);
+				sat = sat_init_rec(rec);
 				if (sat->sat_el > degrees)
 				{
 					printf("%3d. [%5d] %-24s %6.2f %6.2f\r\n",
@@ -1268,10 +1437,13 @@ void sat(int argc, char **args)
 				found++;
 			}
 			i++;
-		} while (res == FR_OK);
+		}
 
 		sat_reset();
 
+		if (argc >= 4 && isfinite(degrees))
+			prefilter_status();
+
 		if (match(args[1], "track"))
 		{
 			if (found == 1)
@@ -1284,30 +1456,78 @@ void sat(int argc, char **args)
 					" search and try again\r\n", found);
 		}
 	}
+	else if (match(args[1], "check"))
+	{
+		catalog_check();
+	}
+	else if (match(args[1], "map"))
+	{
+		res = catalog_layout("tle.bin");
+		if (res != FR_OK)
+			printf("tle.bin: error %d: %s\r\n", res, ff_strerror(res));
+
+		catalog_map_status();
+	}
+	else if (match(args[1], "sgp4f"))
+	{
+		double days = 7, step = 1;
+
+		if (argc >= 3)
+			days = atof(args[2]);
+		if (argc >= 4)
+			step = atof(args[3]);
+
+		sgp4f_check(days, step);
+	}
+	else if (match(args[1], "passes"))
+	{
+		if (argc >= 3 && match(args[2], "status"))
+			pass_status();
+		else if (argc >= 3 && match(args[2], "rebuild"))
+			pass_invalidate();
+		else
+			pass_print(argc >= 3 ? atoi(args[2]) : 10, 0);
+	}
+	else if (match(args[1], "visible"))
+	{
+		pass_print(PASS_MAX, 1);
+	}
+	else if (match(args[1], "verify"))
+	{
+		float sec = 1;
+
+		if (argc >= 3)
+			sec = atof(args[2]);
+		if (sec <= 0)
+			sec = 1;
+
+		sgp4_verify(sec);
+	}
 	else if (match(args[1], "demo"))
 	{
-		res = f_open(&in, "tle.bin", FA_READ);
+		res = f_stat("tle.bin", NULL);
 		if (res != FR_OK)
 		{
 			printf("tle.bin: error %d: %s\r\n", res, ff_strerror(res));
-			f_close(&in);
 			return;
 		}
 
-		tle_t tle_tmp;
+		const catalog_rec_t *rec;
+		catalog_rec_t rec_buf;
 		i = 1;
 		int n = 3, c = -1;
 		if (argc >= 3)
 			n = atoi(args[2]);
 
-		do
+		while (c == -1 && (rec = catalog_get(i-1, &rec_buf)) != NULL)
 		{
-			res = f_read(&in, &tle_tmp, sizeof(tle_tmp), &br);
-			if (br < sizeof(tle_tmp))
-				break;
+			if (!catalog_unpack(rec, &tle))
+			{
+				i++;
+				continue;
+			}
 
-			memcpy(&tle, &tle_tmp, sizeof(tle_t));
-			sat_init(&tle);
+			sat_init_rec(rec);
 			for (int t = 0; t < n && c == -1; t++)
 			{
 				c = serial_read_char();
@@ -1318,7 +1538,7 @@ void sat(int argc, char **args)
 			}
 			printf("%d. %s (%d)\r\n", i, tle.sat_name, tle.catnr);
 			i++;
-		} while (res == FR_OK && c == -1);
+		}
 	}
 	else
 		print("Sat: invalid argument\r\n");
@@ -1327,6 +1547,7 @@ void sat(int argc, char **args)
 void fat(int argc, char **args)
 {
 	FIL fil;              /* File object */
+	f_stream_t stream;
 	FRESULT res = FR_OK;  /* API result code */
 	UINT br, bw;          /* Bytes written */
 	BYTE work[FF_MAX_SS]; /* Work area (larger is better for processing time) */
@@ -1340,6 +1561,9 @@ void fat(int argc, char **args)
 
 	char buf[128];
 
+	// The volume or any file on it may change under the mapping
+	catalog_unmap();
+
 	if (argc >= 2 && match(args[1], "mkfs"))
 	{
 		res = f_mkfs("", &mkfs, work, sizeof work);
@@ -1361,15 +1585,16 @@ void fat(int argc, char **args)
 	else if (argc >= 3 && match(args[1], "load"))
 	{
 		printf("Paste data into %s and press CTRL+D when done\r\n", args[2]);
-		res = f_open(&fil, args[2], FA_CREATE_ALWAYS | FA_WRITE);
-		
-		while (res == FR_OK && serial_read_line(buf, 80))
+		res = f_stream_open(&stream, args[2], FA_CREATE_ALWAYS | FA_WRITE, work, sizeof(work));
+		if (res == FR_OK)
 		{
-			res = f_write(&fil, buf, strlen(buf), &bw);
-		}
+			while (res == FR_OK && serial_read_line(buf, 80))
+			{
+				res = f_stream_puts(&stream, buf);
+			}
 
-		if (res != FR_OK)
-			res = f_close(&fil);
+			res = f_stream_close(&stream);
+		}
 	}
 	else if (argc >= 3 && match(args[1], "cat"))
 	{
@@ -1387,23 +1612,48 @@ void fat(int argc, char **args)
 	}
 	else if (argc >= 3 && match(args[1], "rx"))
 	{
-		br = xmodem_rx(args[2]);
+		br = xmodem_rx(args[2], transfer_idle);
 
 		printf("Receved %d bytes\r\n", br);
 	}
+	else if (argc >= 2 && match(args[1], "rz"))
+	{
+		zmodem_rx(argc >= 3 ? args[2] : NULL, transfer_idle);
+	}
 	else if (argc >= 3 && match(args[1], "tx"))
 	{
-		bw = xmodem_tx(args[2]);
+		bw = xmodem_tx(args[2], transfer_idle);
 
 		printf("sent %d bytes\r\n", bw);
 	}
+#ifndef __EFR32__
 	else if (argc >= 4 && match(args[1], "http_get"))
 	{
+#ifdef __ESP32__
 		if (!is_wifi_up())
+		{
 			printf("Wifi is not connected. Connect using `wifi connect`\r\n");
+			return;
+		}
+#endif
+		http_get(args[2], args[3]);
+	}
+#endif
+#ifdef USE_FTL
+	else if (argc >= 2 && match(args[1], "ftl"))
+	{
+		ftl_status();
+	}
+#endif
+#if !defined(__EFR32__) && !defined(__ESP32__)
+	else if (argc >= 2 && match(args[1], "nor"))
+	{
+		if (argc >= 3 && match(args[2], "reset"))
+			nor_sim_reset();
 		else
-			http_get(args[2], args[3]);
+			nor_sim_status();
 	}
+#endif
 	else if (argc >= 3 && match(args[1], "vi"))
 	{
 		vi(args[2]);
@@ -1412,9 +1662,20 @@ void fat(int argc, char **args)
 	{
 		run_script(args[2]);
 	}
+	else if (argc >= 2 && match(args[1], "bench"))
+	{
+		res = f_bench(argc >= 3 ? args[2] : "tle.txt", argc >= 4 ? atoi(args[3]) : 4096);
+	}
 	else
 	{
-		printf("Usage: fat (mkfs|mount|rx <file>|cat <file>|load <file>|find|umount|http_get <file> <url>|vi <file>|run <file>\r\n");
+		printf("Usage: fat (mkfs|mount|rx <file>|rz [<file>]|cat <file>|load <file>|find|umount|http_get <file> <url>|vi <file>|run <file>|bench [<file> [<bufsize>]]"
+#ifdef USE_FTL
+			"|ftl"
+#endif
+#if !defined(__EFR32__) && !defined(__ESP32__)
+			"|nor [reset]"
+#endif
+			")\r\n");
 
 		return;
 	}
@@ -1423,6 +1684,33 @@ void fat(int argc, char **args)
 		printf("error %d: %s\r\n", res, ff_strerror(res));
 }
 
+struct astro_list_arg
+{
+	// Index printed for the first star
+	int first_idx;
+
+	// Set to the key pressed by the user to stop listing
+	int c;
+};
+
+static void astro_list_star(int i, double az, double alt, void *arg)
+{
+	struct astro_list_arg *list = arg;
+
+	if (list->c == -1)
+		list->c = serial_read_char();
+
+	if (list->c != -1)
+		return;
+
+	printf("%3d. %-37s %8.2lf %8.2lf %8.2lf %8.2lf %8.2lf\r\n",
+	       list->first_idx + i, star_name(i),
+	       star_ra(i),
+	       star_dec(i),
+	       az, alt,
+	       star_mag(i));
+}
+
 void astro(int argc, char **args)
 {
 	static const astro_body_t body[] = {
@@ -1454,14 +1742,107 @@ void astro(int argc, char **args)
 			"list [above <deg>]    # Show all celestial bodies\r\n"
 			"search <text>         # Find celestial body by name\r\n"
 			"track <body|N>        # Track a body by name or number\r\n"
+			"near [<az> <el>] <r>  # Show stars within r degrees of az/el or the rotors\r\n"
+			"cache [check [hours]] # Show the tracking cache or compare it to direct calculation\r\n"
 		);
 
 	else if (match(args[1], "reset"))
 	{
 		astro_tracked_name = NULL;
 		astro_tracked_body = BODY_INVALID;
+		astro_cache_reset(&astro_tracked_cache);
 	}
 
+	else if (match(args[1], "near") && (argc == 3 || argc == 5))
+	{
+		struct astro_list_arg list = { .first_idx = num_bodies + 1, .c = -1 };
+		double az, el, radius;
+
+		if (argc == 5)
+		{
+			az = atof(args[2]);
+			el = atof(args[3]);
+			radius = atof(args[4]);
+		}
+		else
+		{
+			az = rotor_pos(&rotors[az_rotor_idx]);
+			el = rotor_pos(&rotors[el_rotor_idx]);
+			radius = atof(args[2]);
+		}
+
+		printf("Stars within %.1f degrees of az=%.2f el=%.2f:\r\n", radius, az, el);
+		printf("  n. BODY                                        RA      DEC       AZ      ALT      MAG\r\n");
+		stars_near(&time, observer, az, el, radius, astro_list_star, &list);
+	}
+
+	else if (match(args[1], "cache") && argc >= 3 && match(args[2], "check"))
+	{
+		astro_cache_t cache;
+		astro_time_t t;
+		astro_equatorial_t equ;
+		double hours = 24, az, alt, d_az, d_alt, max_az = 0, max_alt = 0;
+		float direct_sec, cached_sec;
+		uint64_t start;
+		int samples, n;
+
+		if (argc >= 4)
+			hours = atof(args[3]);
+
+		// One sample per minute
+		samples = hours * 60;
+
+		for (i = 0; i < num_bodies; i++)
+		{
+			astro_cache_reset(&cache);
+
+			start = rtcc_get();
+			for (n = 0; n < samples; n++)
+			{
+				t = Astronomy_AddDays(time, n / 1440.0);
+				equ = Astronomy_Equator(body[i], &t, observer, EQUATOR_OF_DATE, ABERRATION);
+				hor = Astronomy_Horizon(&t, observer, equ.ra, equ.dec, REFRACTION_NORMAL);
+			}
+			direct_sec = rtcc_elapsed_sec(start);
+
+			start = rtcc_get();
+			for (n = 0; n < samples; n++)
+			{
+				t = Astronomy_AddDays(time, n / 1440.0);
+				astro_cache_horizon(&cache, body[i], observer, &t, &az, &alt);
+			}
+			cached_sec = rtcc_elapsed_sec(start);
+
+			for (n = 0; n < samples; n++)
+			{
+				t = Astronomy_AddDays(time, n / 1440.0);
+				equ = Astronomy_Equator(body[i], &t, observer, EQUATOR_OF_DATE, ABERRATION);
+				hor = Astronomy_Horizon(&t, observer, equ.ra, equ.dec, REFRACTION_NORMAL);
+				if (astro_cache_horizon(&cache, body[i], observer, &t, &az, &alt) != ASTRO_SUCCESS)
+					break;
+
+				// Azimuth error is measured on the sky, not along the horizon.
+				d_az = fabs(remainder(az - hor.azimuth, 360)) * cos(Radians(hor.altitude));
+				d_alt = fabs(alt - hor.altitude);
+
+				if (d_az > max_az)
+					max_az = d_az;
+				if (d_alt > max_alt)
+					max_alt = d_alt;
+			}
+
+			printf("%-10s max error az=%8.3f alt=%8.3f arcsec, %u fits, direct %.2fs, cached %.2fs\r\n",
+				Astronomy_BodyName(body[i]),
+				max_az * 3600, max_alt * 3600,
+				cache.fits, direct_sec, cached_sec);
+
+			max_az = max_alt = 0;
+		}
+	}
+
+	else if (match(args[1], "cache"))
+		astro_cache_status(&astro_tracked_cache);
+
 	else if (match(args[1], "list") ||
 		match(args[1], "search") ||
 		match(args[1], "track"))
@@ -1472,6 +1853,9 @@ void astro(int argc, char **args)
 
 		int c = -1;
 
+		// `astro list [above <deg>]` shows every star, so do them in one batch
+		int batch = match(args[1], "list") && argc != 3;
+
 		if (argc == 3)
 			n = atoi(args[2]);
 		else if (argc >= 4 && match(args[2], "above"))
@@ -1519,27 +1903,35 @@ void astro(int argc, char **args)
 				       hor.azimuth, hor.altitude, imag.mag);
 		}
 
-		for (i = 0; i < NUM_STARS && c == -1; i++)
+		// Listing all stars is done as one batch that shares the
+		// precession, nutation and observer rotation.
+		if (batch && c == -1)
+		{
+			struct astro_list_arg list = { .first_idx = idx + 1, .c = -1 };
+
+			stars_horizon(&time, observer, degrees, astro_list_star, &list);
+		}
+
+		for (i = 0; i < NUM_STARS && c == -1 && !batch; i++)
 		{
 			c = serial_read_char();
 			idx++;
 
 			if (n != idx
 				&& argc == 3
-				&& !strcasestr(stars[i].name, args[2]))
+				&& !strcasestr(star_name(i), args[2]))
 				continue;
 
 			found++;
 			found_star_idx = i;
 
-			Astronomy_DefineStar(BODY_STAR8,
-				stars[i].ra, stars[i].dec, stars[i].dist_ly);
+			star_define(BODY_STAR8, i);
 
 			equ_ofdate = Astronomy_Equator(BODY_STAR8, &time, observer, EQUATOR_OF_DATE, ABERRATION);
 			if (equ_ofdate.status != ASTRO_SUCCESS)
 			{
 				printf("%s: Astronomy_Equator returned status %d trying to get coordinates of date.\r\n",
-					stars[i].name,
+					star_name(i),
 					equ_ofdate.status);
 			}
 
@@ -1551,17 +1943,19 @@ void astro(int argc, char **args)
 
 			if (hor.altitude > degrees)
 				printf("%3d. %-37s %8.2lf %8.2lf %8.2lf %8.2lf %8.2lf\r\n",
-				       idx, stars[i].name,
-				       stars[i].ra, //equ_ofdate.ra,
-				       stars[i].dec,// equ_ofdate.dec,
+				       idx, star_name(i),
+				       star_ra(i), //equ_ofdate.ra,
+				       star_dec(i),// equ_ofdate.dec,
 				       hor.azimuth, hor.altitude,
-				       stars[i].mag_vis);
+				       star_mag(i));
 		}
 
 		if (match(args[1], "track"))
 		{
 			if (found == 1)
 			{
+				astro_cache_reset(&astro_tracked_cache);
+
 				if (found_planet_idx >= 0)
 				{
 					astro_tracked_name = (char*)Astronomy_BodyName(body[found_planet_idx]);
@@ -1571,9 +1965,8 @@ void astro(int argc, char **args)
 
 				if (found_star_idx >= 0)
 				{
-					Astronomy_DefineStar(BODY_STAR1,
-						stars[found_star_idx].ra, stars[found_star_idx].dec, stars[found_star_idx].dist_ly);
-					astro_tracked_name = stars[found_star_idx].name;
+					star_define(BODY_STAR1, found_star_idx);
+					astro_tracked_name = (char*)star_name(found_star_idx);
 					astro_tracked_body = BODY_STAR1;
 				}
 
@@ -1816,6 +2209,11 @@ void dispatch(int argc, char **args, struct linklist *history)
 		flash(argc, args);
 	}
 
+	else if (match(args[0], "tlog"))
+	{
+		tlog(argc, args);
+	}
+
 	else if (match(args[0], "fat"))
 		fat(argc, args);
 
@@ -1849,6 +2247,7 @@ void dispatch(int argc, char **args, struct linklist *history)
 				"gnsstime        <1|0>  # Update time from GNSS\r\n"
 				"gnsspos         <1|0>  # Update position from GNSS\r\n"
 				"startscript     <file> # `fat run <file>` at startup\r\n"
+				"satinterp       <1|0>  # Interpolate satellite ephemeris between propagations\r\n"
 
 				"\r\n"
 				"Current Settings\r\n"
@@ -1891,12 +2290,16 @@ void dispatch(int argc, char **args, struct linklist *history)
 			config.gnss_pos = atoi(args[2]);
 		else if (match(args[1], "startscript"))
 			strncpy(config.startscript, args[2], sizeof(config.startscript)-1);
+		else if (match(args[1], "satinterp"))
+			config.sat_interp = atoi(args[2]);
 		else
 		{
 			printf("invalid setting: %s\r\n", args[1]);
 			return;
 		}
 
+		sat_observer_invalidate();
+
 		config_save();
 	}
 
@@ -2206,18 +2609,20 @@ void dispatch(int argc, char **args, struct linklist *history)
 
 int tracking_update()
 {
-	static int az_rotor_idx = 0;
-	static int el_rotor_idx = 1;
 	const sat_t *sat = NULL;
 
 	idle_counts++;
+
+	sat_lock();
 	sat = sat_update();
+	sat_unlock();
 
 	// Set the rotor target for az/el if a satellite is being tracked.
 	if (sat != NULL)
 	{
 		rotors[az_rotor_idx].target = sat->sat_az;
 		rotors[el_rotor_idx].target = sat->sat_el;
+		jitter_mark(&tracking_jitter, TRACKING_MS * 1000);
 
 		return 1;
 	}
@@ -2225,8 +2630,8 @@ int tracking_update()
 	{
 		astro_observer_t observer;
 		astro_time_t time;
-		astro_equatorial_t equ_ofdate;
-		astro_horizon_t hor;
+		astro_status_t astro_status;
+		double az, alt;
 
 		time = Astronomy_CurrentTime();
 
@@ -2234,12 +2639,15 @@ int tracking_update()
 		observer.longitude = Degrees(config.observer.lon);
 		observer.height = config.observer.alt * 1000;	// km to m
 
-		equ_ofdate = Astronomy_Equator(astro_tracked_body, &time, observer, EQUATOR_OF_DATE, ABERRATION);
-		if (equ_ofdate.status != ASTRO_SUCCESS)
+		// The cache refits with Astronomy_Equator() every few hours
+		// and interpolates in between.
+		astro_status = astro_cache_horizon(&astro_tracked_cache,
+			astro_tracked_body, observer, &time, &az, &alt);
+		if (astro_status != ASTRO_SUCCESS)
 		{
 			printf("%s: Astronomy_Equator returned status %d trying to get coordinates of date.\r\n",
 				astro_tracked_name,
-				equ_ofdate.status);
+				astro_status);
 
 			astro_tracked_body = BODY_INVALID;
 			astro_tracked_name = NULL;
@@ -2247,11 +2655,9 @@ int tracking_update()
 			return 0;
 		}
 
-		hor = Astronomy_Horizon(&time, observer, equ_ofdate.ra,
-					equ_ofdate.dec, REFRACTION_NORMAL);
-
-		rotors[az_rotor_idx].target = hor.azimuth;
-		rotors[el_rotor_idx].target = hor.altitude;
+		rotors[az_rotor_idx].target = az;
+		rotors[el_rotor_idx].target = alt;
+		jitter_mark(&tracking_jitter, TRACKING_MS * 1000);
 
 		return 1;
 	}
@@ -2274,34 +2680,20 @@ void run(const char *format, ...)
 
 void run_script(const char *filename)
 {
-	FIL file;		// File object
-	FRESULT res;		// Result code
-	char line[256];		// Buffer to store each line
-	UINT br;		// Bytes read
+	f_stream_t in;
+	char buf[512];
+	char *line;
 
-	// Open the file in read mode
-	res = f_open(&file, filename, FA_READ);
-	if (res != FR_OK)
-	{
-		printf("Error opening file %s: %d\n", filename, res);
+	if (f_stream_open(&in, filename, FA_READ, buf, sizeof(buf)) != FR_OK)
 		return;
-	}
 
-	// Read each line from the file
-	while (f_gets(line, sizeof(line), &file))
+	while ((line = f_stream_gets(&in, NULL)) != NULL)
 	{
-		// Remove trailing newline character if present
-		char *newline = strchr(line, '\n');
-
-		if (newline)
-			*newline = '\0';
-
 		printf("+ %s\r\n", line);
 		run("%s", line);
 	}
 
-	// Close the file
-	f_close(&file);
+	f_stream_close(&in);
 }
 
 
@@ -2309,7 +2701,7 @@ void run_script(const char *filename)
 #ifdef __ESP32__
 void tracking_update_thread()
 {
-	TickType_t interval = 10/portTICK_PERIOD_MS;
+	TickType_t interval = TRACKING_MS/portTICK_PERIOD_MS;
 	TickType_t now = xTaskGetTickCount();
 	while (1)
 	{
@@ -2321,6 +2713,9 @@ void tracking_update_thread()
 
 void main_idle()
 {
+	pass_step();
+	tlog_step();
+
 #ifdef __EFR32__
 	// EFR32 dosen't support threads, so this is called while waiting at a
 	// terminal prompt
@@ -2331,6 +2726,21 @@ void main_idle()
 #endif
 }
 
+// Called while a file transfer waits for serial data.  pid_update() keeps
+// running from its timer or task, and this keeps the rotor targets
+// updated on the EFR32, where tracking has no thread of its own.
+// pass_step() is left out because `sat rz merge` rewrites tle.bin.
+void transfer_idle()
+{
+#ifdef __EFR32__
+	tracking_update();
+#elif defined(__ESP32__)
+	// Let the tracking thread run, it has the same priority during
+	// transfers.
+	taskYIELD();
+#endif
+}
+
 #ifdef __ESP32__
 int app_main()
 #else
@@ -2395,6 +2805,13 @@ int main()
 	// Load user config
 	config_load();
 
+	// Locks shared with the tracking and LCD tasks
+	sat_lock_init();
+	catalog_map_init();
+
+	// Load the pass table, it is updated in the background by main_idle()
+	pass_init();
+
 #ifdef HAVE_IADC
 	initIADC();
 #endif
@@ -0,0 +1,385 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+
+// Emulated NOR flash for the Linux build:
+//
+// The device is an array of FLASH_PAGE_SIZE pages that behaves like the
+// EFR32 flash.  Erasing sets a whole page to 0xFF and programming writes
+// aligned 32-bit words and can only clear bits.  Each operation adds the
+// modeled EFR32 erase or program time to busy_us, and every page has an
+// erase counter, so `fat nor` shows what a FAT operation costs in time
+// and wear on the device.
+//
+// The image is kept in memory and written through to a backing file with
+// the erase counters at its end, so the volume and its wear survive
+// restarts.  These environment variables change the defaults:
+//
+//   SPACEHAM_FLASH        Backing file, or empty to keep it in memory only
+//   SPACEHAM_FLASH_KB     Size in kB, rounded down to whole pages
+//   SPACEHAM_FLASH_DELAY  If set, sleep for the modeled time of each operation
+
+#ifndef __EFR32__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "nor-sim.h"
+
+nor_sim_stats_t nor_sim_stats;
+
+static struct {
+	unsigned char *mem;
+	uint32_t pages;
+
+	// Erase count of each page over the life of the image, and at the
+	// last reset
+	uint32_t *erases, *erases_reset;
+
+	// Backing file or -1
+	int fd;
+
+	int delay;
+} nor = {.fd = -1};
+
+static void nor_sim_busy(uint64_t us)
+{
+	nor_sim_stats.busy_us += us;
+
+	if (nor.delay)
+		usleep(us);
+}
+
+static void nor_sim_sync(uint32_t addr, uint32_t len)
+{
+	if (nor.fd < 0)
+		return;
+
+	if (pwrite(nor.fd, nor.mem + addr, len, addr) != len)
+		perror("nor_sim: write");
+}
+
+static void nor_sim_sync_erases(uint32_t page)
+{
+	off_t pos = (off_t)nor.pages * FLASH_PAGE_SIZE + page * sizeof(uint32_t);
+
+	if (nor.fd < 0)
+		return;
+
+	if (pwrite(nor.fd, &nor.erases[page], sizeof(uint32_t), pos) != sizeof(uint32_t))
+		perror("nor_sim: write");
+}
+
+// Open the device with the given number of pages, backed by path or in
+// memory only if path is NULL or empty.  An existing image is used if its
+// size matches, otherwise a new erased image is created.
+int nor_sim_open(const char *path, uint32_t pages)
+{
+	size_t size = (size_t)pages * FLASH_PAGE_SIZE;
+	size_t erases_size = pages * sizeof(uint32_t);
+	struct stat st = {0};
+
+	nor_sim_close();
+
+	if (pages == 0)
+		return -1;
+
+	nor.mem = malloc(size);
+	nor.erases = calloc(pages, sizeof(uint32_t));
+	nor.erases_reset = calloc(pages, sizeof(uint32_t));
+	if (nor.mem == NULL || nor.erases == NULL || nor.erases_reset == NULL)
+	{
+		printf("nor_sim: out of memory for %lu pages\r\n", (unsigned long)pages);
+		nor_sim_close();
+		return -1;
+	}
+
+	memset(nor.mem, 0xFF, size);
+	nor.pages = pages;
+
+	if (path != NULL && *path)
+	{
+		nor.fd = open(path, O_RDWR | O_CREAT, 0644);
+		if (nor.fd < 0)
+		{
+			perror(path);
+			nor_sim_close();
+			return -1;
+		}
+
+		if (fstat(nor.fd, &st) == 0 && st.st_size == size + erases_size &&
+			pread(nor.fd, nor.mem, size, 0) == size &&
+			pread(nor.fd, nor.erases, erases_size, size) == erases_size)
+		{
+			printf("nor_sim: %s: %lu pages\r\n", path, (unsigned long)pages);
+		}
+		else
+		{
+			if (st.st_size)
+				printf("nor_sim: %s: size does not match %lu pages, erasing it\r\n",
+					path, (unsigned long)pages);
+
+			memset(nor.mem, 0xFF, size);
+			memset(nor.erases, 0, erases_size);
+
+			if (ftruncate(nor.fd, 0) < 0 ||
+				pwrite(nor.fd, nor.mem, size, 0) != size ||
+				pwrite(nor.fd, nor.erases, erases_size, size) != erases_size)
+			{
+				perror(path);
+				nor_sim_close();
+				return -1;
+			}
+		}
+	}
+
+	nor_sim_reset();
+
+	return 0;
+}
+
+// Open the device from the environment if it is not open yet
+int nor_sim_init()
+{
+	const char *path = getenv("SPACEHAM_FLASH");
+	const char *kb = getenv("SPACEHAM_FLASH_KB");
+	uint32_t size = NOR_SIM_SIZE;
+
+	if (nor.mem != NULL)
+		return 0;
+
+	if (path == NULL)
+		path = NOR_SIM_FILE;
+
+	if (kb != NULL)
+		size = strtoul(kb, NULL, 10) * 1024;
+
+	nor.delay = getenv("SPACEHAM_FLASH_DELAY") != NULL;
+
+	return nor_sim_open(path, size / FLASH_PAGE_SIZE);
+}
+
+void nor_sim_close()
+{
+	if (nor.fd >= 0)
+		close(nor.fd);
+
+	free(nor.mem);
+	free(nor.erases);
+	free(nor.erases_reset);
+
+	nor.mem = NULL;
+	nor.erases = nor.erases_reset = NULL;
+	nor.pages = 0;
+	nor.fd = -1;
+}
+
+uint32_t nor_sim_pages()
+{
+	return nor.pages;
+}
+
+static int nor_sim_range(const char *op, uint32_t addr, uint32_t len)
+{
+	if (nor.mem == NULL || addr + (uint64_t)len > (uint64_t)nor.pages * FLASH_PAGE_SIZE)
+	{
+		printf("nor_sim_%s: out of range: addr=0x%lx len=%lu\r\n", op,
+			(unsigned long)addr, (unsigned long)len);
+		return -1;
+	}
+
+	return 0;
+}
+
+// The flash is memory mapped on the EFR32, so reads cost no modeled time
+int nor_sim_read(uint32_t addr, void *buf, uint32_t len)
+{
+	if (nor_sim_range("read", addr, len))
+		return -1;
+
+	memcpy(buf, nor.mem + addr, len);
+
+	nor_sim_stats.reads++;
+	nor_sim_stats.read_bytes += len;
+
+	return 0;
+}
+
+// Like MSC_WriteWord(), addr and len must be multiples of 4
+int nor_sim_program(uint32_t addr, const void *buf, uint32_t len)
+{
+	uint32_t *p, w, i;
+	const unsigned char *b = buf;
+
+	if (nor_sim_range("program", addr, len))
+		return -1;
+
+	if ((addr | len) & 3)
+	{
+		printf("nor_sim_program: unaligned: addr=0x%lx len=%lu\r\n",
+			(unsigned long)addr, (unsigned long)len);
+		return -1;
+	}
+
+	p = (uint32_t *)(nor.mem + addr);
+	for (i = 0; i < len / 4; i++)
+	{
+		memcpy(&w, b + i*4, 4);
+
+		if (p[i] != 0xFFFFFFFF && (p[i] & w) != p[i])
+			nor_sim_stats.reprograms++;
+
+		p[i] &= w;
+	}
+
+	nor_sim_stats.programs++;
+	nor_sim_stats.program_bytes += len;
+	nor_sim_busy((uint64_t)len / 4 * NOR_SIM_WORD_US);
+
+	nor_sim_sync(addr, len);
+
+	return 0;
+}
+
+int nor_sim_erase(uint32_t page)
+{
+	if (nor_sim_range("erase", page * FLASH_PAGE_SIZE, FLASH_PAGE_SIZE))
+		return -1;
+
+	memset(nor.mem + page * FLASH_PAGE_SIZE, 0xFF, FLASH_PAGE_SIZE);
+	nor.erases[page]++;
+
+	nor_sim_stats.erases++;
+	nor_sim_busy(NOR_SIM_ERASE_US);
+
+	nor_sim_sync(page * FLASH_PAGE_SIZE, FLASH_PAGE_SIZE);
+	nor_sim_sync_erases(page);
+
+	return 0;
+}
+
+// Address of the image in memory, like the memory-mapped EFR32 flash
+const void *nor_sim_map(uint32_t addr, uint32_t len)
+{
+	if (nor_sim_range("map", addr, len))
+		return NULL;
+
+	return nor.mem + addr;
+}
+
+// Account the modeled time of one disk write, taken from busy_us before
+// and after it
+void nor_sim_latency(uint64_t us)
+{
+	nor_sim_stats.writes++;
+	nor_sim_stats.write_us += us;
+
+	if (us > nor_sim_stats.write_us_max)
+		nor_sim_stats.write_us_max = us;
+
+	if (us < 1000)
+		nor_sim_stats.write_hist[0]++;
+	else if (us < 10000)
+		nor_sim_stats.write_hist[1]++;
+	else if (us < 100000)
+		nor_sim_stats.write_hist[2]++;
+	else
+		nor_sim_stats.write_hist[3]++;
+}
+
+// Clear the counters, so `fat nor` after an operation shows its cost
+void nor_sim_reset()
+{
+	memset(&nor_sim_stats, 0, sizeof(nor_sim_stats));
+
+	if (nor.erases != NULL)
+		memcpy(nor.erases_reset, nor.erases, nor.pages * sizeof(uint32_t));
+}
+
+void nor_sim_status()
+{
+	uint32_t i, min = UINT32_MAX, max = 0, hot = 0, hot_page = 0, touched = 0;
+	uint64_t total = 0;
+
+	if (nor.mem == NULL)
+	{
+		printf("nor_sim: not open\r\n");
+		return;
+	}
+
+	for (i = 0; i < nor.pages; i++)
+	{
+		if (nor.erases[i] < min)
+			min = nor.erases[i];
+		if (nor.erases[i] > max)
+			max = nor.erases[i];
+		total += nor.erases[i];
+
+		if (nor.erases[i] != nor.erases_reset[i])
+			touched++;
+
+		if (nor.erases[i] - nor.erases_reset[i] > hot)
+		{
+			hot = nor.erases[i] - nor.erases_reset[i];
+			hot_page = i;
+		}
+	}
+
+	printf("nor: %lu pages of %d bytes%s%s\r\n"
+		"reads:          %llu (%llu bytes)\r\n"
+		"programs:       %llu (%llu bytes)\r\n"
+		"erases:         %llu on %lu pages, page %lu erased most (%lu)\r\n"
+		"reprograms:     %llu\r\n"
+		"busy:           %llu.%03llu s\r\n",
+		(unsigned long)nor.pages, FLASH_PAGE_SIZE,
+		nor.fd < 0 ? ", in memory" : "",
+		nor.delay ? ", delayed" : "",
+		(unsigned long long)nor_sim_stats.reads,
+		(unsigned long long)nor_sim_stats.read_bytes,
+		(unsigned long long)nor_sim_stats.programs,
+		(unsigned long long)nor_sim_stats.program_bytes,
+		(unsigned long long)nor_sim_stats.erases,
+		(unsigned long)touched, (unsigned long)hot_page, (unsigned long)hot,
+		(unsigned long long)nor_sim_stats.reprograms,
+		(unsigned long long)nor_sim_stats.busy_us / 1000000,
+		(unsigned long long)nor_sim_stats.busy_us / 1000 % 1000);
+
+	if (nor_sim_stats.writes)
+		printf("disk writes:    %llu, avg %llu us, max %llu us\r\n"
+			"                <1ms %lu, <10ms %lu, <100ms %lu, >=100ms %lu\r\n",
+			(unsigned long long)nor_sim_stats.writes,
+			(unsigned long long)(nor_sim_stats.write_us / nor_sim_stats.writes),
+			(unsigned long long)nor_sim_stats.write_us_max,
+			(unsigned long)nor_sim_stats.write_hist[0],
+			(unsigned long)nor_sim_stats.write_hist[1],
+			(unsigned long)nor_sim_stats.write_hist[2],
+			(unsigned long)nor_sim_stats.write_hist[3]);
+
+	printf("wear:           min %lu, avg %llu, max %lu erases (%.2f%% of %d)\r\n",
+		(unsigned long)min, (unsigned long long)(total / nor.pages),
+		(unsigned long)max, 100.0 * max / NOR_SIM_ENDURANCE, NOR_SIM_ENDURANCE);
+}
+
+#endif
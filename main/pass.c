@@ -0,0 +1,780 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+
+// Pass table:
+//
+// AOS, LOS and maximum elevation of every pass over config.observer in
+// the next PASS_WINDOW seconds, sorted by AOS and saved to pass.bin so
+// "what's up" queries and the LCD menu are table lookups instead of
+// propagating the whole catalog.
+//
+// pass_step() is called from main_idle() and does at most PASS_CHUNK
+// propagations each time, so the table is built in the background while
+// the console waits for input.  As the clock moves forward expired
+// passes are dropped and the window is extended by scanning only the new
+// slice of time.  The whole table is rebuilt when tle.bin or the
+// observer changes.
+//
+// Near-earth satellites are propagated with sgp4f(), which keeps its
+// state in sgp4f_t.  SDP4, the ephemeris flags and Calculate_Obs()'s
+// VISIBLE_FLAG are globals shared with the tracked satellite, so each
+// pass_scan() holds sat_lock() and ends with sat_reselect().
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "platform.h"
+#include "sgp4sdp4.h"
+#include "sgp4f.h"
+
+#include "sat.h"
+#include "pass.h"
+#include "prefilter.h"
+#include "catalog.h"
+#include "config.h"
+#include "rtcc.h"
+#include "serial.h"
+
+#include "ff.h"
+#include "fatfs-util.h"
+
+#define PASS_MAGIC      0x53534150	// "PASS"
+#define PASS_VERSION    2
+
+// Length of the window and how far it may fall short before the next
+// slice is scanned (seconds)
+#define PASS_WINDOW     (24*3600)
+#define PASS_EXTEND     3600
+
+// Seconds between checks for expired passes and tle.bin changes
+#define PASS_CHECK      60
+
+// Sample interval while searching for passes (seconds).  Passes shorter
+// than PASS_STEP_NEAR can be missed; those only graze the horizon.
+#define PASS_STEP_NEAR  60
+#define PASS_STEP_DEEP  600
+
+// Propagations per call to pass_step()
+#define PASS_CHUNK      32
+
+// AOS and LOS are refined by bisection to this many seconds
+#define PASS_RESOLUTION 1
+
+// Rebuild when the observer moves more than this (radians, about 5 km)
+#define PASS_OBS_MOVED  8E-4
+
+// The clock has not been set if it is before 2020
+#define PASS_MIN_TIME   1577836800
+
+#define PASS_JD_UNIX_EPOCH 2440587.5
+
+static pass_hdr_t hdr;
+static pass_t passes[PASS_MAX];
+
+static struct {
+	// True while a slice is being scanned
+	int active;
+
+	// Slice of time being scanned (unix time)
+	uint32_t start, end;
+
+	// Satellite being scanned, its converted TLE and propagator
+	int idx, loaded, deep;
+
+	// Only every parts'th satellite starting at part is scanned.  This is
+	// 0 and 1 except in the host tool, which splits the catalog between
+	// processes.
+	int part, parts;
+	tle_t tle;
+	sgp4f_t sgp;
+
+	// Record read from tle.bin when it is not mapped
+	catalog_rec_t rec;
+
+	// Visibility prefilter from the raw TLE, never is true if the
+	// satellite cannot rise for the observer
+	prefilter_t pf;
+	int never;
+	double jul_epoch;
+	geodetic_t obs;
+
+	// Next sample time, sample interval and whether the satellite was
+	// above the horizon at the previous sample
+	uint32_t t;
+	int step, up;
+
+	// Pass in progress or NULL if it was not recorded
+	pass_t *cur;
+
+	// Time and ECI position (km) of the last pass_elevation()
+	double jul;
+	vector_t pos;
+
+	// Last two elevation samples of the pass in progress and the time
+	// of the older one
+	double el[2];
+	uint32_t el_t, el_t1;
+	int n_el;
+
+	// passes[0..sorted-1] are in AOS order and can be queried while a
+	// slice is scanned.  New passes are appended after them.
+	int sorted;
+
+	// True if the table filled up and later passes were left out
+	int dropped;
+
+	uint32_t last_check;
+
+	// Counters for pass_status()
+	unsigned int sats, propagations, builds, extends;
+} job;
+
+static uint32_t pass_now()
+{
+	return rtcc_get_sec();
+}
+
+static int pass_cmp(const void *a, const void *b)
+{
+	const pass_t *pa = a, *pb = b;
+
+	if (pa->aos != pb->aos)
+		return pa->aos < pb->aos ? -1 : 1;
+
+	return (int)pa->idx - (int)pb->idx;
+}
+
+static void pass_save()
+{
+	FRESULT res;
+	FIL out;
+	UINT bw;
+
+	res = f_open(&out, "pass.bin", FA_CREATE_ALWAYS | FA_WRITE);
+	if (res == FR_OK)
+		res = f_write(&out, &hdr, sizeof(hdr), &bw);
+	if (res == FR_OK)
+		res = f_write(&out, passes, sizeof(pass_t) * hdr.count, &bw);
+
+	if (res != FR_OK)
+		printf("pass.bin: error %d: %s\r\n", res, ff_strerror(res));
+
+	f_close(&out);
+}
+
+// Load pass.bin so the table is available immediately after boot.  It is
+// checked against tle.bin and the observer by the first pass_step().
+void pass_init()
+{
+	FRESULT res;
+	FIL in;
+	UINT br;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memset(&job, 0, sizeof(job));
+
+	res = f_open(&in, "pass.bin", FA_READ);
+	if (res != FR_OK)
+		return;
+
+	res = f_read(&in, &hdr, sizeof(hdr), &br);
+	if (res != FR_OK || br < sizeof(hdr) ||
+		hdr.magic != PASS_MAGIC || hdr.version != PASS_VERSION ||
+		hdr.count > PASS_MAX)
+	{
+		memset(&hdr, 0, sizeof(hdr));
+		f_close(&in);
+		return;
+	}
+
+	res = f_read(&in, passes, sizeof(pass_t) * hdr.count, &br);
+	if (res != FR_OK || br < sizeof(pass_t) * hdr.count)
+		memset(&hdr, 0, sizeof(hdr));
+
+	f_close(&in);
+}
+
+// Rebuild the whole table at the next pass_step(), for example after
+// tle.bin has been rewritten.
+void pass_invalidate()
+{
+	hdr.magic = 0;
+	hdr.count = 0;
+	job.sorted = 0;
+	job.active = 0;
+	job.last_check = 0;
+}
+
+// Raw TLE of record idx of tle.bin.  Returns 1 on success.
+int pass_tle(int idx, tle_t *tle)
+{
+	catalog_rec_t buf;
+	const catalog_rec_t *rec = catalog_get(idx, &buf);
+
+	return rec != NULL && catalog_unpack(rec, tle);
+}
+
+int pass_count()
+{
+	return job.active ? job.sorted : hdr.count;
+}
+
+const pass_t *pass_get(int i)
+{
+	if (i < 0 || i >= pass_count())
+		return NULL;
+
+	return &passes[i];
+}
+
+// Add a pass to the table.  If the table is full the pass with the
+// latest AOS is replaced, or p is dropped if it is the latest.
+static pass_t *pass_add(pass_t *p)
+{
+	int i, latest = 0;
+
+	if (hdr.count < PASS_MAX)
+	{
+		passes[hdr.count] = *p;
+		return &passes[hdr.count++];
+	}
+
+	job.dropped = 1;
+
+	for (i = 1; i < hdr.count; i++)
+		if (passes[i].aos > passes[latest].aos)
+			latest = i;
+
+	if (passes[latest].aos <= p->aos)
+		return NULL;
+
+	if (latest < job.sorted)
+		job.sorted = latest;
+
+	passes[latest] = *p;
+
+	return &passes[latest];
+}
+
+// Satellite elevation in degrees at unix time t
+static double pass_elevation(uint32_t t)
+{
+	vector_t pos, vel, obs_set;
+	double jul = (double)t / 86400 + PASS_JD_UNIX_EPOCH;
+	double tsince = (jul - job.jul_epoch) * 24*60;
+
+	if (job.deep)
+		SDP4(tsince, &job.tle, &pos, &vel);
+	else
+		sgp4f(&job.sgp, tsince, &pos, &vel);
+
+	Convert_Sat_State(&pos, &vel);
+	Calculate_Obs(jul, &pos, &vel, &job.obs, &obs_set);
+
+	job.jul = jul;
+	job.pos = pos;
+	job.propagations++;
+
+	return Degrees(obs_set.y);
+}
+
+// Find the horizon crossing between t0 and t1.  The satellite is up at
+// t1 if rising is true and at t0 if not.
+static uint32_t pass_bisect(uint32_t t0, uint32_t t1, int rising)
+{
+	uint32_t mid;
+
+	while (t1 - t0 > PASS_RESOLUTION)
+	{
+		mid = t0 + (t1 - t0) / 2;
+		if ((pass_elevation(mid) > 0) == rising)
+			t1 = mid;
+		else
+			t0 = mid;
+	}
+
+	return rising ? t1 : t0;
+}
+
+static void pass_begin(uint32_t aos, uint16_t flags)
+{
+	pass_t p = {
+		.aos = aos,
+		.los = aos,
+		.max_el = 0,
+		.idx = job.idx,
+		.flags = flags
+	};
+
+	job.cur = pass_add(&p);
+	job.n_el = 0;
+}
+
+// Continue a pass of this satellite that was still up at the end of the
+// previous slice, or start one at the slice start.  A slice that resumes
+// after a full table starts at the AOS of the last pass kept, and passes
+// already in the table are not recorded again.
+static void pass_continue()
+{
+	int i;
+
+	for (i = 0; i < hdr.count; i++)
+	{
+		if (passes[i].idx != job.idx)
+			continue;
+
+		if ((passes[i].flags & PASS_OPEN_LOS) &&
+			passes[i].los == job.start)
+		{
+			passes[i].flags &= ~PASS_OPEN_LOS;
+			job.cur = &passes[i];
+			job.n_el = 0;
+			return;
+		}
+
+		if (passes[i].aos <= job.start && passes[i].los > job.start)
+		{
+			job.cur = NULL;
+			return;
+		}
+	}
+
+	pass_begin(job.start, PASS_OPEN_AOS);
+}
+
+// Keep the highest elevation seen.  When the previous sample was a local
+// maximum the peak is between the samples either side of it, so it is
+// found there with a ternary search.
+static void pass_max_el(uint32_t t, double el)
+{
+	uint32_t lo, hi, m1, m2;
+	double e1, e2;
+
+	if (job.cur == NULL)
+		return;
+
+	if (el > job.cur->max_el)
+		job.cur->max_el = el;
+
+	if (job.n_el >= 2 && job.el[1] >= job.el[0] && job.el[1] >= el)
+	{
+		lo = job.el_t;
+		hi = t;
+		while (hi - lo > 2*PASS_RESOLUTION)
+		{
+			m1 = lo + (hi - lo) / 3;
+			m2 = hi - (hi - lo) / 3;
+			e1 = pass_elevation(m1);
+			e2 = pass_elevation(m2);
+
+			if (e1 > job.cur->max_el)
+				job.cur->max_el = e1;
+			if (e2 > job.cur->max_el)
+				job.cur->max_el = e2;
+
+			if (e1 < e2)
+				lo = m1;
+			else
+				hi = m2;
+		}
+	}
+
+	if (job.n_el >= 1)
+		job.el_t = job.el_t1;
+	job.el_t1 = t;
+
+	job.el[0] = job.el[1];
+	job.el[1] = el;
+	if (job.n_el < 2)
+		job.n_el++;
+}
+
+// Mark the pass in progress visible if the satellite is sunlit at the
+// last pass_elevation() sample while the observer is in darkness.  This
+// uses the solar position cached by sat_solar().
+static void pass_visible()
+{
+	double depth;
+
+	if (job.cur == NULL || (job.cur->flags & PASS_VISIBLE))
+		return;
+
+	if (sat_solar(job.jul)->sun_el < PASS_SUN_DARK &&
+		sat_sunlit(job.jul, &job.pos, &depth))
+		job.cur->flags |= PASS_VISIBLE;
+}
+
+// Load the next satellite.  Returns 0 at the end of tle.bin.
+static int pass_load()
+{
+	const catalog_rec_t *rec;
+
+	// Damaged records are skipped
+	while ((rec = catalog_get(job.idx, &job.rec)) != NULL &&
+		!catalog_unpack(rec, &job.tle))
+		job.idx += job.parts;
+
+	if (rec == NULL)
+		return 0;
+
+	job.never = !prefilter_init(&job.pf, &job.tle, &config.observer, 0);
+
+	// The record holds what select_ephemeris() would work out
+	catalog_select(rec, &job.tle);
+	job.deep = isFlagSet(DEEP_SPACE_EPHEM_FLAG);
+	sat_reselect();
+
+	job.jul_epoch = Julian_Date_of_Epoch(job.tle.epoch);
+	if (!job.deep)
+		sgp4f_init(&job.sgp, &job.tle);
+
+	job.obs = config.observer;
+	job.step = job.deep ? PASS_STEP_DEEP : PASS_STEP_NEAR;
+	job.t = job.start;
+	job.up = 0;
+	job.cur = NULL;
+	job.loaded = 1;
+	job.sats++;
+
+	return 1;
+}
+
+static void pass_finish()
+{
+	qsort(passes, hdr.count, sizeof(pass_t), pass_cmp);
+
+	// Passes after the last one kept are found again once earlier
+	// passes have ended and made room
+	if (job.dropped && hdr.count > 0 && passes[hdr.count-1].aos > job.start)
+		hdr.end = passes[hdr.count-1].aos;
+	else if (job.dropped)
+		hdr.end = job.start;
+	else
+		hdr.end = job.end;
+	job.active = 0;
+
+	pass_save();
+}
+
+static void pass_start(uint32_t start, uint32_t end)
+{
+	if (job.parts < 1)
+		job.parts = 1;
+
+	job.start = start;
+	job.end = end;
+	job.idx = job.part;
+	job.loaded = 0;
+	job.sorted = hdr.count;
+	job.dropped = 0;
+	job.active = 1;
+}
+
+// Empty the table for a new window starting at now
+static void pass_reset(uint32_t now, uint32_t tle_size)
+{
+	hdr.magic = PASS_MAGIC;
+	hdr.version = PASS_VERSION;
+	hdr.tle_size = tle_size;
+	hdr.lat = config.observer.lat;
+	hdr.lon = config.observer.lon;
+	hdr.start = now;
+	hdr.end = now;
+	hdr.count = 0;
+}
+
+// Drop passes that have ended and extend the window or rebuild the table
+// if it is out of date.
+static void pass_check(uint32_t now)
+{
+	FILINFO fno;
+	int i, n;
+
+	if (f_stat("tle.bin", &fno) != FR_OK)
+	{
+		hdr.count = 0;
+		return;
+	}
+
+	if (hdr.magic != PASS_MAGIC ||
+		hdr.tle_size != fno.fsize ||
+		fabs(hdr.lat - config.observer.lat) > PASS_OBS_MOVED ||
+		fabs(hdr.lon - config.observer.lon) > PASS_OBS_MOVED ||
+		hdr.end < now)
+	{
+		pass_reset(now, fno.fsize);
+
+		job.builds++;
+		pass_start(now, now + PASS_WINDOW);
+		return;
+	}
+
+	for (i = n = 0; i < hdr.count; i++)
+		if (passes[i].los >= now)
+			passes[n++] = passes[i];
+	hdr.count = n;
+	hdr.start = now;
+
+	// A full table is extended once passes have ended
+	if (hdr.count < PASS_MAX && hdr.end < now + PASS_WINDOW - PASS_EXTEND)
+	{
+		job.extends++;
+		pass_start(hdr.end, now + PASS_WINDOW);
+	}
+}
+
+// Do up to PASS_CHUNK propagations of the slice being scanned.
+static void pass_scan()
+{
+	uint32_t t;
+	double el, jul, wait;
+	uint32_t steps;
+	int i;
+
+	if (!job.loaded && !pass_load())
+	{
+		pass_finish();
+		return;
+	}
+
+	if (job.never)
+	{
+		prefilter_stats.saved += (job.end - job.start) / job.step + 1;
+		job.idx += job.parts;
+		job.loaded = 0;
+		return;
+	}
+
+	if (job.deep)
+	{
+		ClearFlag(ALL_FLAGS);
+		SetFlag(DEEP_SPACE_EPHEM_FLAG);
+	}
+
+	for (i = 0; i < PASS_CHUNK && job.loaded; i++)
+	{
+		t = job.t;
+
+		// Skip the samples before the satellite can come within
+		// reach of the observer.
+		if (!job.up && t < job.end)
+		{
+			jul = (double)t / 86400 + PASS_JD_UNIX_EPOCH;
+			wait = (prefilter_next(&job.pf, jul) - jul) * 86400;
+			if (wait >= job.step)
+			{
+				steps = fmin(wait, job.end - t) / job.step;
+
+				prefilter_stats.window++;
+				prefilter_stats.saved += steps;
+				job.t = steps ? t + steps * job.step : job.end;
+				continue;
+			}
+		}
+
+		el = pass_elevation(t);
+
+		if (t == job.start)
+		{
+			if (el > 0)
+				pass_continue();
+		}
+		else if (el > 0 && !job.up)
+			pass_begin(pass_bisect(t - job.step, t, 1), 0);
+		else if (el <= 0 && job.up && job.cur != NULL)
+			job.cur->los = pass_bisect(t - job.step, t, 0);
+
+		// pass_max_el() may propagate again, so the visibility of
+		// this sample is checked first.
+		if (el > 0)
+		{
+			pass_visible();
+			pass_max_el(t, el);
+		}
+
+		job.up = el > 0;
+
+		if (t >= job.end)
+		{
+			if (job.up && job.cur != NULL)
+			{
+				job.cur->los = job.end;
+				job.cur->flags |= PASS_OPEN_LOS;
+			}
+
+			job.idx += job.parts;
+			job.loaded = 0;
+		}
+		else if (job.end - t < job.step)
+			job.t = job.end;
+		else
+			job.t = t + job.step;
+	}
+
+	sat_reselect();
+}
+
+void pass_step()
+{
+	uint32_t now = pass_now();
+
+	if (now < PASS_MIN_TIME)
+		return;
+
+	if (!job.active)
+	{
+		if (now - job.last_check < PASS_CHECK)
+			return;
+
+		job.last_check = now;
+		pass_check(now);
+
+		return;
+	}
+
+	sat_lock();
+	pass_scan();
+	sat_unlock();
+}
+
+// Build the table for the window starting at start in one go, scanning
+// only every parts'th satellite of tle.bin starting at part.  This is for
+// the host tool, which runs one process for each part and combines their
+// passes with pass_import().  Returns the number of passes found.
+int pass_build(uint32_t start, int part, int parts)
+{
+	FILINFO fno;
+
+	memset(&job, 0, sizeof(job));
+
+	if (f_stat("tle.bin", &fno) != FR_OK)
+		return 0;
+
+	pass_reset(start, fno.fsize);
+
+	job.part = part;
+	job.parts = parts;
+	pass_start(start, start + PASS_WINDOW);
+
+	while (job.active)
+		pass_scan();
+
+	return hdr.count;
+}
+
+// Replace the table with the n passes in p for the window starting at
+// start, keeping the max earliest, and save it to pass.bin.  p is sorted
+// in place.
+void pass_import(pass_t *p, int n, int max, uint32_t start)
+{
+	FILINFO fno;
+
+	memset(&job, 0, sizeof(job));
+
+	if (f_stat("tle.bin", &fno) != FR_OK)
+		return;
+
+	pass_reset(start, fno.fsize);
+
+	qsort(p, n, sizeof(pass_t), pass_cmp);
+
+	if (max > PASS_MAX)
+		max = PASS_MAX;
+	hdr.count = n < max ? n : max;
+	memcpy(passes, p, sizeof(pass_t) * hdr.count);
+
+	// The passes that did not fit are scanned for on the device as the
+	// table empties
+	if (n > hdr.count && hdr.count > 0 && p[hdr.count-1].aos > start)
+		hdr.end = p[hdr.count-1].aos;
+	else if (n > hdr.count)
+		hdr.end = start;
+	else
+		hdr.end = start + PASS_WINDOW;
+
+	pass_save();
+}
+
+// Print the next n passes that have not ended, or only the passes in
+// progress if visible is true.  Passes that can be seen by eye are marked
+// with a *.
+void pass_print(int n, int visible)
+{
+	const pass_t *p;
+	uint32_t now = pass_now();
+	time_t t;
+	struct tm aos, los;
+	tle_t tle;
+	int i, count = 0;
+
+	if (!pass_count())
+	{
+		print("The pass table is empty, see `sat passes status`\r\n");
+		return;
+	}
+
+	printf("AOS (UTC)       LOS (UTC)  MAX EL  [CAT #] SATELLITE\r\n");
+	printf("=====================================================\r\n");
+	for (i = 0; i < pass_count() && count < n; i++)
+	{
+		p = pass_get(i);
+		if (p->los < now || (visible && p->aos > now))
+			continue;
+
+		if (!pass_tle(p->idx, &tle))
+			continue;
+
+		t = p->aos;
+		gmtime_r(&t, &aos);
+		t = p->los;
+		gmtime_r(&t, &los);
+
+		printf("%02d/%02d %02d:%02d:%02d%c %02d:%02d:%02d%c  %5.1f%c [%5d] %s\r\n",
+			aos.tm_mon+1, aos.tm_mday,
+			aos.tm_hour, aos.tm_min, aos.tm_sec,
+			(p->flags & PASS_OPEN_AOS) ? '<' : ' ',
+			los.tm_hour, los.tm_min, los.tm_sec,
+			(p->flags & PASS_OPEN_LOS) ? '>' : ' ',
+			p->max_el, (p->flags & PASS_VISIBLE) ? '*' : ' ',
+			tle.catnr, tle.sat_name);
+		count++;
+	}
+}
+
+void pass_status()
+{
+	printf("pass table: %d passes, %s, %u sats scanned, %u propagations, "
+		"%u builds, %u extends\r\n",
+		(int)hdr.count,
+		job.active ? "updating" : "ready",
+		job.sats, job.propagations,
+		job.builds, job.extends);
+
+	prefilter_status();
+
+	if (job.active)
+		printf("scanning satellite %d, %u of %u seconds\r\n",
+			job.idx, (unsigned)(job.t - job.start),
+			(unsigned)(job.end - job.start));
+}
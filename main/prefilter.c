@@ -0,0 +1,262 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+
+// Visibility prefilter:
+//
+// Cheap tests from the mean elements that rule satellites out before
+// anything is propagated.  prefilter_init() rejects satellites that can
+// never rise above min_el for the observer: their inclination is too low
+// for the observer's latitude, or their perigee is below the atmosphere.
+// prefilter_next() moves the mean elements forward with two-body motion
+// and the J2 and drag secular rates, and gives the earliest time at which
+// the satellite could be above min_el.  That is the ground-track window:
+// until the sub-satellite point comes within reach of the observer, the
+// satellite cannot be seen, so listing skips it and pass prediction skips
+// ahead.
+//
+// The secular model ignores the short and long period terms of SGP4,
+// so the reach includes a margin that grows with the time from epoch.
+// Deep space satellites only get the latitude test, because lunar and
+// solar terms move them too far from the secular model.
+
+#include <stdio.h>
+#include <math.h>
+
+#include "sgp4sdp4.h"
+#include "prefilter.h"
+#include "sat.h"
+#include "config.h"
+
+#define PREFILTER_PI          3.14159265358979323846
+#define PREFILTER_TWOPI       (2*PREFILTER_PI)
+
+// Constants in earth radii and minutes, the same as SGP4
+#define PREFILTER_XKE         7.43669161E-2
+#define PREFILTER_CK2         5.413079E-4
+#define PREFILTER_QOMS2T      1.880279E-09
+#define PREFILTER_S           1.012229
+#define PREFILTER_XKMPER      6.378135E3
+#define PREFILTER_FLATTENING  3.35281066474748E-3
+
+// Earth rotation (radians/minute)
+#define PREFILTER_OMEGA_E     4.3752691E-3
+
+// Orbital period that selects SDP4 (minutes)
+#define PREFILTER_DEEP_PERIOD 225.0
+
+// Perigee below this has decayed (km)
+#define PREFILTER_DECAY_ALT   80.0
+
+// Margin for the secular model at epoch and how it grows per day from
+// epoch (radians).  Against SGP4 over +/- 7 days the sub-satellite point
+// of the secular model stays within 0.2 degrees for typical low orbits
+// and within 1.2 degrees after 6 days for B* = 2E-3, so this leaves
+// room for that and the spherical earth.
+#define PREFILTER_MARGIN      (1.0 * PREFILTER_PI / 180)
+#define PREFILTER_MARGIN_DAY  (0.5 * PREFILTER_PI / 180)
+
+prefilter_stats_t prefilter_stats;
+
+// Set up pf for the raw TLE (before select_ephemeris() converts it) and
+// the observer.  Returns 0 if the satellite can never be above min_el
+// degrees.
+int prefilter_init(prefilter_t *pf, const tle_t *tle, const geodetic_t *obs, double min_el)
+{
+	double n0, a1, cosi, x3thm1, betao, betao2, del1, ao, delo, p2,
+		r_apo, r_peri, ratio, incl, aodp, s4, qoms24, perigee, tsi, eta,
+		etasq, eeta, psisq, coef, c2;
+
+	prefilter_stats.sats++;
+
+	pf->jul_epoch = Julian_Date_of_Epoch(tle->epoch);
+	pf->e = tle->eo;
+	pf->incl = tle->xincl * PREFILTER_PI / 180;
+	pf->raan = tle->xnodeo * PREFILTER_PI / 180;
+	pf->argp = tle->omegao * PREFILTER_PI / 180;
+	pf->m = tle->xmo * PREFILTER_PI / 180;
+
+	// Recover the original mean motion and semi-major axis the same
+	// way SGP4 does.
+	n0 = tle->xno * PREFILTER_TWOPI / 1440;
+	a1 = pow(PREFILTER_XKE / n0, 2.0/3.0);
+	cosi = cos(pf->incl);
+	x3thm1 = 3*cosi*cosi - 1;
+	betao2 = 1 - pf->e*pf->e;
+	betao = sqrt(betao2);
+	del1 = 1.5*PREFILTER_CK2*x3thm1 / (a1*a1*betao*betao2);
+	ao = a1*(1 - del1*(1.0/3 + del1*(1 + 134.0/81*del1)));
+	delo = 1.5*PREFILTER_CK2*x3thm1 / (ao*ao*betao*betao2);
+	pf->n = n0 / (1 + delo);
+	aodp = ao / (1 - delo);
+	pf->a = aodp * PREFILTER_XKMPER;
+
+	// Secular J2 rates
+	p2 = pow(pf->a / PREFILTER_XKMPER * betao2, 2);
+	pf->raan_dot = -3*PREFILTER_CK2*pf->n*cosi / p2;
+	pf->argp_dot = 1.5*PREFILTER_CK2*pf->n*(5*cosi*cosi - 1) / p2;
+	pf->m_dot = pf->n + 1.5*PREFILTER_CK2*pf->n*betao*x3thm1 / p2;
+
+	// Drag: SGP4 advances the mean anomaly by n * 1.5 * C1 * t^2, and
+	// C1 comes from B* rather than the mean motion derivative in the TLE.
+	s4 = PREFILTER_S;
+	qoms24 = PREFILTER_QOMS2T;
+	perigee = (aodp*(1 - pf->e) - 1) * PREFILTER_XKMPER;
+	if (perigee < 156)
+	{
+		s4 = perigee <= 98 ? 20 : perigee - 78;
+		qoms24 = pow((120 - s4) / PREFILTER_XKMPER, 4);
+		s4 = s4 / PREFILTER_XKMPER + 1;
+	}
+	tsi = 1 / (aodp - s4);
+	eta = aodp*pf->e*tsi;
+	etasq = eta*eta;
+	eeta = pf->e*eta;
+	psisq = fabs(1 - etasq);
+	coef = qoms24*pow(tsi, 4);
+	c2 = coef / pow(psisq, 3.5) * pf->n * (aodp*(1 + 1.5*etasq + eeta*(4 + etasq)) +
+		0.75*PREFILTER_CK2*tsi/psisq*x3thm1*(8 + 3*etasq*(8 + etasq)));
+	pf->drag = pf->n * 1.5 * tle->bstar * c2;
+
+	pf->deep_space = PREFILTER_TWOPI / n0 >= PREFILTER_DEEP_PERIOD;
+
+	// Observer geocentric latitude
+	pf->lat = atan(pow(1 - PREFILTER_FLATTENING, 2) * tan(obs->lat));
+	pf->lon = obs->lon;
+
+	r_peri = pf->a * (1 - pf->e);
+	r_apo = pf->a * (1 + pf->e);
+
+	if (r_peri < PREFILTER_XKMPER + PREFILTER_DECAY_ALT)
+	{
+		prefilter_stats.decayed++;
+		return 0;
+	}
+
+	// Central angle from the sub-satellite point to where the
+	// satellite is at min_el, largest at apogee.
+	min_el *= PREFILTER_PI / 180;
+	ratio = PREFILTER_XKMPER * cos(min_el) / r_apo;
+	pf->reach = acos(ratio > 1 ? 1 : ratio) - min_el + PREFILTER_MARGIN;
+
+	// The sub-satellite point never goes further from the equator than
+	// the inclination.
+	incl = pf->incl <= PREFILTER_PI/2 ? pf->incl : PREFILTER_PI - pf->incl;
+	if (fabs(pf->lat) > incl + pf->reach)
+	{
+		prefilter_stats.latitude++;
+		return 0;
+	}
+
+	// The true anomaly changes fastest at perigee
+	pf->rate = pf->m_dot * pow(1 + pf->e, 2) / pow(betao2, 1.5) +
+		fabs(pf->argp_dot) + fabs(pf->raan_dot) +
+		PREFILTER_OMEGA_E * cos(pf->lat);
+
+	return 1;
+}
+
+// Central angle between the observer and the sub-satellite point from
+// the secular model
+static double prefilter_angle(const prefilter_t *pf, double jul)
+{
+	double t = (jul - pf->jul_epoch) * 1440, m, ea, d, nu, u, raan, theta,
+		sx, sy, sz, ox, oy, oz, dot;
+	int i;
+
+	m = fmod(pf->m + pf->m_dot*t + pf->drag*t*t, PREFILTER_TWOPI);
+
+	// Kepler's equation
+	ea = m;
+	for (i = 0; i < 10; i++)
+	{
+		d = (ea - pf->e*sin(ea) - m) / (1 - pf->e*cos(ea));
+		ea -= d;
+		if (fabs(d) < 1E-6)
+			break;
+	}
+
+	nu = 2*atan2(sqrt(1 + pf->e)*sin(ea/2), sqrt(1 - pf->e)*cos(ea/2));
+	u = pf->argp + pf->argp_dot*t + nu;
+	raan = pf->raan + pf->raan_dot*t;
+
+	sx = cos(raan)*cos(u) - sin(raan)*sin(u)*cos(pf->incl);
+	sy = sin(raan)*cos(u) + cos(raan)*sin(u)*cos(pf->incl);
+	sz = sin(u)*sin(pf->incl);
+
+	theta = ThetaG_JD(jul) + pf->lon;
+	ox = cos(pf->lat)*cos(theta);
+	oy = cos(pf->lat)*sin(theta);
+	oz = sin(pf->lat);
+
+	dot = sx*ox + sy*oy + sz*oz;
+
+	return acos(dot > 1 ? 1 : dot < -1 ? -1 : dot);
+}
+
+// Earliest Julian date at or after jul at which the satellite could be
+// above min_el.  Returns jul if it could be above min_el now.
+double prefilter_next(const prefilter_t *pf, double jul)
+{
+	double reach, angle;
+
+	if (pf->deep_space)
+		return jul;
+
+	reach = pf->reach + PREFILTER_MARGIN_DAY * fabs(jul - pf->jul_epoch);
+	angle = prefilter_angle(pf, jul);
+
+	if (angle <= reach)
+		return jul;
+
+	return jul + (angle - reach) / pf->rate / 1440;
+}
+
+// Returns 0 if the satellite in the raw TLE cannot be above min_el from
+// config.observer right now, so it does not need to be propagated.
+int prefilter_now(const tle_t *tle, double min_el)
+{
+	prefilter_t pf;
+	double jul = sat_tick_now()->jul_utc;
+
+	if (!prefilter_init(&pf, tle, &config.observer, min_el))
+	{
+		prefilter_stats.saved++;
+		return 0;
+	}
+
+	if (prefilter_next(&pf, jul) > jul)
+	{
+		prefilter_stats.window++;
+		prefilter_stats.saved++;
+		return 0;
+	}
+
+	return 1;
+}
+
+void prefilter_status()
+{
+	printf("prefilter: %u sats, %u below latitude, %u decayed, "
+		"%u out of window, %u propagations saved\r\n",
+		prefilter_stats.sats, prefilter_stats.latitude,
+		prefilter_stats.decayed, prefilter_stats.window,
+		prefilter_stats.saved);
+}
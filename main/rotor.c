@@ -40,6 +40,7 @@
 #include "i2c/mxc4005xc.h"
 #include "i2c/mmc5603nj.h"
 #include "rtcc.h"
+#include "journal.h"
 
 #define ROTOR_CAL_MAGIC   0x458FD1E9
 #define ROTOR_CUR_VERSION 3
@@ -621,7 +622,154 @@ void rotor_adc_init(struct rotor *r)
 	}
 }
 
-void rotor_cal_load()
+// Only settings and calibrations are saved, not the PID history or other
+// runtime state.  Each rotor is journal group rotor number + 1.  Field
+// numbers are stored in cal.jnl, never reuse or renumber them.
+static const journal_field_t rotor_fields[] = {
+	JOURNAL_FIELD_STR(1, struct rotor, motor.name),
+	JOURNAL_FIELD(2, struct rotor, motor.port),
+	JOURNAL_FIELD(3, struct rotor, motor.pin1),
+	JOURNAL_FIELD(4, struct rotor, motor.pin2),
+	JOURNAL_FIELD(5, struct rotor, motor.pwm_Hz),
+	JOURNAL_FIELD(6, struct rotor, motor.online),
+	JOURNAL_FIELD(7, struct rotor, motor.duty_cycle_at_init),
+	JOURNAL_FIELD(8, struct rotor, motor.duty_cycle_min),
+	JOURNAL_FIELD(9, struct rotor, motor.duty_cycle_max),
+	JOURNAL_FIELD(10, struct rotor, motor.duty_cycle_limit),
+	JOURNAL_FIELD(11, struct rotor, motor.invert),
+
+	JOURNAL_FIELD(12, struct rotor, target),
+	JOURNAL_FIELD(13, struct rotor, target_enabled),
+	JOURNAL_FIELD(14, struct rotor, ramp_time),
+	JOURNAL_FIELD(15, struct rotor, target_absolute),
+	JOURNAL_FIELD(16, struct rotor, offset),
+	JOURNAL_FIELD(17, struct rotor, speed_exp),
+
+	JOURNAL_FIELD(18, struct rotor, pid.kp),
+	JOURNAL_FIELD(19, struct rotor, pid.ki),
+	JOURNAL_FIELD(20, struct rotor, pid.kvfb),
+	JOURNAL_FIELD(21, struct rotor, pid.kvff),
+	JOURNAL_FIELD(22, struct rotor, pid.kaff),
+	JOURNAL_FIELD(23, struct rotor, pid.k1),
+	JOURNAL_FIELD(24, struct rotor, pid.k2),
+	JOURNAL_FIELD(25, struct rotor, pid.k3),
+	JOURNAL_FIELD(26, struct rotor, pid.k4),
+	JOURNAL_FIELD(27, struct rotor, pid.stationary),
+	JOURNAL_FIELD(28, struct rotor, pid.one_dir_motion),
+
+	JOURNAL_FIELD(29, struct rotor, mag_dec),
+	JOURNAL_FIELD(30, struct rotor, error_count_max),
+};
+
+#define ROTOR_FIELDS (sizeof(rotor_fields) / sizeof(rotor_fields[0]))
+
+// Fields that are not plain members
+enum {
+	// motor_type, motor_bus, motor_addr (2 bytes LE), motor_channel
+	ROTOR_FIELD_MOTOR_BUS = 64,
+
+	// adc_type, adc_bus, adc_addr (2 bytes LE), adc_channel, adc_vref
+	ROTOR_FIELD_ADC,
+
+	// cal[0..cal_count-1]
+	ROTOR_FIELD_CAL,
+};
+
+static void rotor_journal_load(journal_t *j, uint16_t tag, const void *data, int len)
+{
+	const uint8_t *b = data;
+	struct rotor *r;
+	int group = JOURNAL_TAG_GROUP(tag);
+
+	if (group < 1 || group > NUM_ROTORS)
+		return;
+
+	r = &rotors[group - 1];
+
+	switch (JOURNAL_TAG_FIELD(tag))
+	{
+		case ROTOR_FIELD_MOTOR_BUS:
+			if (len != 5)
+				break;
+
+			r->motor.motor_type = b[0];
+			r->motor.motor_bus = b[1];
+			r->motor.motor_addr = b[2] | (b[3] << 8);
+			r->motor.motor_channel = b[4];
+			break;
+
+		case ROTOR_FIELD_ADC:
+			if (len != 6)
+				break;
+
+			r->adc_type = b[0];
+			r->adc_bus = b[1];
+			r->adc_addr = b[2] | (b[3] << 8);
+			r->adc_channel = b[4];
+			r->adc_vref = b[5];
+			break;
+
+		case ROTOR_FIELD_CAL:
+			if (len % sizeof(struct rotor_cal) || len > sizeof(r->cal))
+				break;
+
+			memcpy(r->cal, data, len);
+			r->cal_count = len / sizeof(struct rotor_cal);
+			break;
+
+		default:
+			journal_get_field(rotor_fields, ROTOR_FIELDS, r, JOURNAL_TAG_FIELD(tag), data, len);
+	}
+}
+
+static void rotor_journal_save(journal_t *j)
+{
+	struct rotor *r;
+	uint8_t b[6];
+	int i;
+
+	for (i = 0; i < NUM_ROTORS; i++)
+	{
+		r = &rotors[i];
+
+		journal_put_fields(j, i + 1, rotor_fields, ROTOR_FIELDS, r);
+
+		b[0] = r->motor.motor_type;
+		b[1] = r->motor.motor_bus;
+		b[2] = r->motor.motor_addr & 0xFF;
+		b[3] = r->motor.motor_addr >> 8;
+		b[4] = r->motor.motor_channel;
+		journal_put(j, JOURNAL_TAG(i + 1, ROTOR_FIELD_MOTOR_BUS), b, 5);
+
+		b[0] = r->adc_type;
+		b[1] = r->adc_bus;
+		b[2] = r->adc_addr & 0xFF;
+		b[3] = r->adc_addr >> 8;
+		b[4] = r->adc_channel;
+		b[5] = r->adc_vref;
+		journal_put(j, JOURNAL_TAG(i + 1, ROTOR_FIELD_ADC), b, 6);
+
+		journal_put(j, JOURNAL_TAG(i + 1, ROTOR_FIELD_CAL), r->cal,
+			r->cal_count * sizeof(struct rotor_cal));
+	}
+}
+
+static journal_tag_t rotor_tags[NUM_ROTORS * (ROTOR_FIELDS + 8)];
+
+journal_t rotor_journal = {
+	.filename = "cal.jnl",
+	.tmpname = "cal.jnt",
+	.schema = 1,
+	.max = 16384,
+	.tags = rotor_tags,
+	.tags_max = sizeof(rotor_tags) / sizeof(rotor_tags[0]),
+	.load = rotor_journal_load,
+	.save = rotor_journal_save,
+};
+
+// Load a cal.bin from before cal.jnl, which holds the whole rotors[]
+// array in one of the old layouts.
+static FRESULT rotor_cal_load_bin()
 {
 	struct rotor_cal_header h;
 
@@ -637,7 +785,7 @@ void rotor_cal_load()
 	if (res != FR_OK)
 	{
 		printf("%s: open error %d: %s\r\n", filename, res, ff_strerror(res));
-		return;
+		return res;
 	}
 
 	res = f_read(&in, &h, sizeof(h), &br);
@@ -689,20 +837,6 @@ void rotor_cal_load()
 
 	for (i = 0; i < NUM_ROTORS; i++)
 	{
-		if (rotors[i].speed_exp < 1)
-			rotors[i].speed_exp = 1;
-
-		if (rotors[i].pid.k < 0 || rotors[i].pid.k >= PID_HIST_LEN)
-			rotors[i].pid.k = 0;
-
-		rotors[i].pid.target_cur = 0;
-		rotors[i].pid.target_prev = 0;
-		rotors[i].pid.target_cur_count = 0;
-		rotors[i].pid.target_prev_count = 0;
-		rotors[i].pid.target_slope = 0;
-
-		rotors[i].error_count = 0;
-
 		// Upgrade rotor structures if they are an old version
 		if (rotors[i].version < 1)
 		{
@@ -737,66 +871,50 @@ void rotor_cal_load()
 			rotors[i].error_count_max = 300; // 3s at 100ticks/sec
 			rotors[i].version = 3;
 		}
-
-
-		rotor_adc_init(&rotors[i]);
 	}
 
 	f_close(&in);
+
+	return FR_OK;
 }
 
-void rotor_cal_save()
+void rotor_cal_load()
 {
-	struct rotor_cal_header h;
-
-	FRESULT res = FR_OK;  /* API result code */
-	FIL out;              /* File object */
-	UINT bw;          /* Bytes written */
-
-	char *filename = "cal.bin";
-
-	size_t len;
+	FILINFO fno;
+	int i, convert;
 
-	int i;
+	// A cal.bin from before cal.jnl, or one uploaded with `fat rx cal.bin`,
+	// replaces the journal and is then renamed to cal.old.
+	convert = f_stat("cal.bin", &fno) == FR_OK && rotor_cal_load_bin() == FR_OK;
+	if (!convert)
+		journal_load(&rotor_journal);
 
-	res = f_open(&out, filename, FA_CREATE_ALWAYS | FA_WRITE);
-	if (res != FR_OK)
+	for (i = 0; i < NUM_ROTORS; i++)
 	{
-		printf("%s: open error %d: %s\r\n", filename, res, ff_strerror(res));
-		return;
-	}
-
-	memset(&h, 0, sizeof(h));
+		if (rotors[i].speed_exp < 1)
+			rotors[i].speed_exp = 1;
 
-	// Write calibration file version 1 format:
-	//   The structure defines the number of records
-	//   and the size of each record.
-	h.magic = ROTOR_CAL_MAGIC;
-	h.version = 1;
-	h.size = sizeof(struct rotor);
-	h.n = NUM_ROTORS;
+		rotors[i].error_count = 0;
 
-	len = sizeof(h);
-	res = f_write(&out, &h, len, &bw);
-	if (res != FR_OK || bw != len)
-	{
-		printf("%s: write error %d: %s (bytes written=%d/%ld)\r\n",
-			filename, res, ff_strerror(res), bw, (long)len);
+		rotor_pid_reset(&rotors[i]);
+		rotor_adc_init(&rotors[i]);
 	}
 
-	len = sizeof(rotors);
-
-	for (i = 0; i < NUM_ROTORS; i++)
-		rotors[i].version = ROTOR_CUR_VERSION;
-
-	res = f_write(&out, rotors, len, &bw);
-	if (res != FR_OK || bw != len)
+	if (convert)
 	{
-		printf("%s: write error %d: %s (bytes written=%d/%ld)\r\n",
-			filename, res, ff_strerror(res), bw, (long)len);
+		printf("cal.bin: converting to %s\r\n", rotor_journal.filename);
+		if (journal_compact(&rotor_journal) == FR_OK)
+		{
+			f_unlink("cal.old");
+			f_rename("cal.bin", "cal.old");
+		}
 	}
+}
 
-	f_close(&out);
+// Appends the rotor settings that changed since the last save to cal.jnl
+void rotor_cal_save()
+{
+	journal_save(&rotor_journal);
 }
 
 // Set the target of the rotor to the current position and set motor speed to 0.
@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <sys/time.h>
 
 #include "platform.h"
 
@@ -106,13 +107,23 @@ uint64_t rtcc_get()
 #ifdef __EFR32__
 	t = rtcc_ticks;
 #else
-	t = time(0) * ticks_per_sec;
+	struct timeval tv;
+
+	// Use the sub-second part of the clock so time based calculations
+	// like tracking see time advance smoothly between seconds.
+	gettimeofday(&tv, NULL);
+	t = tv.tv_sec * (uint64_t)ticks_per_sec + tv.tv_usec * (uint64_t)ticks_per_sec / 1000000;
 #endif
 	lock = 0;
 	
 	return t;
 }
 
+int rtcc_ticks_per_sec()
+{
+	return ticks_per_sec;
+}
+
 uint64_t rtcc_get_sec()
 {
 	return rtcc_get() / ticks_per_sec;
@@ -22,11 +22,17 @@
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <math.h>
+
+#include "platform.h"
 
 #include "sgp4sdp4.h"
+#include "sgp4f.h"
 
 #include "sat.h"
+#include "catalog.h"
 #include "config.h"
+#include "rtcc.h"
 
 #include "ff.h"
 #include "fatfs-util.h"
@@ -35,6 +41,42 @@
 // tracking multiple satellites. 
 static sat_t _sat, *sat = &_sat;
 
+#ifdef USE_SGP4F
+// Single-precision SGP4 state for near-earth satellites
+static sgp4f_t sgp4f_sat;
+#endif
+
+#ifdef __ESP32__
+static SemaphoreHandle_t sat_mutex;
+static StaticSemaphore_t sat_mutex_buf;
+#endif
+
+// The SGP4/SDP4 library keeps the ephemeris flags, VISIBLE_FLAG and the
+// SDP4 initialization in globals.  On the ESP32 the tracking thread uses
+// them while the console task propagates other TLEs for the pass table,
+// so both hold this lock.  Elsewhere tracking runs from main_idle() and
+// the lock does nothing.
+void sat_lock_init()
+{
+#ifdef __ESP32__
+	sat_mutex = xSemaphoreCreateMutexStatic(&sat_mutex_buf);
+#endif
+}
+
+void sat_lock()
+{
+#ifdef __ESP32__
+	xSemaphoreTake(sat_mutex, portMAX_DELAY);
+#endif
+}
+
+void sat_unlock()
+{
+#ifdef __ESP32__
+	xSemaphoreGive(sat_mutex);
+#endif
+}
+
 void tle_info(tle_t *s)
 {
 	printf("%s (%d)\r\n",
@@ -95,8 +137,425 @@ int tle_csum(char *s)
 	return csum % 10;
 }
 
+// Ephemeris interpolation:
+//
+// Running SGP4/SDP4 on every control tick is expensive, so when
+// config.sat_interp is enabled the satellite is only propagated at the
+// ends of an interval and the ECI position in between comes from a cubic
+// Hermite polynomial through both positions and velocities.  The error of
+// a cubic Hermite is bounded by h^4/384 * max(|x''''|), and for motion on
+// a circle of radius r at angular rate w we have |x''''| = r*w^4.  The
+// node spacing h is chosen from the perigee radius and perigee angular
+// rate so the position error stays below SAT_INTERP_MAX_ERR_KM.
+#define SAT_INTERP_MAX_ERR_KM 0.01
+#define SAT_INTERP_SAFETY     4.0
+#define SAT_INTERP_MIN_STEP   1.0
+#define SAT_INTERP_MAX_STEP   300.0
+
+// Geostationary satellites barely move in az/el, so they are propagated
+// every SAT_GEO_STEP seconds and the look angles are extrapolated from
+// their rates in between.
+#define SAT_GEO_STEP          60.0
+
+// Earth rotation rate (rad/sec), gravitational parameter (km^3/sec^2),
+// equatorial radius (km) and flattening as used by sgp4sdp4
+#define SAT_EARTH_ROTATION    7.292115E-5
+#define SAT_EARTH_GM          3.986008E5
+#define SAT_EARTH_RADIUS      6.378135E3
+#define SAT_EARTH_FLATTENING  3.35281066474748E-3
+
+// Julian date of the unix epoch
+#define SAT_JD_UNIX_EPOCH     2440587.5
+
+static struct {
+	// True if the nodes below are valid for the tracked satellite
+	int valid;
+
+	// True if the satellite is handled by the geostationary fast path
+	int geo;
+
+	// Node spacing in seconds
+	double step;
+
+	// Julian UTC date and ECI state (km, km/sec) at each node
+	double jul[2];
+	vector_t pos[2], vel[2];
+
+	// Look angles and rates at the last geostationary update
+	double az, el, az_rate, el_rate;
+
+	// Counters for `sat status`
+	unsigned int propagations, updates;
+} interp;
+
+// The sun moves about 0.25 degrees per minute across the sky and far less
+// in ECI, so its position is only recomputed every SAT_SOLAR_STEP seconds
+// and shared by every eclipse and visibility test in between.
+#define SAT_SOLAR_STEP        60.0
+
+static sat_solar_t solar;
+static int solar_valid = 0;
+static unsigned int solar_updates = 0;
+
+// Time context shared by everything that happens in one rtcc tick
+static sat_tick_t tick;
+
+// Observer quantities that only change when config.observer does.  Call
+// sat_observer_invalidate() after changing the observer.
+static struct {
+	int valid;
+
+	double sin_lat, cos_lat;
+
+	// Distance from the earth's axis and from the equatorial plane (km)
+	double rxy, z;
+} obs;
+
+// Return the time context for the current rtcc tick.  The Julian date and
+// sidereal time come straight from the rtcc tick count without a calendar
+// round trip and are only recalculated when the tick changes.
+const sat_tick_t *sat_tick_now()
+{
+	uint64_t ticks = rtcc_get();
+
+	if (tick.valid && tick.ticks == ticks)
+		return &tick;
+
+	tick.ticks = ticks;
+	tick.jul_utc = (double)ticks / rtcc_ticks_per_sec() / secday + SAT_JD_UNIX_EPOCH;
+	tick.gmst = ThetaG_JD(tick.jul_utc);
+	tick.valid = 1;
+
+	return &tick;
+}
+
+void sat_observer_invalidate()
+{
+	obs.valid = 0;
+	solar_valid = 0;
+}
+
+// Observer position on the WGS-72 ellipsoid, the same as
+// Calculate_User_PosVel() but only recalculated when the observer moves.
+static void sat_observer_update()
+{
+	double c, sq;
+
+	if (obs.valid)
+		return;
+
+	obs.sin_lat = sin(config.observer.lat);
+	obs.cos_lat = cos(config.observer.lat);
+
+	c = 1 / sqrt(1 + SAT_EARTH_FLATTENING * (SAT_EARTH_FLATTENING - 2) * obs.sin_lat * obs.sin_lat);
+	sq = (1 - SAT_EARTH_FLATTENING) * (1 - SAT_EARTH_FLATTENING) * c;
+
+	obs.rxy = (SAT_EARTH_RADIUS * c + config.observer.alt) * obs.cos_lat;
+	obs.z = (SAT_EARTH_RADIUS * sq + config.observer.alt) * obs.sin_lat;
+
+	obs.valid = 1;
+}
+
+// Return the Hermite node spacing in seconds.  This must be called with
+// the raw TLE before select_ephemeris() converts its units.
+static double sat_interp_step(tle_t *tle)
+{
+	double n, a, e, rp, wp, step;
+
+	// Mean motion (rad/sec) and semi-major axis (km)
+	n = tle->xno * twopi / secday;
+	e = tle->eo;
+	if (n <= 0 || e < 0 || e >= 1)
+		return SAT_INTERP_MIN_STEP;
+
+	a = pow(SAT_EARTH_GM / (n*n), 1.0/3.0);
+
+	// Perigee radius and the angular rate at perigee
+	rp = a * (1 - e);
+	wp = n * (1 + e) * (1 + e) / pow(1 - e*e, 1.5);
+
+	step = pow(384 * SAT_INTERP_MAX_ERR_KM / (rp * wp*wp*wp*wp * SAT_INTERP_SAFETY), 0.25);
+
+	if (step < SAT_INTERP_MIN_STEP)
+		step = SAT_INTERP_MIN_STEP;
+	else if (step > SAT_INTERP_MAX_STEP)
+		step = SAT_INTERP_MAX_STEP;
+
+	return step;
+}
+
+// Return true for a raw TLE of about one revolution per sidereal day
+// that is nearly circular.
+static int sat_is_geo(tle_t *tle)
+{
+	return fabs(tle->xno - omega_E) < 0.01 && tle->eo < 0.01;
+}
+
+// Return the cached solar position, recomputing it if it is more than
+// SAT_SOLAR_STEP seconds away from jul_utc.
+const sat_solar_t *sat_solar(double jul_utc)
+{
+	vector_t zero_vector = {0,0,0,0};
+
+	// Solar observed azi and ele vector
+	vector_t solar_set;
+
+	if (solar_valid && fabs(jul_utc - solar.jul_utc) * secday < SAT_SOLAR_STEP)
+		return &solar;
+
+	Calculate_Solar_Position(jul_utc, &solar.pos);
+	Calculate_Obs(jul_utc, &solar.pos, &zero_vector, &config.observer, &solar_set);
+
+	solar.sun_az = Degrees(solar_set.x);
+	solar.sun_el = Degrees(solar_set.y);
+	solar.jul_utc = jul_utc;
+
+	solar_valid = 1;
+	solar_updates++;
+
+	return &solar;
+}
+
+// Return true if a satellite at ECI position pos (km) is in sunlight at
+// jul_utc and set *depth to its eclipse depth.  Uses the cached solar
+// position so it is cheap enough to run on every tick.
+int sat_sunlit(double jul_utc, vector_t *pos, double *depth)
+{
+	const sat_solar_t *sol = sat_solar(jul_utc);
+	vector_t sat_pos = *pos, sol_pos = sol->pos;
+
+	Magnitude(&sat_pos);
+
+	return !Sat_Eclipsed(&sat_pos, &sol_pos, depth);
+}
+
+// Propagate the tracked satellite to jul_utc and return its ECI position
+// and velocity in km and km/sec.
+static void sat_propagate(double jul_utc, vector_t *pos, vector_t *vel)
+{
+	// Time since epoch in minutes
+	double tsince = (jul_utc - sat->jul_epoch) * 24*60;
+
+	// Call NORAD routines according to deep-space flag
+	if (isFlagSet(DEEP_SPACE_EPHEM_FLAG))
+	{
+		SDP4(tsince, &sat->tle, pos, vel);
+		sat->deep_space = 1;
+	}
+	else
+	{
+#ifdef USE_SGP4F
+		sgp4f(&sgp4f_sat, tsince, pos, vel);
+#else
+		SGP4(tsince, &sat->tle, pos, vel);
+#endif
+		sat->deep_space = 0;
+	}
+
+	// Scale position and velocity vectors to km and km/sec
+	Convert_Sat_State(pos, vel);
+
+	interp.propagations++;
+}
+
+// Calculate the satellite's azimuth, elevation, range and range rate the
+// same way Calculate_Obs() does, and also differentiate the topocentric
+// south-east-zenith vector to get the azimuth and elevation rates.
+static void sat_observe(const sat_tick_t *t, vector_t *pos, vector_t *vel)
+{
+	vector_t obs_pos, obs_vel, range, rgvel, rot;
+
+	double sin_lat, cos_lat, sin_theta, cos_theta,
+		top_s, top_e, top_z, dot_s, dot_e, dot_z,
+		north, horiz2;
+
+	sat_observer_update();
+
+	// Observer's local sidereal angle
+	sin_theta = sin(t->gmst + config.observer.lon);
+	cos_theta = cos(t->gmst + config.observer.lon);
+
+	sin_lat = obs.sin_lat;
+	cos_lat = obs.cos_lat;
+
+	obs_pos.x = obs.rxy * cos_theta;
+	obs_pos.y = obs.rxy * sin_theta;
+	obs_pos.z = obs.z;
+
+	obs_vel.x = -SAT_EARTH_ROTATION * obs_pos.y;
+	obs_vel.y = SAT_EARTH_ROTATION * obs_pos.x;
+	obs_vel.z = 0;
+
+	range.x = pos->x - obs_pos.x;
+	range.y = pos->y - obs_pos.y;
+	range.z = pos->z - obs_pos.z;
+	Magnitude(&range);
+
+	rgvel.x = vel->x - obs_vel.x;
+	rgvel.y = vel->y - obs_vel.y;
+	rgvel.z = vel->z - obs_vel.z;
+
+	// Relative velocity seen from the rotating topocentric frame
+	rot.x = rgvel.x + SAT_EARTH_ROTATION * range.y;
+	rot.y = rgvel.y - SAT_EARTH_ROTATION * range.x;
+	rot.z = rgvel.z;
+
+	top_s = sin_lat*cos_theta*range.x + sin_lat*sin_theta*range.y - cos_lat*range.z;
+	top_e = -sin_theta*range.x + cos_theta*range.y;
+	top_z = cos_lat*cos_theta*range.x + cos_lat*sin_theta*range.y + sin_lat*range.z;
+
+	dot_s = sin_lat*cos_theta*rot.x + sin_lat*sin_theta*rot.y - cos_lat*rot.z;
+	dot_e = -sin_theta*rot.x + cos_theta*rot.y;
+	dot_z = cos_lat*cos_theta*rot.x + cos_lat*sin_theta*rot.y + sin_lat*rot.z;
+
+	north = -top_s;
+	horiz2 = north*north + top_e*top_e;
+
+	sat->sat_az = Degrees(atan2(top_e, north));
+	if (sat->sat_az < 0)
+		sat->sat_az += 360;
+
+	sat->sat_el = Degrees(asin(top_z / range.w));
+
+	// Azimuth is undefined at the zenith so hold it still there.
+	if (horiz2 > 1e-9)
+	{
+		sat->sat_az_rate = Degrees((north*dot_e + top_e*dot_s) / horiz2);
+		sat->sat_el_rate = Degrees((horiz2*dot_z + top_z*(north*dot_s - top_e*dot_e))
+			/ (range.w*range.w*sqrt(horiz2)));
+	}
+	else
+	{
+		sat->sat_az_rate = 0;
+		sat->sat_el_rate = 0;
+	}
+
+	// Range rates for doppler:
+	sat->sat_range = range.w;
+	sat->sat_range_rate = Dot(&range, &rgvel) / range.w;
+
+	// Calculate velocity of satellite
+	Magnitude(vel);
+	sat->sat_vel = vel->w;
+
+	sat->pos = *pos;
+	sat->jul_utc = t->jul_utc;
+
+	// Calculate satellite eclipse depth and the sun's position
+	sat->eclipsed = !sat_sunlit(t->jul_utc, pos, &sat->eclipse_depth);
+	sat->sun_az = solar.sun_az;
+	sat->sun_el = solar.sun_el;
+}
+
+// Propagate both Hermite nodes starting at jul_utc.
+static void sat_interp_fill(double jul_utc)
+{
+	interp.jul[0] = jul_utc;
+	interp.jul[1] = jul_utc + interp.step / secday;
+
+	sat_propagate(interp.jul[0], &interp.pos[0], &interp.vel[0]);
+	sat_propagate(interp.jul[1], &interp.pos[1], &interp.vel[1]);
+
+	interp.valid = 1;
+}
+
+// Slide the nodes forward until jul_utc is between them.  Normally this
+// costs one propagation per step; if the clock jumped then refill.
+static void sat_interp_advance(double jul_utc)
+{
+	if (!interp.valid || jul_utc < interp.jul[0] ||
+		jul_utc > interp.jul[1] + interp.step / secday)
+	{
+		sat_interp_fill(jul_utc);
+		return;
+	}
+
+	while (jul_utc > interp.jul[1])
+	{
+		interp.jul[0] = interp.jul[1];
+		interp.pos[0] = interp.pos[1];
+		interp.vel[0] = interp.vel[1];
+
+		interp.jul[1] = interp.jul[0] + interp.step / secday;
+		sat_propagate(interp.jul[1], &interp.pos[1], &interp.vel[1]);
+	}
+}
+
+// Evaluate the Hermite position and its derivative at jul_utc.
+static void sat_interp_eval(double jul_utc, vector_t *pos, vector_t *vel)
+{
+	double h = interp.step;
+	double t = (jul_utc - interp.jul[0]) * secday / h;
+	double t2 = t*t, t3 = t2*t;
+
+	// Basis functions and their derivatives with respect to t
+	double h00 = 2*t3 - 3*t2 + 1, d00 = 6*t2 - 6*t;
+	double h10 = t3 - 2*t2 + t,   d10 = 3*t2 - 4*t + 1;
+	double h01 = -2*t3 + 3*t2,    d01 = -6*t2 + 6*t;
+	double h11 = t3 - t2,         d11 = 3*t2 - 2*t;
+
+	vector_t *p0 = &interp.pos[0], *p1 = &interp.pos[1],
+		*v0 = &interp.vel[0], *v1 = &interp.vel[1];
+
+	pos->x = h00*p0->x + h10*h*v0->x + h01*p1->x + h11*h*v1->x;
+	pos->y = h00*p0->y + h10*h*v0->y + h01*p1->y + h11*h*v1->y;
+	pos->z = h00*p0->z + h10*h*v0->z + h01*p1->z + h11*h*v1->z;
+
+	vel->x = (d00*p0->x + d01*p1->x)/h + d10*v0->x + d11*v1->x;
+	vel->y = (d00*p0->y + d01*p1->y)/h + d10*v0->y + d11*v1->y;
+	vel->z = (d00*p0->z + d01*p1->z)/h + d10*v0->z + d11*v1->z;
+}
+
+// Geostationary fast path: propagate every SAT_GEO_STEP seconds and
+// extrapolate the look angles from their rates in between.
+static void sat_update_geo(const sat_tick_t *t)
+{
+	vector_t pos, vel;
+	double dt = (t->jul_utc - interp.jul[0]) * secday;
+
+	if (!interp.valid || dt < 0 || dt > SAT_GEO_STEP)
+	{
+		sat_propagate(t->jul_utc, &pos, &vel);
+		sat_observe(t, &pos, &vel);
+
+		interp.jul[0] = t->jul_utc;
+		interp.az = sat->sat_az;
+		interp.el = sat->sat_el;
+		interp.az_rate = sat->sat_az_rate;
+		interp.el_rate = sat->sat_el_rate;
+		interp.valid = 1;
+
+		return;
+	}
+
+	sat->sat_az = fmod(interp.az + interp.az_rate * dt + 360, 360);
+	sat->sat_el = interp.el + interp.el_rate * dt;
+}
+
+// Finish sat_init() once sat->tle has been converted and the ephemeris
+// flags are set
+static const sat_t *sat_start()
+{
+	sat->deep_space = isFlagSet(DEEP_SPACE_EPHEM_FLAG);
+
+#ifdef USE_SGP4F
+	if (!sat->deep_space)
+		sgp4f_init(&sgp4f_sat, &sat->tle);
+#endif
+
+	// Convert satellite's epoch time to Julian once per TLE
+	sat->jul_epoch = Julian_Date_of_Epoch(sat->tle.epoch);
+
+	sat->ready = 1;
+	return sat_update();
+}
+
 const sat_t *sat_init(tle_t *tle)
 {
+	const sat_t *ret;
+
+	sat_lock();
+
 	// Copy the provided tle into our static private satellite structure
 	sat->tle = *tle;
 
@@ -107,6 +566,12 @@ const sat_t *sat_init(tle_t *tle)
 	// flags must be cleared in main().
 	ClearFlag(ALL_FLAGS);
 
+	// The interpolation step is found from the raw TLE, so this
+	// must happen before select_ephemeris() converts it.
+	memset(&interp, 0, sizeof(interp));
+	interp.step = sat_interp_step(&sat->tle);
+	interp.geo = sat_is_geo(&sat->tle);
+
 	// Select ephemeris type:
 	//
 	// Will set or clear the DEEP_SPACE_EPHEM_FLAG
@@ -116,121 +581,111 @@ const sat_t *sat_init(tle_t *tle)
 	// must be called each time a new tle set is used
 	select_ephemeris(&sat->tle);
 
-	sat->ready = 1;
-	return sat_update();
+	ret = sat_start();
+	sat_unlock();
+
+	return ret;
 }
 
-const sat_t *sat_update()
+// Same as sat_init() for a tle.bin record, which carries what
+// select_ephemeris() would work out.  Returns NULL if rec is damaged.
+const sat_t *sat_init_rec(const catalog_rec_t *rec)
 {
-	struct tm utc;
-	struct timeval tv;
-	double
-		tsince,            // Time since epoch (in minutes)g
-		jul_epoch,         // Julian date of epochg
-		jul_utc;           // Julian UTC dateg
-
-	// Satellite's predicted geodetic positiong
-	geodetic_t sat_geodetic;
+	const sat_t *ret;
+	tle_t tle;
 
-	// Zero vector for initializationsg
-	vector_t zero_vector = {0,0,0,0};
+	if (!catalog_unpack(rec, &tle))
+		return NULL;
 
-	// Satellite position and velocity vectorsg
-	vector_t vel = zero_vector;
-	vector_t pos = zero_vector;
-	// Satellite Az, El, Range, Range rateg
-	vector_t obs_set;
+	sat_lock();
 
-	if (! sat->ready)
-		return NULL;
+	memset(&interp, 0, sizeof(interp));
+	interp.step = sat_interp_step(&tle);
+	interp.geo = sat_is_geo(&tle);
 
-	// Get UTC calendar and convert to Juliang
-	UTC_Calendar_Now(&utc, &tv);
-	jul_utc = Julian_Date(&utc, &tv);
+	// Converts the units and sets DEEP_SPACE_EPHEM_FLAG
+	catalog_select(rec, &sat->tle);
 
-	// Convert satellite's epoch time to Juliang
-	// and calculate time since epoch in minutesg
-	jul_epoch = Julian_Date_of_Epoch(sat->tle.epoch);
-	tsince = (jul_utc - jul_epoch) * 24*60; // minutes per day
+	ret = sat_start();
+	sat_unlock();
 
-	// Call NORAD routines according to deep-space flagg
-	if( isFlagSet(DEEP_SPACE_EPHEM_FLAG) )
-	{
-		SDP4(tsince, &sat->tle, &pos, &vel);
-		sat->deep_space = 1;
-	}
-	else
-	{
-		SGP4(tsince, &sat->tle, &pos, &vel);
-		sat->deep_space = 0;
-	}
+	return ret;
+}
 
-	// Scale position and velocity vectors to km and km/sec
-	Convert_Sat_State( &pos, &vel );
+// Propagate with SGP4/SDP4 at the current time without interpolation.
+const sat_t *sat_update_exact()
+{
+	const sat_tick_t *t;
 
-	// Calculate velocity of satellite
-	Magnitude( &vel );
-	sat->sat_vel = vel.w;
+	// Satellite position and velocity vectors
+	vector_t pos, vel;
+
+	if (! sat->ready)
+		return NULL;
 
-	// All angles in rads. Distance in km. Velocity in km/s
-	// Calculate satellite Azi, Ele, Range and Range-rateg
-	Calculate_Obs(jul_utc, &pos, &vel, &config.observer, &obs_set);
+	t = sat_tick_now();
 
-	// Convert and print satellite and solar datag
-	sat->sat_az = Degrees(obs_set.x);
-	sat->sat_el = Degrees(obs_set.y);
+	sat_propagate(t->jul_utc, &pos, &vel);
+	sat_observe(t, &pos, &vel);
 
-	// Range rates for doppler:
-	sat->sat_range = obs_set.z;
-	sat->sat_range_rate = obs_set.w;
+	return sat;
+}
 
-	// Calculate satellite Lat North, Lon East and Alt.g
-	Calculate_LatLonAlt(jul_utc, &pos, &sat_geodetic);
+const sat_t *sat_update()
+{
+	const sat_tick_t *t;
 
-	sat->sat_lat = Degrees(sat_geodetic.lat);
-	sat->sat_long = Degrees(sat_geodetic.lon);
-	sat->sat_alt = sat_geodetic.alt;
+	// Satellite position and velocity vectors
+	vector_t pos, vel;
 
+	if (! sat->ready)
+		return NULL;
 
-	// Disable solar calculations to speed up iteration:
+	if (!config.sat_interp)
+		return sat_update_exact();
 
-	/*
-	// Calculate solar position and satellite eclipse depthg
-	// Also set or clear the satellite eclipsed flag accordingly
-	//
-	// Solar ECI position vectorg
-	vector_t solar_vector = zero_vector;
-	// Solar observed azi and ele vectorg
-	vector_t solar_set;
+	t = sat_tick_now();
 
-	Calculate_Solar_Position(jul_utc, &solar_vector);
-	Calculate_Obs(jul_utc, &solar_vector, &zero_vector, &config.observer, &solar_set);
+	interp.updates++;
 
-	if( Sat_Eclipsed(&pos, &solar_vector, &sat->eclipse_depth) )
-	{
-		SetFlag( SAT_ECLIPSED_FLAG );
-		sat->eclipsed = 1;
-	}
+	if (interp.geo)
+		sat_update_geo(t);
 	else
 	{
-		ClearFlag( SAT_ECLIPSED_FLAG );
-		sat->eclipsed = 0;
+		sat_interp_advance(t->jul_utc);
+		sat_interp_eval(t->jul_utc, &pos, &vel);
+		sat_observe(t, &pos, &vel);
 	}
 
-	sat->sun_az = Degrees(solar_set.x);
-	sat->sun_el = Degrees(solar_set.y);
-	*/
-
 	return sat;
 }
 
+// Calculate satellite Lat North, Lon East and Alt.  This is only needed
+// for display so it is not done on every update.
+static void sat_geodetic()
+{
+	geodetic_t sat_geodetic;
+
+	Calculate_LatLonAlt(sat->jul_utc, &sat->pos, &sat_geodetic);
+
+	sat->sat_lat = Degrees(sat_geodetic.lat);
+	sat->sat_long = Degrees(sat_geodetic.lon);
+	sat->sat_alt = sat_geodetic.alt;
+}
+
 void sat_status()
 {
 	if (! sat->ready)
+	{
 		printf("No satellite is being tracked\r\n");
-	else
-		printf("\r\nTracking %s (%d): %s\r\n"
+		return;
+	}
+
+	sat_geodetic();
+
+	printf("\r\nTracking %s (%d): %s\r\n"
 			"\r\n Azi=%6.1f Ele=%6.1f Range=%8.1f Range Rate=%6.3f km/s"
+			"\r\n Azi Rate=%7.4f Ele Rate=%7.4f deg/s"
 			"\r\n Lat=%6.1f Lon=%6.1f  Alt=%8.1f  Vel=%8.3f"
 			"\r\n Stellite Status: %s - Depth: %2.3f"
 			"\r\n Sun Azi=%6.1f Sun Ele=%6.1f"
@@ -240,6 +695,7 @@ void sat_status()
 			sat->tle.sat_name, sat->tle.catnr,
 				isFlagSet(DEEP_SPACE_EPHEM_FLAG) ? "SDP4" : "SGP4",
 			sat->sat_az, sat->sat_el, sat->sat_range, sat->sat_range_rate,
+			sat->sat_az_rate, sat->sat_el_rate,
 			sat->sat_lat, sat->sat_long, sat->sat_alt, sat->sat_vel,
 			sat->eclipsed ? "eclipsed" : "in sunlight",
 				sat->eclipse_depth,
@@ -252,6 +708,14 @@ void sat_status()
 			config.downlink_mhz * (1+sat->sat_range_rate*1000/299792458) * 1e-6,
 			config.downlink_mhz * (sat->sat_range_rate*1000/299792458) * 1e-3
 			);
+
+	printf(" Interpolation: %s, step=%.1f sec, %u propagations for %u updates\r\n",
+		!config.sat_interp ? "disabled" : (interp.geo ? "geostationary" : "hermite"),
+		interp.geo ? SAT_GEO_STEP : interp.step,
+		interp.propagations, interp.updates);
+
+	printf(" Solar position: %u updates, every %.0f sec\r\n",
+		solar_updates, SAT_SOLAR_STEP);
 }
 
 // tle: the tle object
@@ -289,47 +753,20 @@ int sat_tle_line(tle_t *tle, int line, char *tle_set, char *buf)
 	return line;
 }
 
+// Convert tle.txt to tle.bin.  See catalog.c.
 void sat_tle_to_bin()
 {
-	FRESULT res = FR_OK;  /* API result code */
-	FIL in, out;              /* File object */
-	UINT bw;          /* Bytes written */
-
-	static tle_t tle;
-
-	char buf[128], tle_set[139];
-
-	int i;
-
-	res = f_open(&in, "tle.txt", FA_READ);
-	if (res != FR_OK)
-	{
-		printf("tle.txt: error %d: %s\r\n", res, ff_strerror(res));
-		return;
-	}
-
-	res = f_open(&out, "tle.bin", FA_CREATE_ALWAYS | FA_WRITE);
-	if (res != FR_OK)
-	{
-		printf("tle.bin: error %d: %s\r\n", res, ff_strerror(res));
-		f_close(&in);
-		return;
-	}
-
-	memset(&tle, 0, sizeof(tle));
-	i = 0;
-	while (res == FR_OK && f_gets(buf, 80, &in))
-	{
-		i = sat_tle_line(&tle, i, tle_set, buf);
-		if (i == 0)
-		{
-			res = f_write(&out, &tle, sizeof(tle), &bw);
-			memset(&tle, 0, sizeof(tle));
-		}
-	}
+	catalog_import("tle.txt", "tle.bin", 0);
+}
 
-	f_close(&in);
-	f_close(&out);
+// SGP4() and SDP4() keep their initialization in static state, so after
+// propagating any other TLE call this to switch back to the tracked
+// satellite.  sat->tle has already been converted by select_ephemeris().
+void sat_reselect()
+{
+	ClearFlag(ALL_FLAGS);
+	if (sat->ready && sat->deep_space)
+		SetFlag(DEEP_SPACE_EPHEM_FLAG);
 }
 
 void sat_reset()
@@ -33,8 +33,10 @@
 #include "strutil.h"
 
 // RX ring buffer used internally in the RX interrupt
-// At least 128 byte ring buffer is necessary for xmodem, so set it to 256:
-#define READ_BUF_BITS	8
+// At least 128 byte ring buffer is necessary for xmodem.  1 kB holds about
+// 90 msec at 115200 baud, so transfers can run tracking_update() while they
+// wait for data without dropping characters:
+#define READ_BUF_BITS	10
 #define READ_BUF_SIZE	(1 << READ_BUF_BITS)
 #define READ_BUF_MASK	(READ_BUF_SIZE-1)
 
@@ -106,7 +108,9 @@ void initUsart0(void)
 	// Configure and enable USART0
 	USART_InitAsync(USART0, &init);
 
-	// Enable NVIC USART sources
+	// Enable NVIC USART sources.  RX keeps the highest priority and the
+	// IADC is below it (see iadc.c), so scans never drop a character.
+	NVIC_SetPriority(USART0_RX_IRQn, 0);
 	NVIC_ClearPendingIRQ(USART0_RX_IRQn);
 	NVIC_EnableIRQ(USART0_RX_IRQn);
 	NVIC_ClearPendingIRQ(USART0_TX_IRQn);
@@ -256,7 +260,7 @@ void serial_read(void *s, int len)
 	serial_read_idle(s, len, NULL);
 }
 
-int serial_read_timeout(void *s, int len, float timeout)
+int serial_read_timeout_idle(void *s, int len, float timeout, void (*idle)())
 {
 	int i = 0;
 	unsigned char *p = s;
@@ -274,6 +278,8 @@ int serial_read_timeout(void *s, int len, float timeout)
 			len--;
 			i++;
 		}
+		else if (idle != NULL)
+			idle();
 		else
 			platform_sleep();
 	}
@@ -281,6 +287,11 @@ int serial_read_timeout(void *s, int len, float timeout)
 	return i;
 }
 
+int serial_read_timeout(void *s, int len, float timeout)
+{
+	return serial_read_timeout_idle(s, len, timeout, NULL);
+}
+
 int serial_read_line(char *s, int len)
 {
 	int n = 0;
@@ -0,0 +1,247 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+
+// SGP4/SDP4 verification:
+//
+// Propagates the test satellites from Spacetrack Report #3 and compares
+// them with the position and velocity vectors published in the report,
+// then measures how many propagations per second each propagator runs
+// on this platform.  This goes through the same Convert_Satellite_Data()
+// and select_ephemeris() calls as the TLEs that are tracked, so it checks
+// the sgp4sdp4 integration as well as the models.  Any new propagator
+// can be added to sgp4_verify_props[] and is held to the same baseline.
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "sgp4sdp4.h"
+#include "sgp4f.h"
+#include "sgp4-verify.h"
+
+#include "sat.h"
+#include "rtcc.h"
+
+#define SGP4_VERIFY_POINTS 5
+
+typedef struct {
+	// Two 69-column TLE lines
+	const char *line1, *line2;
+
+	// True if select_ephemeris() must choose SDP4
+	int deep_space;
+
+	// Minutes since epoch and the published position (km) and
+	// velocity (km/sec) at each one
+	double tsince[SGP4_VERIFY_POINTS];
+	double pos[SGP4_VERIFY_POINTS][3];
+	double vel[SGP4_VERIFY_POINTS][3];
+} sgp4_verify_t;
+
+// Test cases from Spacetrack Report #3, Hoots and Roehrich, 1980.
+// Checksums have been added so the lines are valid TLEs.
+static const sgp4_verify_t sgp4_verify_cases[] = {
+	{
+		"1 88888U          80275.98708465  .00073094  13844-3  66816-4 0    87",
+		"2 88888  72.8435 115.9689 0086731  52.6988 110.5714 16.05824518  1058",
+		0,
+		{ 0, 360, 720, 1080, 1440 },
+		{
+			{ 2328.97048951, -5995.22076416,  1719.97067261 },
+			{ 2456.10705566, -6071.93853760,  1222.89727783 },
+			{ 2567.56195068, -6112.50384522,   713.96397400 },
+			{ 2663.09078980, -6115.48229980,   196.39640427 },
+			{ 2742.55133057, -6079.67144775,  -326.38095856 },
+		},
+		{
+			{ 2.91207230, -0.98341546, -7.09081703 },
+			{ 2.67938992, -0.44829041, -7.22879231 },
+			{ 2.44024599,  0.09810869, -7.31995916 },
+			{ 2.19611958,  0.65241995, -7.36282432 },
+			{ 1.94850229,  1.21106251, -7.35619372 },
+		},
+	},
+	{
+		"1 11801U          80230.29629788  .01431103  00000-0  14311-1 0    80",
+		"2 11801  46.7916 230.4354 7318036  47.4722  10.4117  2.28537848    68",
+		1,
+		{ 0, 360, 720, 1080, 1440 },
+		{
+			{  7473.37066650,   428.95261765,   5828.74786377 },
+			{ -3305.22537232, 32410.86328125, -24697.17675781 },
+			{ 14271.28759766, 24110.46411133,  -4725.76837158 },
+			{ -9990.05883789, 22717.35522461, -23616.89062500 },
+			{  9787.86975097, 33753.34667969, -15030.81176758 },
+		},
+		{
+			{  5.10715413,  6.44468284, -0.18613096 },
+			{ -1.30113538, -1.15131518, -0.28333528 },
+			{ -0.32050445,  2.67984074, -2.08405289 },
+			{ -1.01667246, -2.29026759,  0.72892364 },
+			{ -1.09425966,  0.92358845, -1.52230928 },
+		},
+	},
+};
+
+#define SGP4_VERIFY_CASES (sizeof(sgp4_verify_cases) / sizeof(sgp4_verify_cases[0]))
+
+static sgp4f_t sgp4_verify_sgp4f;
+
+// SGP4() and SDP4() initialize themselves on the first call after the
+// flags are cleared.
+static void sgp4_verify_init_sgp4(tle_t *tle)
+{
+	ClearFlag(ALL_FLAGS);
+}
+
+static void sgp4_verify_init_sdp4(tle_t *tle)
+{
+	ClearFlag(ALL_FLAGS);
+	SetFlag(DEEP_SPACE_EPHEM_FLAG);
+}
+
+static void sgp4_verify_init_sgp4f(tle_t *tle)
+{
+	sgp4f_init(&sgp4_verify_sgp4f, tle);
+}
+
+static void sgp4_verify_sgp4f_prop(double tsince, tle_t *tle, vector_t *pos, vector_t *vel)
+{
+	sgp4f(&sgp4_verify_sgp4f, tsince, pos, vel);
+}
+
+static const struct {
+	const char *name;
+
+	// True if this propagator is for deep space satellites
+	int deep_space;
+
+	// init() is called with the tle converted by select_ephemeris()
+	void (*init)(tle_t *tle);
+
+	// Same units as SGP4(): earth radii and earth radii per minute
+	void (*prop)(double tsince, tle_t *tle, vector_t *pos, vector_t *vel);
+} sgp4_verify_props[] = {
+	{ "SGP4",  0, sgp4_verify_init_sgp4,  SGP4 },
+	{ "sgp4f", 0, sgp4_verify_init_sgp4f, sgp4_verify_sgp4f_prop },
+	{ "SDP4",  1, sgp4_verify_init_sdp4,  SDP4 },
+};
+
+#define SGP4_VERIFY_PROPS (sizeof(sgp4_verify_props) / sizeof(sgp4_verify_props[0]))
+
+// Run each propagator that applies to each test case, print the largest
+// position and velocity error against the published vectors and then
+// propagate for sec seconds to measure throughput.
+void sgp4_verify(float sec)
+{
+	const sgp4_verify_t *v;
+	char tle_set[139];
+	tle_t tle;
+	vector_t pos, vel;
+
+	double dp, dv, max_dp, max_dv, tsince;
+	uint64_t start;
+	float elapsed;
+	long n;
+	int i, j, k, deep;
+
+	printf("PROP  [CAT #]  MAX POS ERR (m)  MAX VEL ERR (mm/s)    PROP/SEC\r\n");
+	printf("=============================================================\r\n");
+
+	for (i = 0; i < SGP4_VERIFY_CASES; i++)
+	{
+		v = &sgp4_verify_cases[i];
+
+		memset(&tle, 0, sizeof(tle));
+		strncpy(tle_set, v->line1, 69);
+		strncpy(tle_set+69, v->line2, 69);
+		tle_set[138] = 0;
+
+		if (!Good_Elements(tle_set))
+			printf("[%.5s] failed Good_Elements()\r\n", v->line1 + 2);
+
+		Convert_Satellite_Data(tle_set, &tle);
+
+		// The propagators keep their state in globals shared with
+		// tracking
+		sat_lock();
+
+		ClearFlag(ALL_FLAGS);
+		select_ephemeris(&tle);
+
+		deep = isFlagSet(DEEP_SPACE_EPHEM_FLAG) ? 1 : 0;
+		if (deep != v->deep_space)
+			printf("[%5d] select_ephemeris() chose %s, expected %s\r\n",
+				tle.catnr, deep ? "SDP4" : "SGP4",
+				v->deep_space ? "SDP4" : "SGP4");
+
+		for (j = 0; j < SGP4_VERIFY_PROPS; j++)
+		{
+			if (sgp4_verify_props[j].deep_space != v->deep_space)
+				continue;
+
+			sgp4_verify_props[j].init(&tle);
+
+			max_dp = 0;
+			max_dv = 0;
+			for (k = 0; k < SGP4_VERIFY_POINTS; k++)
+			{
+				sgp4_verify_props[j].prop(v->tsince[k], &tle, &pos, &vel);
+				Convert_Sat_State(&pos, &vel);
+
+				dp = sqrt(pow(pos.x - v->pos[k][0], 2) +
+					pow(pos.y - v->pos[k][1], 2) +
+					pow(pos.z - v->pos[k][2], 2));
+				dv = sqrt(pow(vel.x - v->vel[k][0], 2) +
+					pow(vel.y - v->vel[k][1], 2) +
+					pow(vel.z - v->vel[k][2], 2));
+
+				if (dp > max_dp)
+					max_dp = dp;
+				if (dv > max_dv)
+					max_dv = dv;
+			}
+
+			// Throughput over one day of one-minute steps, repeated
+			// until sec seconds have passed.
+			n = 0;
+			tsince = 0;
+			start = rtcc_get();
+			do
+			{
+				for (k = 0; k < 100; k++)
+				{
+					sgp4_verify_props[j].prop(tsince, &tle, &pos, &vel);
+					tsince = tsince >= 1440 ? 0 : tsince + 1;
+				}
+				n += k;
+				elapsed = rtcc_elapsed_sec(start);
+			} while (elapsed < sec);
+
+			printf("%-5s [%5d] %16.3f %19.3f %11.0f\r\n",
+				sgp4_verify_props[j].name, tle.catnr,
+				max_dp * 1000, max_dv * 1e6, n / elapsed);
+		}
+
+		sat_reselect();
+		sat_unlock();
+	}
+}
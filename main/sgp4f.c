@@ -0,0 +1,413 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+
+// Single-precision SGP4:
+//
+// This is the near-earth SGP4 model from Spacetrack Report #3, the same
+// as SGP4() in sgp4sdp4, but evaluated in float.  The EFR32MG21 only has
+// a single-precision FPU and the ESP32-C6 has none, so doubles are much
+// more expensive than floats on both.  Double is only kept where it is
+// needed: the time since epoch and the angles it accumulates into, which
+// grow to hundreds of radians after a few days and would otherwise
+// lose several kilometers along track.
+//
+// Define USE_SGP4F at build time to use it for tracking near-earth
+// satellites, and run `sat sgp4f` first to see how far it departs from
+// the double version for your catalog.
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "sgp4sdp4.h"
+#include "sgp4f.h"
+
+#include "sat.h"
+#include "catalog.h"
+#include "serial.h"
+#include "config.h"
+
+// SGP4 constants in earth radii and minutes, from sgp4sdp4
+#define SGP4F_XKE     7.43669161E-2f
+#define SGP4F_CK2     5.413079E-4f
+#define SGP4F_CK4     6.209887E-7f
+#define SGP4F_XJ3     -2.53881E-6f
+#define SGP4F_QOMS2T  1.880279E-09f
+#define SGP4F_S       1.012229f
+#define SGP4F_XKMPER  6.378135E3f
+#define SGP4F_TOTHRD  (2.0f/3.0f)
+#define SGP4F_E6A     1.0E-6f
+#define SGP4F_TWOPI   6.283185307179586
+
+// Initialize sgp from a tle that has been converted by select_ephemeris().
+// This is done in double once per TLE.
+void sgp4f_init(sgp4f_t *sgp, tle_t *tle)
+{
+	double a1, ao, betao, betao2, c1sq, c2, c3, coef, coef1, del1, delo,
+		eeta, eosq, etasq, perigee, pinvsq, psisq, qoms24, s4, temp,
+		temp1, temp2, temp3, theta2, theta4, tsi, a3ovk2, x1m5th, xhdot1,
+		aodp, c1, cosio, sinio, eta, x3thm1;
+
+	memset(sgp, 0, sizeof(*sgp));
+
+	// Recover original mean motion (xnodp) and semimajor axis (aodp)
+	// from input elements.
+	a1 = pow(SGP4F_XKE/tle->xno, 2.0/3.0);
+	cosio = cos(tle->xincl);
+	theta2 = cosio*cosio;
+	x3thm1 = 3*theta2-1.0;
+	eosq = tle->eo*tle->eo;
+	betao2 = 1-eosq;
+	betao = sqrt(betao2);
+	del1 = 1.5*SGP4F_CK2*x3thm1/(a1*a1*betao*betao2);
+	ao = a1*(1-del1*(0.5*(2.0/3.0)+del1*(1+134.0/81*del1)));
+	delo = 1.5*SGP4F_CK2*x3thm1/(ao*ao*betao*betao2);
+	sgp->xnodp = tle->xno/(1+delo);
+	aodp = ao/(1-delo);
+
+	// For perigee less than 220 kilometers the equations are truncated
+	// to linear variation in sqrt a and quadratic variation in mean
+	// anomaly.  Also, the c3 term, the delta omega term, and the delta m
+	// term are dropped.
+	sgp->simple = (aodp*(1-tle->eo)) < (220/SGP4F_XKMPER+1);
+
+	// For perigee below 156 km, the values of s and qoms2t are altered.
+	s4 = SGP4F_S;
+	qoms24 = SGP4F_QOMS2T;
+	perigee = (aodp*(1-tle->eo)-1)*SGP4F_XKMPER;
+	if (perigee < 156)
+	{
+		if (perigee <= 98)
+			s4 = 20;
+		else
+			s4 = perigee-78;
+		qoms24 = pow((120-s4)/SGP4F_XKMPER, 4);
+		s4 = s4/SGP4F_XKMPER+1;
+	}
+
+	pinvsq = 1/(aodp*aodp*betao2*betao2);
+	tsi = 1/(aodp-s4);
+	eta = aodp*tle->eo*tsi;
+	etasq = eta*eta;
+	eeta = tle->eo*eta;
+	psisq = fabs(1-etasq);
+	coef = qoms24*pow(tsi, 4);
+	coef1 = coef/pow(psisq, 3.5);
+	c2 = coef1*sgp->xnodp*(aodp*(1+1.5*etasq+eeta*(4+etasq))+
+		0.75*SGP4F_CK2*tsi/psisq*x3thm1*(8+3*etasq*(8+etasq)));
+	c1 = tle->bstar*c2;
+	sinio = sin(tle->xincl);
+	a3ovk2 = -SGP4F_XJ3/SGP4F_CK2;
+	c3 = coef*tsi*a3ovk2*sgp->xnodp*sinio/tle->eo;
+	sgp->x1mth2 = 1-theta2;
+	sgp->c4 = 2*sgp->xnodp*coef1*aodp*betao2*(eta*(2+0.5*etasq)+
+		tle->eo*(0.5+2*etasq)-2*SGP4F_CK2*tsi/(aodp*psisq)*
+		(-3*x3thm1*(1-2*eeta+etasq*(1.5-0.5*eeta))+0.75*
+		sgp->x1mth2*(2*etasq-eeta*(1+etasq))*cos(2*tle->omegao)));
+	sgp->c5 = 2*coef1*aodp*betao2*(1+2.75*(etasq+eeta)+eeta*etasq);
+	theta4 = theta2*theta2;
+	temp1 = 3*SGP4F_CK2*pinvsq*sgp->xnodp;
+	temp2 = temp1*SGP4F_CK2*pinvsq;
+	temp3 = 1.25*SGP4F_CK4*pinvsq*pinvsq*sgp->xnodp;
+	sgp->xmdot = sgp->xnodp+0.5*temp1*betao*x3thm1+
+		0.0625*temp2*betao*(13-78*theta2+137*theta4);
+	x1m5th = 1-5*theta2;
+	sgp->omgdot = -0.5*temp1*x1m5th+0.0625*temp2*(7-114*theta2+
+		395*theta4)+temp3*(3-36*theta2+49*theta4);
+	xhdot1 = -temp1*cosio;
+	sgp->xnodot = xhdot1+(0.5*temp2*(4-19*theta2)+
+		2*temp3*(3-7*theta2))*cosio;
+	sgp->omgcof = tle->bstar*c3*cos(tle->omegao);
+	sgp->xmcof = -(2.0/3.0)*coef*tle->bstar/eeta;
+	sgp->xnodcf = 3.5*betao2*xhdot1*c1;
+	sgp->t2cof = 1.5*c1;
+	sgp->xlcof = 0.125*a3ovk2*sinio*(3+5*cosio)/(1+cosio);
+	sgp->aycof = 0.25*a3ovk2*sinio;
+	sgp->delmo = pow(1+eta*cos(tle->xmo), 3);
+	sgp->sinmo = sin(tle->xmo);
+	sgp->x7thm1 = 7*theta2-1;
+
+	if (!sgp->simple)
+	{
+		double d2, d3, d4;
+
+		c1sq = c1*c1;
+		d2 = 4*aodp*tsi*c1sq;
+		temp = d2*tsi*c1/3;
+		d3 = (17*aodp+s4)*temp;
+		d4 = 0.5*temp*aodp*tsi*(221*aodp+31*s4)*c1;
+		sgp->d2 = d2;
+		sgp->d3 = d3;
+		sgp->d4 = d4;
+		sgp->t3cof = d2+2*c1sq;
+		sgp->t4cof = 0.25*(3*d3+c1*(12*d2+10*c1sq));
+		sgp->t5cof = 0.2*(3*d4+12*c1*d3+6*d2*d2+15*c1sq*(2*d2+c1sq));
+	}
+
+	sgp->xmo = tle->xmo;
+	sgp->omegao = tle->omegao;
+	sgp->xnodeo = tle->xnodeo;
+	sgp->eo = tle->eo;
+	sgp->xincl = tle->xincl;
+	sgp->bstar = tle->bstar;
+	sgp->aodp = aodp;
+	sgp->c1 = c1;
+	sgp->cosio = cosio;
+	sgp->sinio = sinio;
+	sgp->eta = eta;
+	sgp->x3thm1 = x3thm1;
+}
+
+// Propagate to tsince minutes from epoch.  Position and velocity are in
+// earth radii and earth radii per minute, the same as SGP4(), so pass
+// them through Convert_Sat_State() for km and km/sec.
+void sgp4f(sgp4f_t *sgp, double tsince, vector_t *pos, vector_t *vel)
+{
+	double xmdf, omgadf, xnoddf, omega, xmp, xnode, xl, capu;
+
+	float cosuk, sinuk, rfdotk, vx, vy, vz, ux, uy, uz, xmy, xmx,
+		cosnok, sinnok, cosik, sinik, rdotk, xinck, xnodek, uk,
+		rk, cos2u, sin2u, u, sinu, cosu, betal, rfdot, rdot, r, pl,
+		elsq, esine, ecose, epw, cosepw, sinepw, ayn, aynl, xll,
+		axn, xn, beta, e, a, tsq, tcube, tfour, delm, delomg,
+		templ, tempe, tempa, temp, temp1, temp2, temp3, temp4,
+		temp5, temp6, tf;
+
+	int i;
+
+	tf = tsince;
+
+	// Update for secular gravity and atmospheric drag.
+	xmdf = sgp->xmo+sgp->xmdot*tsince;
+	omgadf = sgp->omegao+sgp->omgdot*tsince;
+	xnoddf = sgp->xnodeo+sgp->xnodot*tsince;
+	omega = omgadf;
+	xmp = xmdf;
+	tsq = tf*tf;
+	xnode = xnoddf+sgp->xnodcf*tsince*tsince;
+	tempa = 1-sgp->c1*tf;
+	tempe = sgp->bstar*sgp->c4*tf;
+	templ = sgp->t2cof*tsq;
+	if (!sgp->simple)
+	{
+		delomg = sgp->omgcof*tf;
+		temp = 1+sgp->eta*cosf(xmdf);
+		delm = sgp->xmcof*(temp*temp*temp-sgp->delmo);
+		temp = delomg+delm;
+		xmp = xmdf+temp;
+		omega = omgadf-temp;
+		tcube = tsq*tf;
+		tfour = tf*tcube;
+		tempa = tempa-sgp->d2*tsq-sgp->d3*tcube-sgp->d4*tfour;
+		tempe = tempe+sgp->bstar*sgp->c5*(sinf(xmp)-sgp->sinmo);
+		templ = templ+sgp->t3cof*tcube+tfour*(sgp->t4cof+tf*sgp->t5cof);
+	}
+
+	a = sgp->aodp*tempa*tempa;
+	e = sgp->eo-tempe;
+	xl = xmp+omega+xnode+sgp->xnodp*templ;
+	beta = sqrtf(1-e*e);
+	xn = SGP4F_XKE/(a*sqrtf(a));
+
+	// Long period periodics
+	axn = e*cosf(omega);
+	temp = 1/(a*beta*beta);
+	xll = temp*sgp->xlcof*axn;
+	aynl = temp*sgp->aycof;
+	ayn = e*sinf(omega)+aynl;
+
+	// Solve Kepler's Equation.  The angles are reduced to one revolution
+	// in double before dropping to float.
+	capu = fmod(xl+xll-xnode, SGP4F_TWOPI);
+	if (capu < 0)
+		capu += SGP4F_TWOPI;
+
+	temp2 = capu;
+	for (i = 0; i < 10; i++)
+	{
+		sinepw = sinf(temp2);
+		cosepw = cosf(temp2);
+		temp3 = axn*sinepw;
+		temp4 = ayn*cosepw;
+		temp5 = axn*cosepw;
+		temp6 = ayn*sinepw;
+		epw = ((float)capu-temp4+temp3-temp2)/(1-temp5-temp6)+temp2;
+		if (fabsf(epw-temp2) <= SGP4F_E6A)
+			break;
+		temp2 = epw;
+	}
+
+	// Short period preliminary quantities
+	ecose = temp5+temp6;
+	esine = temp3-temp4;
+	elsq = axn*axn+ayn*ayn;
+	temp = 1-elsq;
+	pl = a*temp;
+	r = a*(1-ecose);
+	temp1 = 1/r;
+	rdot = SGP4F_XKE*sqrtf(a)*esine*temp1;
+	rfdot = SGP4F_XKE*sqrtf(pl)*temp1;
+	temp2 = a*temp1;
+	betal = sqrtf(temp);
+	temp3 = 1/(1+betal);
+	cosu = temp2*(cosepw-axn+ayn*esine*temp3);
+	sinu = temp2*(sinepw-ayn-axn*esine*temp3);
+	u = atan2f(sinu, cosu);
+	sin2u = 2*sinu*cosu;
+	cos2u = 2*cosu*cosu-1;
+	temp = 1/pl;
+	temp1 = SGP4F_CK2*temp;
+	temp2 = temp1*temp;
+
+	// Update for short periodics
+	rk = r*(1-1.5f*temp2*betal*sgp->x3thm1)+0.5f*temp1*sgp->x1mth2*cos2u;
+	uk = u-0.25f*temp2*sgp->x7thm1*sin2u;
+	xnodek = fmod(xnode, SGP4F_TWOPI)+1.5f*temp2*sgp->cosio*sin2u;
+	xinck = sgp->xincl+1.5f*temp2*sgp->cosio*sgp->sinio*cos2u;
+	rdotk = rdot-xn*temp1*sgp->x1mth2*sin2u;
+	rfdotk = rfdot+xn*temp1*(sgp->x1mth2*cos2u+1.5f*sgp->x3thm1);
+
+	// Orientation vectors
+	sinuk = sinf(uk);
+	cosuk = cosf(uk);
+	sinik = sinf(xinck);
+	cosik = cosf(xinck);
+	sinnok = sinf(xnodek);
+	cosnok = cosf(xnodek);
+	xmx = -sinnok*cosik;
+	xmy = cosnok*cosik;
+	ux = xmx*sinuk+cosnok*cosuk;
+	uy = xmy*sinuk+sinnok*cosuk;
+	uz = sinik*sinuk;
+	vx = xmx*cosuk-cosnok*sinuk;
+	vy = xmy*cosuk-sinnok*sinuk;
+	vz = sinik*cosuk;
+
+	// Position and velocity
+	pos->x = rk*ux;
+	pos->y = rk*uy;
+	pos->z = rk*uz;
+	vel->x = rdotk*ux+rfdotk*vx;
+	vel->y = rdotk*uy+rfdotk*vy;
+	vel->z = rdotk*uz+rfdotk*vz;
+}
+
+// Propagate every near-earth satellite in tle.bin with both SGP4() and
+// sgp4f() every step_min minutes over +/- days around its epoch and
+// report the largest position error and the largest error in the
+// direction seen from the observer while the satellite is above the
+// horizon.  Damaged records are skipped.  Press any key to stop early.
+void sgp4f_check(double days, double step_min)
+{
+	catalog_rec_t buf;
+	const catalog_rec_t *rec;
+
+	tle_t tle;
+	sgp4f_t sgp;
+	geodetic_t obs_geo = config.observer;
+	vector_t pos, vel, posf, velf, obs_pos, obs_vel, obs_set, zero = {0};
+
+	double tsince, jul_epoch, jul, err, dot, rd, rf, ang;
+	double max_err, max_ang, all_err = 0, all_ang = 0;
+	int n = 0, skipped = 0, i = 0, c = -1;
+
+	if (step_min <= 0)
+		step_min = 1;
+
+	if (catalog_get(0, &buf) == NULL)
+	{
+		printf("tle.bin: no satellites\r\n");
+		return;
+	}
+
+	printf("Comparing sgp4f with SGP4 over +/- %.1f days every %.1f minutes\r\n",
+		days, step_min);
+	printf("  n. [CAT #] SATELLITE                 MAX KM   MAX DEG\r\n");
+	printf("======================================================\r\n");
+
+	while (c == -1 && (rec = catalog_get(i, &buf)) != NULL)
+	{
+		i++;
+
+		if (!catalog_rec_valid(rec) || (rec->flags & CATALOG_REC_DEEP))
+		{
+			skipped++;
+			continue;
+		}
+
+		// SGP4() keeps its state in globals shared with tracking
+		sat_lock();
+		catalog_select(rec, &tle);
+
+		sgp4f_init(&sgp, &tle);
+		jul_epoch = Julian_Date_of_Epoch(tle.epoch);
+
+		max_err = 0;
+		max_ang = 0;
+		for (tsince = -days*1440; tsince <= days*1440 && c == -1; tsince += step_min)
+		{
+			SGP4(tsince, &tle, &pos, &vel);
+			sgp4f(&sgp, tsince, &posf, &velf);
+			Convert_Sat_State(&pos, &vel);
+			Convert_Sat_State(&posf, &velf);
+
+			err = sqrt((pos.x-posf.x)*(pos.x-posf.x) +
+				(pos.y-posf.y)*(pos.y-posf.y) +
+				(pos.z-posf.z)*(pos.z-posf.z));
+			if (err > max_err)
+				max_err = err;
+
+			jul = jul_epoch + tsince/1440;
+			Calculate_Obs(jul, &pos, &zero, &obs_geo, &obs_set);
+			if (obs_set.y > 0)
+			{
+				// Angle between the two observer-to-satellite vectors
+				Calculate_User_PosVel(jul, &obs_geo, &obs_pos, &obs_vel);
+				pos.x -= obs_pos.x; pos.y -= obs_pos.y; pos.z -= obs_pos.z;
+				posf.x -= obs_pos.x; posf.y -= obs_pos.y; posf.z -= obs_pos.z;
+				rd = sqrt(pos.x*pos.x + pos.y*pos.y + pos.z*pos.z);
+				rf = sqrt(posf.x*posf.x + posf.y*posf.y + posf.z*posf.z);
+				dot = (pos.x*posf.x + pos.y*posf.y + pos.z*posf.z) / (rd*rf);
+				ang = Degrees(acos(fmin(dot, 1)));
+				if (ang > max_ang)
+					max_ang = ang;
+			}
+
+			c = serial_read_char();
+		}
+
+		sat_reselect();
+		sat_unlock();
+
+		printf("%3d. [%5d] %-24s %8.3f %9.5f\r\n",
+			i, tle.catnr, tle.sat_name, max_err, max_ang);
+
+		if (max_err > all_err)
+			all_err = max_err;
+		if (max_ang > all_ang)
+			all_ang = max_ang;
+		n++;
+	}
+
+	printf("\r\n%d satellites checked, %d deep space or damaged skipped\r\n", n, skipped);
+	printf("Max position error %.3f km, max pointing error %.5f degrees\r\n",
+		all_err, all_ang);
+}
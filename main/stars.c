@@ -1,2633 +1,316 @@
-// http://www.icc.dur.ac.uk/~tt/Lectures/Galaxies/LocalGroup/Back/stars.html
-
-
 #include <math.h> // for NAN
+#include <stddef.h>
+#include <string.h>
 
 #include "stars.h"
 
-// Making this constant keeps ~20k of heap available,
-// but the structure is read-only because it is stored
-// in flash.
-const star_t stars[] = {
-	{
-		.name = "Alpha Canis Majoris (Sirius)",
-		.spec_type = "A1V",
-		.ra = 6.75,
-		.dec = -16.7,
-		.gal_lat = -8.9,
-		.gal_long = 227.2,
-		.mag_vis = -1.44,
-		.mag_abs = 1.45,
-		.hip_parlx = 379.21,
-		.hip_parlx_err = 1.58,
-		.dist_ly = 9,
-	},
-	{
-		.name = "Alpha Carinae (Canopus)",
-		.spec_type = "F0Ib",
-		.ra = 6.4,
-		.dec = -52.7,
-		.gal_lat = -25.3,
-		.gal_long = 261.2,
-		.mag_vis = -0.62,
-		.mag_abs = -5.53,
-		.hip_parlx = 10.43,
-		.hip_parlx_err = 0.53,
-		.dist_ly = 310,
-	},
-	{
-		.name = "Alpha Centauri (Rigil Kentaurus)",
-		.spec_type = "G2V+K1V",
-		.ra = 14.6666666666667,
-		.dec = -60.8,
-		.gal_lat = -0.7,
-		.gal_long = 315.8,
-		.mag_vis = -0.27,
-		.mag_abs = 4.08,
-		.hip_parlx = 742.12,
-		.hip_parlx_err = 1.4,
-		.dist_ly = 4,
-	},
-	{
-		.name = "Alpha Bootis (Arcturus)",
-		.spec_type = "K2III",
-		.ra = 14.2666666666667,
-		.dec = 19.2,
-		.gal_lat = 69,
-		.gal_long = 15.2,
-		.mag_vis = -0.05,
-		.mag_abs = -0.31,
-		.hip_parlx = 88.85,
-		.hip_parlx_err = 0.74,
-		.dist_ly = 37,
-	},
-	{
-		.name = "Alpha Lyrae (Vega)",
-		.spec_type = "A0V",
-		.ra = 18.6166666666667,
-		.dec = 38.8,
-		.gal_lat = 19.2,
-		.gal_long = 67.5,
-		.mag_vis = 0.03,
-		.mag_abs = 0.58,
-		.hip_parlx = 128.93,
-		.hip_parlx_err = 0.55,
-		.dist_ly = 25,
-	},
-	{
-		.name = "Alpha Aurigae (Capella)",
-		.spec_type = "G5III+G0III",
-		.ra = 5.28333333333333,
-		.dec = 46,
-		.gal_lat = 4.6,
-		.gal_long = 162.6,
-		.mag_vis = 0.08,
-		.mag_abs = -0.48,
-		.hip_parlx = 77.29,
-		.hip_parlx_err = 0.89,
-		.dist_ly = 42,
-	},
-	{
-		.name = "Beta Orionis (Rigel)",
-		.spec_type = "B8Ia",
-		.ra = 5.25,
-		.dec = -8.2,
-		.gal_lat = -25.1,
-		.gal_long = 209.3,
-		.mag_vis = 0.18,
-		.mag_abs = -6.69,
-		.hip_parlx = 4.22,
-		.hip_parlx_err = 0.81,
-		.dist_ly = 770,
-	},
-	{
-		.name = "Alpha Canis Minoris (Procyon)",
-		.spec_type = "F5IV-V",
-		.ra = 7.65,
-		.dec = 5.2,
-		.gal_lat = 13,
-		.gal_long = 213.7,
-		.mag_vis = 0.4,
-		.mag_abs = 2.68,
-		.hip_parlx = 285.93,
-		.hip_parlx_err = 0.88,
-		.dist_ly = 11,
-	},
-	{
-		.name = "Alpha Eridani (Achernar)",
-		.spec_type = "B3V",
-		.ra = 1.63333333333333,
-		.dec = -57.2,
-		.gal_lat = -58.8,
-		.gal_long = 290.7,
-		.mag_vis = 0.45,
-		.mag_abs = -2.77,
-		.hip_parlx = 22.68,
-		.hip_parlx_err = 0.57,
-		.dist_ly = 144,
-	},
-	{
-		.name = "Alpha Orionis (Betelgeuse)",
-		.spec_type = "M2Ib",
-		.ra = 5.91666666666667,
-		.dec = 7.4,
-		.gal_lat = -9,
-		.gal_long = 199.8,
-		.mag_vis = 0.45,
-		.mag_abs = -5.14,
-		.hip_parlx = 7.63,
-		.hip_parlx_err = 1.64,
-		.dist_ly = 430,
-	},
-	{
-		.name = "Beta Centauri (Hadar)",
-		.spec_type = "B1III",
-		.ra = 14.0666666666667,
-		.dec = -60.4,
-		.gal_lat = 1.2,
-		.gal_long = 311.8,
-		.mag_vis = 0.61,
-		.mag_abs = -5.42,
-		.hip_parlx = 6.21,
-		.hip_parlx_err = 0.56,
-		.dist_ly = 530,
-	},
-	{
-		.name = "Alpha Aquilae (Altair)",
-		.spec_type = "A7V",
-		.ra = 19.85,
-		.dec = 8.9,
-		.gal_lat = -9,
-		.gal_long = 47.8,
-		.mag_vis = 0.76,
-		.mag_abs = 2.2,
-		.hip_parlx = 194.44,
-		.hip_parlx_err = 0.94,
-		.dist_ly = 17,
-	},
-	{
-		.name = "Alpha Crucis (Acrux)",
-		.spec_type = "B0.5IV+B1V",
-		.ra = 12.45,
-		.dec = -63.1,
-		.gal_lat = -0.4,
-		.gal_long = 300.2,
-		.mag_vis = 0.77,
-		.mag_abs = -4.19,
-		.hip_parlx = 10.17,
-		.hip_parlx_err = 0.67,
-		.dist_ly = 320,
-	},
-	{
-		.name = "Alpha Tauri (Aldebaran)",
-		.spec_type = "K5III",
-		.ra = 4.6,
-		.dec = 16.5,
-		.gal_lat = -20.2,
-		.gal_long = 181,
-		.mag_vis = 0.87,
-		.mag_abs = -0.63,
-		.hip_parlx = 50.09,
-		.hip_parlx_err = 0.95,
-		.dist_ly = 65,
-	},
-	{
-		.name = "Alpha Virginis (Spica)",
-		.spec_type = "B1V+B2V",
-		.ra = 13.4166666666667,
-		.dec = -11.2,
-		.gal_lat = 50.8,
-		.gal_long = 316.1,
-		.mag_vis = 0.98,
-		.mag_abs = -3.55,
-		.hip_parlx = 12.44,
-		.hip_parlx_err = 0.86,
-		.dist_ly = 260,
-	},
-	{
-		.name = "Alpha Scorpii (Antares)",
-		.spec_type = "M1Ib+B4V",
-		.ra = 16.4833333333333,
-		.dec = -26.4,
-		.gal_lat = 15.1,
-		.gal_long = 351.9,
-		.mag_vis = 1.06,
-		.mag_abs = -5.28,
-		.hip_parlx = 5.4,
-		.hip_parlx_err = 1.68,
-		.dist_ly = 600,
-	},
-	{
-		.name = "Beta Geminorum (Pollux)",
-		.spec_type = "K0III",
-		.ra = 7.75,
-		.dec = 28,
-		.gal_lat = 23.3,
-		.gal_long = 192.2,
-		.mag_vis = 1.16,
-		.mag_abs = 1.09,
-		.hip_parlx = 96.74,
-		.hip_parlx_err = 0.87,
-		.dist_ly = 34,
-	},
-	{
-		.name = "Alpha Piscis Austrini (Fomalhaut)",
-		.spec_type = "A3V",
-		.ra = 22.9666666666667,
-		.dec = -29.6,
-		.gal_lat = -65,
-		.gal_long = 20.6,
-		.mag_vis = 1.17,
-		.mag_abs = 1.74,
-		.hip_parlx = 130.08,
-		.hip_parlx_err = 0.92,
-		.dist_ly = 25,
-	},
-	{
-		.name = "Beta Crucis (Mimosa)",
-		.spec_type = "B0.5III",
-		.ra = 12.8,
-		.dec = -59.7,
-		.gal_lat = 3.2,
-		.gal_long = 302.5,
-		.mag_vis = 1.25,
-		.mag_abs = -3.92,
-		.hip_parlx = 9.25,
-		.hip_parlx_err = 0.61,
-		.dist_ly = 350,
-	},
-	{
-		.name = "Alpha Cygni (Deneb)",
-		.spec_type = "A2Ia",
-		.ra = 20.6833333333333,
-		.dec = 45.3,
-		.gal_lat = 2.1,
-		.gal_long = 84.3,
-		.mag_vis = 1.25,
-		.mag_abs = -8.73,
-		.hip_parlx = 1.01,
-		.hip_parlx_err = 0.57,
-		.dist_ly = 3000,
-	},
-	{
-		.name = "Alpha Leonis (Regulus)",
-		.spec_type = "B7V",
-		.ra = 10.1333333333333,
-		.dec = 12,
-		.gal_lat = 48.9,
-		.gal_long = 226.3,
-		.mag_vis = 1.36,
-		.mag_abs = -0.52,
-		.hip_parlx = 42.09,
-		.hip_parlx_err = 0.79,
-		.dist_ly = 78,
-	},
-	{
-		.name = "Epsilon Canis Majoris (Adhara)",
-		.spec_type = "B2II",
-		.ra = 6.98333333333333,
-		.dec = -29,
-		.gal_lat = -11.3,
-		.gal_long = 239.9,
-		.mag_vis = 1.5,
-		.mag_abs = -4.1,
-		.hip_parlx = 7.57,
-		.hip_parlx_err = 0.57,
-		.dist_ly = 430,
-	},
-	{
-		.name = "Alpha Geminorum (Castor)",
-		.spec_type = "A1V+A2V",
-		.ra = 7.58333333333333,
-		.dec = 31.9,
-		.gal_lat = 22.6,
-		.gal_long = 187.5,
-		.mag_vis = 1.58,
-		.mag_abs = 0.59,
-		.hip_parlx = 63.27,
-		.hip_parlx_err = 1.23,
-		.dist_ly = 52,
-	},
-	{
-		.name = "Gamma Crucis (Gacrux)",
-		.spec_type = "M3.5III",
-		.ra = 12.5166666666667,
-		.dec = -57.1,
-		.gal_lat = 5.7,
-		.gal_long = 300.2,
-		.mag_vis = 1.59,
-		.mag_abs = -0.56,
-		.hip_parlx = 37.09,
-		.hip_parlx_err = 0.67,
-		.dist_ly = 88,
-	},
-	{
-		.name = "Lambda Scorpii (Shaula)",
-		.spec_type = "B2IV",
-		.ra = 17.5666666666667,
-		.dec = -37.1,
-		.gal_lat = -2.3,
-		.gal_long = 351.8,
-		.mag_vis = 1.62,
-		.mag_abs = -5.05,
-		.hip_parlx = 4.64,
-		.hip_parlx_err = 0.9,
-		.dist_ly = 700,
-	},
-	{
-		.name = "Gamma Orionis (Bellatrix)",
-		.spec_type = "B2III",
-		.ra = 5.41666666666667,
-		.dec = 6.3,
-		.gal_lat = -16,
-		.gal_long = 197,
-		.mag_vis = 1.64,
-		.mag_abs = -2.72,
-		.hip_parlx = 13.42,
-		.hip_parlx_err = 0.98,
-		.dist_ly = 240,
-	},
-	{
-		.name = "Beta Tauri (Elnath)",
-		.spec_type = "B7III",
-		.ra = 5.43333333333333,
-		.dec = 28.6,
-		.gal_lat = -3.8,
-		.gal_long = 178,
-		.mag_vis = 1.65,
-		.mag_abs = -1.37,
-		.hip_parlx = 24.89,
-		.hip_parlx_err = 0.88,
-		.dist_ly = 130,
-	},
-	{
-		.name = "Beta Carinae (Miaplacidus)",
-		.spec_type = "A2III",
-		.ra = 9.21666666666667,
-		.dec = -69.7,
-		.gal_lat = -14.4,
-		.gal_long = 286,
-		.mag_vis = 1.67,
-		.mag_abs = -0.99,
-		.hip_parlx = 29.34,
-		.hip_parlx_err = 0.47,
-		.dist_ly = 111,
-	},
-	{
-		.name = "Epsilon Orionis (Alnilam)",
-		.spec_type = "B0Ia",
-		.ra = 5.6,
-		.dec = -1.2,
-		.gal_lat = -17.3,
-		.gal_long = 205.2,
-		.mag_vis = 1.69,
-		.mag_abs = -6.38,
-		.hip_parlx = 2.43,
-		.hip_parlx_err = 0.91,
-		.dist_ly = 1300,
-	},
-	{
-		.name = "Alpha Gruis (Alnair)",
-		.spec_type = "B7IV",
-		.ra = 22.1333333333333,
-		.dec = -47,
-		.gal_lat = -52.4,
-		.gal_long = 350,
-		.mag_vis = 1.73,
-		.mag_abs = -0.73,
-		.hip_parlx = 32.16,
-		.hip_parlx_err = 0.82,
-		.dist_ly = 101,
-	},
-	{
-		.name = "Zeta Orionis (Alnitak)",
-		.spec_type = "O9.5Ib+B0III",
-		.ra = 5.68333333333333,
-		.dec = -1.9,
-		.gal_lat = -16.5,
-		.gal_long = 206.5,
-		.mag_vis = 1.74,
-		.mag_abs = -5.26,
-		.hip_parlx = 3.99,
-		.hip_parlx_err = 0.79,
-		.dist_ly = 820,
-	},
-	{
-		.name = "Gamma Velorum (Regor)",
-		.spec_type = "WC8+O9Ib",
-		.ra = 8.16666666666667,
-		.dec = -47.3,
-		.gal_lat = -7.6,
-		.gal_long = 262.8,
-		.mag_vis = 1.75,
-		.mag_abs = -5.31,
-		.hip_parlx = 3.88,
-		.hip_parlx_err = 0.53,
-		.dist_ly = 840,
-	},
-	{
-		.name = "Epsilon Ursae Majoris (Alioth)",
-		.spec_type = "A0IV",
-		.ra = 12.9,
-		.dec = 56,
-		.gal_lat = 61.1,
-		.gal_long = 122.2,
-		.mag_vis = 1.76,
-		.mag_abs = -0.21,
-		.hip_parlx = 40.3,
-		.hip_parlx_err = 0.62,
-		.dist_ly = 81,
-	},
-	{
-		.name = "Alpha Persei (Mirfak)",
-		.spec_type = "F5Ib",
-		.ra = 3.4,
-		.dec = 49.9,
-		.gal_lat = -5.9,
-		.gal_long = 146.5,
-		.mag_vis = 1.79,
-		.mag_abs = -4.5,
-		.hip_parlx = 5.51,
-		.hip_parlx_err = 0.66,
-		.dist_ly = 590,
-	},
-	{
-		.name = "Epsilon Sagittarii (Kaus Australis)",
-		.spec_type = "B9.5III",
-		.ra = 18.4,
-		.dec = -34.4,
-		.gal_lat = -9.8,
-		.gal_long = 359.2,
-		.mag_vis = 1.79,
-		.mag_abs = -1.44,
-		.hip_parlx = 22.55,
-		.hip_parlx_err = 1.02,
-		.dist_ly = 145,
-	},
-	{
-		.name = "Alpha Ursae Majoris (Dubhe)",
-		.spec_type = "K0III+F0V",
-		.ra = 11.0666666666667,
-		.dec = 61.8,
-		.gal_lat = 51,
-		.gal_long = 142.8,
-		.mag_vis = 1.81,
-		.mag_abs = -1.08,
-		.hip_parlx = 26.38,
-		.hip_parlx_err = 0.53,
-		.dist_ly = 124,
-	},
-	{
-		.name = "Delta Canis Majoris (Wezen)",
-		.spec_type = "F8Ia",
-		.ra = 7.13333333333333,
-		.dec = -26.4,
-		.gal_lat = -8.3,
-		.gal_long = 238.4,
-		.mag_vis = 1.83,
-		.mag_abs = -6.87,
-		.hip_parlx = 1.82,
-		.hip_parlx_err = 0.56,
-		.dist_ly = 1800,
-	},
-	{
-		.name = "Eta Ursae Majoris (Alkaid)",
-		.spec_type = "B3V",
-		.ra = 13.8,
-		.dec = 49.3,
-		.gal_lat = 65.3,
-		.gal_long = 100.5,
-		.mag_vis = 1.85,
-		.mag_abs = -0.6,
-		.hip_parlx = 32.39,
-		.hip_parlx_err = 0.74,
-		.dist_ly = 101,
-	},
-	{
-		.name = "Epsilon Carinae (Avior)",
-		.spec_type = "K3II+B2V",
-		.ra = 8.38333333333333,
-		.dec = -59.5,
-		.gal_lat = -12.5,
-		.gal_long = 274.3,
-		.mag_vis = 1.86,
-		.mag_abs = -4.58,
-		.hip_parlx = 5.16,
-		.hip_parlx_err = 0.49,
-		.dist_ly = 630,
-	},
-	{
-		.name = "Theta Scorpii (Sargas)",
-		.spec_type = "F1II",
-		.ra = 17.6166666666667,
-		.dec = -43,
-		.gal_lat = -5.9,
-		.gal_long = 347.1,
-		.mag_vis = 1.86,
-		.mag_abs = -2.75,
-		.hip_parlx = 11.99,
-		.hip_parlx_err = 0.84,
-		.dist_ly = 270,
-	},
-	{
-		.name = "Beta Aurigae (Menkalinan)",
-		.spec_type = "A2IV",
-		.ra = 6,
-		.dec = 44.9,
-		.gal_lat = 10.5,
-		.gal_long = 167.5,
-		.mag_vis = 1.9,
-		.mag_abs = -0.1,
-		.hip_parlx = 39.72,
-		.hip_parlx_err = 0.78,
-		.dist_ly = 82,
-	},
-	{
-		.name = "Alpha Trianguli Australis (Atria)",
-		.spec_type = "K2Ib-II",
-		.ra = 16.8166666666667,
-		.dec = -69,
-		.gal_lat = -15.3,
-		.gal_long = 321.6,
-		.mag_vis = 1.91,
-		.mag_abs = -3.62,
-		.hip_parlx = 7.85,
-		.hip_parlx_err = 0.63,
-		.dist_ly = 420,
-	},
-	{
-		.name = "Gamma Geminorum (Alhena)",
-		.spec_type = "A0IV",
-		.ra = 6.63333333333333,
-		.dec = 16.4,
-		.gal_lat = 4.5,
-		.gal_long = 196.8,
-		.mag_vis = 1.93,
-		.mag_abs = -0.6,
-		.hip_parlx = 31.12,
-		.hip_parlx_err = 2.33,
-		.dist_ly = 105,
-	},
-	{
-		.name = "Delta Velorum (Koo She)",
-		.spec_type = "A0V",
-		.ra = 8.75,
-		.dec = -54.7,
-		.gal_lat = -7.3,
-		.gal_long = 272.1,
-		.mag_vis = 1.93,
-		.mag_abs = -0.01,
-		.hip_parlx = 40.9,
-		.hip_parlx_err = 0.38,
-		.dist_ly = 80,
-	},
-	{
-		.name = "Alpha Pavonis (Peacock)",
-		.spec_type = "B0.5V+B2V",
-		.ra = 20.4333333333333,
-		.dec = -56.7,
-		.gal_lat = -35.3,
-		.gal_long = 340.9,
-		.mag_vis = 1.94,
-		.mag_abs = -1.81,
-		.hip_parlx = 17.8,
-		.hip_parlx_err = 0.7,
-		.dist_ly = 180,
-	},
-	{
-		.name = "Alpha Ursae Minoris (Polaris)",
-		.spec_type = "F7Ib-II",
-		.ra = 2.53333333333333,
-		.dec = 89.3,
-		.gal_lat = 26.5,
-		.gal_long = 123.3,
-		.mag_vis = 1.97,
-		.mag_abs = -3.64,
-		.hip_parlx = 7.56,
-		.hip_parlx_err = 0.48,
-		.dist_ly = 430,
-	},
-	{
-		.name = "Beta Canis Majoris (Mirzam)",
-		.spec_type = "B1III",
-		.ra = 6.38333333333333,
-		.dec = -18,
-		.gal_lat = -14.2,
-		.gal_long = 226.1,
-		.mag_vis = 1.98,
-		.mag_abs = -3.95,
-		.hip_parlx = 6.53,
-		.hip_parlx_err = 0.66,
-		.dist_ly = 500,
-	},
-	{
-		.name = "Alpha Hydrae (Alphard)",
-		.spec_type = "K3II",
-		.ra = 9.46666666666667,
-		.dec = -8.7,
-		.gal_lat = 29.1,
-		.gal_long = 241.6,
-		.mag_vis = 1.99,
-		.mag_abs = -1.69,
-		.hip_parlx = 18.4,
-		.hip_parlx_err = 0.78,
-		.dist_ly = 180,
-	},
-	{
-		.name = "Alpha Arietis (Hamal)",
-		.spec_type = "K2III",
-		.ra = 2.11666666666667,
-		.dec = 23.5,
-		.gal_lat = -36.2,
-		.gal_long = 144.5,
-		.mag_vis = 2.01,
-		.mag_abs = 0.48,
-		.hip_parlx = 49.48,
-		.hip_parlx_err = 0.99,
-		.dist_ly = 66,
-	},
-	{
-		.name = "Gamma Leonis (Algieba)",
-		.spec_type = "K0III+G7III",
-		.ra = 10.3333333333333,
-		.dec = 19.8,
-		.gal_lat = 54.7,
-		.gal_long = 216.6,
-		.mag_vis = 2.01,
-		.mag_abs = -0.92,
-		.hip_parlx = 25.96,
-		.hip_parlx_err = 0.83,
-		.dist_ly = 126,
-	},
-	{
-		.name = "Beta Ceti (Diphda)",
-		.spec_type = "K0III",
-		.ra = 0.733333333333333,
-		.dec = -18,
-		.gal_lat = -80.7,
-		.gal_long = 112,
-		.mag_vis = 2.04,
-		.mag_abs = -0.3,
-		.hip_parlx = 34.04,
-		.hip_parlx_err = 0.82,
-		.dist_ly = 96,
-	},
-	{
-		.name = "Sigma Sagittarii (Nunki)",
-		.spec_type = "B3V",
-		.ra = 18.9166666666667,
-		.dec = -26.3,
-		.gal_lat = -12.4,
-		.gal_long = 9.5,
-		.mag_vis = 2.05,
-		.mag_abs = -2.14,
-		.hip_parlx = 14.54,
-		.hip_parlx_err = 0.88,
-		.dist_ly = 220,
-	},
-	{
-		.name = "Theta Centauri (Menkent)",
-		.spec_type = "K0III",
-		.ra = 14.1166666666667,
-		.dec = -36.4,
-		.gal_lat = 24,
-		.gal_long = 319.5,
-		.mag_vis = 2.06,
-		.mag_abs = 0.7,
-		.hip_parlx = 53.52,
-		.hip_parlx_err = 0.79,
-		.dist_ly = 61,
-	},
-	{
-		.name = "Alpha Andromedae (Alpheratz)",
-		.spec_type = "B9IV",
-		.ra = 0.133333333333333,
-		.dec = 29.1,
-		.gal_lat = -32.8,
-		.gal_long = 111.6,
-		.mag_vis = 2.07,
-		.mag_abs = -0.3,
-		.hip_parlx = 33.6,
-		.hip_parlx_err = 0.73,
-		.dist_ly = 97,
-	},
-	{
-		.name = "Beta Andromedae (Mirach)",
-		.spec_type = "M0II",
-		.ra = 1.16666666666667,
-		.dec = 35.6,
-		.gal_lat = -27.1,
-		.gal_long = 127.2,
-		.mag_vis = 2.07,
-		.mag_abs = -1.86,
-		.hip_parlx = 16.36,
-		.hip_parlx_err = 0.76,
-		.dist_ly = 200,
-	},
-	{
-		.name = "Kappa Orionis (Saiph)",
-		.spec_type = "B0.5III",
-		.ra = 5.8,
-		.dec = -9.7,
-		.gal_lat = -18.4,
-		.gal_long = 214.6,
-		.mag_vis = 2.07,
-		.mag_abs = -4.65,
-		.hip_parlx = 4.52,
-		.hip_parlx_err = 0.77,
-		.dist_ly = 720,
-	},
-	{
-		.name = "Beta Ursae Minoris (Kochab)",
-		.spec_type = "K4III",
-		.ra = 14.85,
-		.dec = 74.2,
-		.gal_lat = 40.5,
-		.gal_long = 112.7,
-		.mag_vis = 2.07,
-		.mag_abs = -0.87,
-		.hip_parlx = 25.79,
-		.hip_parlx_err = 0.52,
-		.dist_ly = 127,
-	},
-	{
-		.name = "Beta Gruis (Al Dhanab)",
-		.spec_type = "M5III",
-		.ra = 22.7166666666667,
-		.dec = -46.9,
-		.gal_lat = -58,
-		.gal_long = 346.2,
-		.mag_vis = 2.07,
-		.mag_abs = -1.52,
-		.hip_parlx = 19.17,
-		.hip_parlx_err = 0.75,
-		.dist_ly = 170,
-	},
-	{
-		.name = "Alpha Ophiuchi (Rasalhague)",
-		.spec_type = "A5III",
-		.ra = 17.5833333333333,
-		.dec = 12.6,
-		.gal_lat = 22.6,
-		.gal_long = 35.9,
-		.mag_vis = 2.08,
-		.mag_abs = 1.3,
-		.hip_parlx = 69.84,
-		.hip_parlx_err = 0.88,
-		.dist_ly = 47,
-	},
-	{
-		.name = "Beta Persei (Algol)",
-		.spec_type = "B8V+G5IV+A",
-		.ra = 3.13333333333333,
-		.dec = 41,
-		.gal_lat = -14.9,
-		.gal_long = 148.9,
-		.mag_vis = 2.09,
-		.mag_abs = -0.18,
-		.hip_parlx = 35.14,
-		.hip_parlx_err = 0.9,
-		.dist_ly = 93,
-	},
-	{
-		.name = "Gamma Andromedae (Almach)",
-		.spec_type = "K3II+B8V+A0V",
-		.ra = 2.06666666666667,
-		.dec = 42.3,
-		.gal_lat = -18.6,
-		.gal_long = 137,
-		.mag_vis = 2.1,
-		.mag_abs = -3.08,
-		.hip_parlx = 9.19,
-		.hip_parlx_err = 0.73,
-		.dist_ly = 360,
-	},
-	{
-		.name = "Beta Leonis (Denebola)",
-		.spec_type = "A3V",
-		.ra = 11.8166666666667,
-		.dec = 14.6,
-		.gal_lat = 70.8,
-		.gal_long = 250.6,
-		.mag_vis = 2.14,
-		.mag_abs = 1.92,
-		.hip_parlx = 90.16,
-		.hip_parlx_err = 0.89,
-		.dist_ly = 36,
-	},
-	{
-		.name = "Gamma Cassiopeiae (Cih)",
-		.spec_type = "B0IV",
-		.ra = 0.95,
-		.dec = 60.7,
-		.gal_lat = -2.2,
-		.gal_long = 123.6,
-		.mag_vis = 2.15,
-		.mag_abs = -4.22,
-		.hip_parlx = 5.32,
-		.hip_parlx_err = 0.56,
-		.dist_ly = 610,
-	},
-	{
-		.name = "Gamma Centauri (Muhlifain)",
-		.spec_type = "A0III+A0III",
-		.ra = 12.7,
-		.dec = -49,
-		.gal_lat = 13.8,
-		.gal_long = 301.3,
-		.mag_vis = 2.2,
-		.mag_abs = -0.81,
-		.hip_parlx = 25.01,
-		.hip_parlx_err = 1.01,
-		.dist_ly = 130,
-	},
-	{
-		.name = "Zeta Puppis (Naos)",
-		.spec_type = "O5Ia",
-		.ra = 8.06666666666667,
-		.dec = -40,
-		.gal_lat = -4.6,
-		.gal_long = 256,
-		.mag_vis = 2.21,
-		.mag_abs = -5.95,
-		.hip_parlx = 2.33,
-		.hip_parlx_err = 0.51,
-		.dist_ly = 1400,
-	},
-	{
-		.name = "Iota Carinae (Aspidiske)",
-		.spec_type = "A8Ib",
-		.ra = 9.28333333333333,
-		.dec = -59.3,
-		.gal_lat = -7,
-		.gal_long = 278.5,
-		.mag_vis = 2.21,
-		.mag_abs = -4.42,
-		.hip_parlx = 4.71,
-		.hip_parlx_err = 0.46,
-		.dist_ly = 690,
-	},
-	{
-		.name = "Alpha Coronae Borealis (Alphecca)",
-		.spec_type = "A0V+G5V",
-		.ra = 15.5833333333333,
-		.dec = 26.7,
-		.gal_lat = 53.7,
-		.gal_long = 41.9,
-		.mag_vis = 2.22,
-		.mag_abs = 0.42,
-		.hip_parlx = 43.65,
-		.hip_parlx_err = 0.79,
-		.dist_ly = 75,
-	},
-	{
-		.name = "Lambda Velorum (Suhail)",
-		.spec_type = "K4Ib",
-		.ra = 9.13333333333333,
-		.dec = -43.4,
-		.gal_lat = 2.9,
-		.gal_long = 265.9,
-		.mag_vis = 2.23,
-		.mag_abs = -3.99,
-		.hip_parlx = 5.69,
-		.hip_parlx_err = 0.53,
-		.dist_ly = 570,
-	},
-	{
-		.name = "Zeta Ursae Majoris (Mizar)",
-		.spec_type = "A2V+A2V+A1V",
-		.ra = 13.4,
-		.dec = 54.9,
-		.gal_lat = 61.6,
-		.gal_long = 113.1,
-		.mag_vis = 2.23,
-		.mag_abs = 0.33,
-		.hip_parlx = 41.73,
-		.hip_parlx_err = 0.61,
-		.dist_ly = 78,
-	},
-	{
-		.name = "Gamma Cygni (Sadr)",
-		.spec_type = "F8Ib",
-		.ra = 20.3666666666667,
-		.dec = 40.3,
-		.gal_lat = 1.9,
-		.gal_long = 78.2,
-		.mag_vis = 2.23,
-		.mag_abs = -6.12,
-		.hip_parlx = 2.14,
-		.hip_parlx_err = 0.51,
-		.dist_ly = 1500,
-	},
-	{
-		.name = "Alpha Cassiopeiae (Schedar)",
-		.spec_type = "K0II",
-		.ra = 0.683333333333333,
-		.dec = 56.5,
-		.gal_lat = -6.3,
-		.gal_long = 121.5,
-		.mag_vis = 2.24,
-		.mag_abs = -1.99,
-		.hip_parlx = 14.27,
-		.hip_parlx_err = 0.57,
-		.dist_ly = 230,
-	},
-	{
-		.name = "Gamma Draconis (Eltanin)",
-		.spec_type = "K5III",
-		.ra = 17.95,
-		.dec = 51.5,
-		.gal_lat = 29.1,
-		.gal_long = 79.1,
-		.mag_vis = 2.24,
-		.mag_abs = -1.04,
-		.hip_parlx = 22.1,
-		.hip_parlx_err = 0.46,
-		.dist_ly = 148,
-	},
-	{
-		.name = "Delta Orionis (Mintaka)",
-		.spec_type = "O9.5II+B2V",
-		.ra = 5.53333333333333,
-		.dec = -0.3,
-		.gal_lat = -17.7,
-		.gal_long = 203.9,
-		.mag_vis = 2.25,
-		.mag_abs = -4.99,
-		.hip_parlx = 3.56,
-		.hip_parlx_err = 0.83,
-		.dist_ly = 920,
-	},
-	{
-		.name = "Beta Cassiopeiae (Caph)",
-		.spec_type = "F2III",
-		.ra = 0.15,
-		.dec = 59.2,
-		.gal_lat = -3.2,
-		.gal_long = 117.5,
-		.mag_vis = 2.28,
-		.mag_abs = 1.17,
-		.hip_parlx = 59.89,
-		.hip_parlx_err = 0.56,
-		.dist_ly = 55,
-	},
-	{
-		.name = "Epsilon Centauri",
-		.spec_type = "B1III",
-		.ra = 13.6666666666667,
-		.dec = -53.5,
-		.gal_lat = 8.7,
-		.gal_long = 310.2,
-		.mag_vis = 2.29,
-		.mag_abs = -3.02,
-		.hip_parlx = 8.68,
-		.hip_parlx_err = 0.77,
-		.dist_ly = 380,
-	},
-	{
-		.name = "Delta Scorpii (Dschubba)",
-		.spec_type = "B0.5IV",
-		.ra = 16,
-		.dec = -22.6,
-		.gal_lat = 22.6,
-		.gal_long = 350.1,
-		.mag_vis = 2.29,
-		.mag_abs = -3.16,
-		.hip_parlx = 8.12,
-		.hip_parlx_err = 0.88,
-		.dist_ly = 400,
-	},
-	{
-		.name = "Epsilon Scorpii (Wei)",
-		.spec_type = "K2.5III",
-		.ra = 16.8333333333333,
-		.dec = -34.3,
-		.gal_lat = 6.6,
-		.gal_long = 348.8,
-		.mag_vis = 2.29,
-		.mag_abs = 0.78,
-		.hip_parlx = 49.85,
-		.hip_parlx_err = 0.81,
-		.dist_ly = 65,
-	},
-	{
-		.name = "Alpha Lupi (Men)",
-		.spec_type = "B1.5III",
-		.ra = 14.7,
-		.dec = -47.4,
-		.gal_lat = 11.4,
-		.gal_long = 321.6,
-		.mag_vis = 2.3,
-		.mag_abs = -3.83,
-		.hip_parlx = 5.95,
-		.hip_parlx_err = 0.76,
-		.dist_ly = 550,
-	},
-	{
-		.name = "Eta Centauri",
-		.spec_type = "B1.5V",
-		.ra = 14.6,
-		.dec = -42.2,
-		.gal_lat = 16.6,
-		.gal_long = 322.9,
-		.mag_vis = 2.33,
-		.mag_abs = -2.55,
-		.hip_parlx = 10.57,
-		.hip_parlx_err = 0.83,
-		.dist_ly = 310,
-	},
-	{
-		.name = "Beta Ursae Majoris (Merak)",
-		.spec_type = "A1V",
-		.ra = 11.0333333333333,
-		.dec = 56.4,
-		.gal_lat = 54.8,
-		.gal_long = 149.1,
-		.mag_vis = 2.34,
-		.mag_abs = 0.41,
-		.hip_parlx = 41.07,
-		.hip_parlx_err = 0.6,
-		.dist_ly = 79,
-	},
-	{
-		.name = "Epsilon Bootis (Izar)",
-		.spec_type = "K0II-III+A2V",
-		.ra = 14.75,
-		.dec = 27.1,
-		.gal_lat = 64.8,
-		.gal_long = 39.4,
-		.mag_vis = 2.35,
-		.mag_abs = -1.69,
-		.hip_parlx = 15.55,
-		.hip_parlx_err = 0.78,
-		.dist_ly = 210,
-	},
-	{
-		.name = "Epsilon Pegasi (Enif)",
-		.spec_type = "K2Ib",
-		.ra = 21.7333333333333,
-		.dec = 9.9,
-		.gal_lat = -31.4,
-		.gal_long = 65.6,
-		.mag_vis = 2.38,
-		.mag_abs = -4.19,
-		.hip_parlx = 4.85,
-		.hip_parlx_err = 0.84,
-		.dist_ly = 670,
-	},
-	{
-		.name = "Kappa Scorpii (Girtab)",
-		.spec_type = "B1.5III",
-		.ra = 17.7,
-		.dec = -39,
-		.gal_lat = -4.6,
-		.gal_long = 351,
-		.mag_vis = 2.39,
-		.mag_abs = -3.38,
-		.hip_parlx = 7.03,
-		.hip_parlx_err = 0.73,
-		.dist_ly = 460,
-	},
-	{
-		.name = "Alpha Phoenicis (Ankaa)",
-		.spec_type = "K0III",
-		.ra = 0.433333333333333,
-		.dec = -42.3,
-		.gal_lat = -74,
-		.gal_long = 320.2,
-		.mag_vis = 2.4,
-		.mag_abs = 0.52,
-		.hip_parlx = 42.14,
-		.hip_parlx_err = 0.78,
-		.dist_ly = 77,
-	},
-	{
-		.name = "Gamma Ursae Majoris (Phecda)",
-		.spec_type = "A0V",
-		.ra = 11.9,
-		.dec = 53.7,
-		.gal_lat = 61.4,
-		.gal_long = 140.8,
-		.mag_vis = 2.41,
-		.mag_abs = 0.36,
-		.hip_parlx = 38.99,
-		.hip_parlx_err = 0.68,
-		.dist_ly = 84,
-	},
-	{
-		.name = "Eta Ophiuchi (Sabik)",
-		.spec_type = "A1V+A3V",
-		.ra = 17.1666666666667,
-		.dec = -15.7,
-		.gal_lat = 14.1,
-		.gal_long = 6.7,
-		.mag_vis = 2.43,
-		.mag_abs = 0.37,
-		.hip_parlx = 38.77,
-		.hip_parlx_err = 0.86,
-		.dist_ly = 84,
-	},
-	{
-		.name = "Beta Pegasi (Scheat)",
-		.spec_type = "M2III",
-		.ra = 23.0666666666667,
-		.dec = 28.1,
-		.gal_lat = -29.1,
-		.gal_long = 95.8,
-		.mag_vis = 2.44,
-		.mag_abs = -1.49,
-		.hip_parlx = 16.37,
-		.hip_parlx_err = 0.72,
-		.dist_ly = 200,
-	},
-	{
-		.name = "Eta Canis Majoris (Aludra)",
-		.spec_type = "B5Ia",
-		.ra = 7.4,
-		.dec = -29.3,
-		.gal_lat = -6.5,
-		.gal_long = 242.6,
-		.mag_vis = 2.45,
-		.mag_abs = -7.51,
-		.hip_parlx = 1.02,
-		.hip_parlx_err = 0.57,
-		.dist_ly = 3000,
-	},
-	{
-		.name = "Alpha Cephei (Alderamin)",
-		.spec_type = "A7IV",
-		.ra = 21.3166666666667,
-		.dec = 62.6,
-		.gal_lat = 9.1,
-		.gal_long = 101,
-		.mag_vis = 2.45,
-		.mag_abs = 1.58,
-		.hip_parlx = 66.84,
-		.hip_parlx_err = 0.49,
-		.dist_ly = 49,
-	},
-	{
-		.name = "Kappa Velorum (Markeb)",
-		.spec_type = "B2IV",
-		.ra = 9.36666666666667,
-		.dec = -55,
-		.gal_lat = -3.5,
-		.gal_long = 275.9,
-		.mag_vis = 2.47,
-		.mag_abs = -3.62,
-		.hip_parlx = 6.05,
-		.hip_parlx_err = 0.48,
-		.dist_ly = 540,
-	},
-	{
-		.name = "Epsilon Cygni (Gienah)",
-		.spec_type = "K0III",
-		.ra = 20.7666666666667,
-		.dec = 34,
-		.gal_lat = -5.7,
-		.gal_long = 76,
-		.mag_vis = 2.48,
-		.mag_abs = 0.76,
-		.hip_parlx = 45.26,
-		.hip_parlx_err = 0.53,
-		.dist_ly = 72,
-	},
-	{
-		.name = "Alpha Pegasi (Markab)",
-		.spec_type = "B9IV",
-		.ra = 23.0833333333333,
-		.dec = 15.2,
-		.gal_lat = -40.4,
-		.gal_long = 88.4,
-		.mag_vis = 2.49,
-		.mag_abs = -0.67,
-		.hip_parlx = 23.36,
-		.hip_parlx_err = 0.76,
-		.dist_ly = 140,
-	},
-	{
-		.name = "Alpha Ceti (Menkar)",
-		.spec_type = "M2III",
-		.ra = 3.03333333333333,
-		.dec = 4.1,
-		.gal_lat = -45.6,
-		.gal_long = 173.3,
-		.mag_vis = 2.54,
-		.mag_abs = -1.61,
-		.hip_parlx = 14.82,
-		.hip_parlx_err = 0.83,
-		.dist_ly = 220,
-	},
-	{
-		.name = "Zeta Ophiuchi (Han)",
-		.spec_type = "O9.5V",
-		.ra = 16.6166666666667,
-		.dec = -10.6,
-		.gal_lat = 23.6,
-		.gal_long = 6.2,
-		.mag_vis = 2.54,
-		.mag_abs = -3.2,
-		.hip_parlx = 7.12,
-		.hip_parlx_err = 0.71,
-		.dist_ly = 460,
-	},
-	{
-		.name = "Zeta Centauri (Al Nair al Kent.)",
-		.spec_type = "B2.5IV",
-		.ra = 13.9333333333333,
-		.dec = -47.3,
-		.gal_lat = 14.2,
-		.gal_long = 314.2,
-		.mag_vis = 2.55,
-		.mag_abs = -2.81,
-		.hip_parlx = 8.48,
-		.hip_parlx_err = 0.74,
-		.dist_ly = 390,
-	},
-	{
-		.name = "Delta Leonis (Zosma)",
-		.spec_type = "A4V",
-		.ra = 11.2333333333333,
-		.dec = 20.5,
-		.gal_lat = 66.8,
-		.gal_long = 224.3,
-		.mag_vis = 2.56,
-		.mag_abs = 1.32,
-		.hip_parlx = 56.52,
-		.hip_parlx_err = 0.83,
-		.dist_ly = 58,
-	},
-	{
-		.name = "Beta Scorpii (Graffias)",
-		.spec_type = "B1V+B2V",
-		.ra = 16.0833333333333,
-		.dec = -19.8,
-		.gal_lat = 23.7,
-		.gal_long = 353.1,
-		.mag_vis = 2.56,
-		.mag_abs = -3.5,
-		.hip_parlx = 6.15,
-		.hip_parlx_err = 1.12,
-		.dist_ly = 530,
-	},
-	{
-		.name = "Alpha Leporis (Arneb)",
-		.spec_type = "F0Ib",
-		.ra = 5.55,
-		.dec = -17.8,
-		.gal_lat = -25.1,
-		.gal_long = 221,
-		.mag_vis = 2.58,
-		.mag_abs = -5.4,
-		.hip_parlx = 2.54,
-		.hip_parlx_err = 0.72,
-		.dist_ly = 1300,
-	},
-	{
-		.name = "Delta Centauri",
-		.spec_type = "B2IV",
-		.ra = 12.1333333333333,
-		.dec = -50.7,
-		.gal_lat = 11.6,
-		.gal_long = 295.9,
-		.mag_vis = 2.58,
-		.mag_abs = -2.84,
-		.hip_parlx = 8.25,
-		.hip_parlx_err = 0.79,
-		.dist_ly = 400,
-	},
-	{
-		.name = "Gamma Corvi (Gienah Ghurab)",
-		.spec_type = "B8III",
-		.ra = 12.2666666666667,
-		.dec = -17.5,
-		.gal_lat = 44.6,
-		.gal_long = 291.1,
-		.mag_vis = 2.58,
-		.mag_abs = -0.94,
-		.hip_parlx = 19.78,
-		.hip_parlx_err = 0.81,
-		.dist_ly = 165,
-	},
-	{
-		.name = "Zeta Sagittarii (Ascella)",
-		.spec_type = "A2IV+A4V",
-		.ra = 19.05,
-		.dec = -29.9,
-		.gal_lat = -15.5,
-		.gal_long = 6.9,
-		.mag_vis = 2.6,
-		.mag_abs = 0.42,
-		.hip_parlx = 36.61,
-		.hip_parlx_err = 1.37,
-		.dist_ly = 89,
-	},
-	{
-		.name = "Beta Librae (Zubeneschamali)",
-		.spec_type = "B8V",
-		.ra = 15.2833333333333,
-		.dec = -9.4,
-		.gal_lat = 39.2,
-		.gal_long = 352,
-		.mag_vis = 2.61,
-		.mag_abs = -0.84,
-		.hip_parlx = 20.38,
-		.hip_parlx_err = 0.87,
-		.dist_ly = 160,
-	},
-	{
-		.name = "Alpha Serpentis (Unukalhai)",
-		.spec_type = "K2III",
-		.ra = 15.7333333333333,
-		.dec = 6.4,
-		.gal_lat = 44.1,
-		.gal_long = 14.1,
-		.mag_vis = 2.63,
-		.mag_abs = 0.87,
-		.hip_parlx = 44.54,
-		.hip_parlx_err = 0.71,
-		.dist_ly = 73,
-	},
-	{
-		.name = "Beta Arietis (Sheratan)",
-		.spec_type = "A5V",
-		.ra = 1.91666666666667,
-		.dec = 20.8,
-		.gal_lat = -39.7,
-		.gal_long = 142.4,
-		.mag_vis = 2.64,
-		.mag_abs = 1.33,
-		.hip_parlx = 54.74,
-		.hip_parlx_err = 0.75,
-		.dist_ly = 60,
-	},
-	{
-		.name = "Alpha Librae (Zubenelgenubi)",
-		.spec_type = "A3IV+F4IV",
-		.ra = 14.85,
-		.dec = -16,
-		.gal_lat = 38,
-		.gal_long = 340.4,
-		.mag_vis = 2.64,
-		.mag_abs = 0.77,
-		.hip_parlx = 42.25,
-		.hip_parlx_err = 1.05,
-		.dist_ly = 77,
-	},
-	{
-		.name = "Alpha Columbae (Phact)",
-		.spec_type = "B7IV",
-		.ra = 5.66666666666667,
-		.dec = -34.1,
-		.gal_lat = -28.8,
-		.gal_long = 238.9,
-		.mag_vis = 2.65,
-		.mag_abs = -1.93,
-		.hip_parlx = 12.16,
-		.hip_parlx_err = 0.6,
-		.dist_ly = 270,
-	},
-	{
-		.name = "Theta Aurigae",
-		.spec_type = "A0III+G2V",
-		.ra = 6,
-		.dec = 37.2,
-		.gal_lat = 6.8,
-		.gal_long = 174.4,
-		.mag_vis = 2.65,
-		.mag_abs = -0.98,
-		.hip_parlx = 18.83,
-		.hip_parlx_err = 0.81,
-		.dist_ly = 170,
-	},
-	{
-		.name = "Beta Corvi (Kraz)",
-		.spec_type = "G5III",
-		.ra = 12.5666666666667,
-		.dec = -23.4,
-		.gal_lat = 39.3,
-		.gal_long = 297.8,
-		.mag_vis = 2.65,
-		.mag_abs = -0.51,
-		.hip_parlx = 23.34,
-		.hip_parlx_err = 0.8,
-		.dist_ly = 140,
-	},
-	{
-		.name = "Delta Cassiopeiae (Ruchbah)",
-		.spec_type = "A5III",
-		.ra = 1.43333333333333,
-		.dec = 60.2,
-		.gal_lat = -2.4,
-		.gal_long = 127.2,
-		.mag_vis = 2.66,
-		.mag_abs = 0.24,
-		.hip_parlx = 32.81,
-		.hip_parlx_err = 0.62,
-		.dist_ly = 99,
-	},
-	{
-		.name = "Eta Bootis (Muphrid)",
-		.spec_type = "G0IV",
-		.ra = 13.9166666666667,
-		.dec = 18.4,
-		.gal_lat = 73,
-		.gal_long = 5.5,
-		.mag_vis = 2.68,
-		.mag_abs = 2.41,
-		.hip_parlx = 88.17,
-		.hip_parlx_err = 0.75,
-		.dist_ly = 37,
-	},
-	{
-		.name = "Beta Lupi (Ke Kouan)",
-		.spec_type = "B2III",
-		.ra = 14.9833333333333,
-		.dec = -43.1,
-		.gal_lat = 13.9,
-		.gal_long = 326.4,
-		.mag_vis = 2.68,
-		.mag_abs = -3.35,
-		.hip_parlx = 6.23,
-		.hip_parlx_err = 0.71,
-		.dist_ly = 520,
-	},
-	{
-		.name = "Iota Aurigae (Hassaleh)",
-		.spec_type = "K3II",
-		.ra = 4.95,
-		.dec = 33.2,
-		.gal_lat = -6.1,
-		.gal_long = 170.6,
-		.mag_vis = 2.69,
-		.mag_abs = -3.29,
-		.hip_parlx = 6.37,
-		.hip_parlx_err = 0.96,
-		.dist_ly = 510,
-	},
-	{
-		.name = "Mu Velorum",
-		.spec_type = "G5III+G2V",
-		.ra = 10.7833333333333,
-		.dec = -49.4,
-		.gal_lat = 8.6,
-		.gal_long = 283.1,
-		.mag_vis = 2.69,
-		.mag_abs = -0.06,
-		.hip_parlx = 28.18,
-		.hip_parlx_err = 0.49,
-		.dist_ly = 116,
-	},
-	{
-		.name = "Alpha Muscae",
-		.spec_type = "B2V",
-		.ra = 12.6166666666667,
-		.dec = -69.1,
-		.gal_lat = -6.3,
-		.gal_long = 301.6,
-		.mag_vis = 2.69,
-		.mag_abs = -2.17,
-		.hip_parlx = 10.67,
-		.hip_parlx_err = 0.48,
-		.dist_ly = 310,
-	},
-	{
-		.name = "Upsilon Scorpii (Lesath)",
-		.spec_type = "B2IV",
-		.ra = 17.5166666666667,
-		.dec = -37.3,
-		.gal_lat = -1.9,
-		.gal_long = 351.3,
-		.mag_vis = 2.7,
-		.mag_abs = -3.31,
-		.hip_parlx = 6.29,
-		.hip_parlx_err = 0.81,
-		.dist_ly = 520,
-	},
-	{
-		.name = "Pi Puppis",
-		.spec_type = "K4Ib",
-		.ra = 7.28333333333333,
-		.dec = -37.1,
-		.gal_lat = -11.3,
-		.gal_long = 249,
-		.mag_vis = 2.71,
-		.mag_abs = -4.92,
-		.hip_parlx = 2.98,
-		.hip_parlx_err = 0.55,
-		.dist_ly = 1100,
-	},
-	{
-		.name = "Delta Sagittarii (Kaus Meridionalis)",
-		.spec_type = "K2II",
-		.ra = 18.35,
-		.dec = -29.8,
-		.gal_lat = -7.2,
-		.gal_long = 3,
-		.mag_vis = 2.72,
-		.mag_abs = -2.14,
-		.hip_parlx = 10.67,
-		.hip_parlx_err = 0.93,
-		.dist_ly = 310,
-	},
-	{
-		.name = "Gamma Aquilae (Tarazed)",
-		.spec_type = "K3II",
-		.ra = 19.7666666666667,
-		.dec = 10.6,
-		.gal_lat = -7,
-		.gal_long = 48.7,
-		.mag_vis = 2.72,
-		.mag_abs = -3.03,
-		.hip_parlx = 7.08,
-		.hip_parlx_err = 0.75,
-		.dist_ly = 460,
-	},
-	{
-		.name = "Delta Ophiuchi (Yed Prior)",
-		.spec_type = "M1III",
-		.ra = 16.2333333333333,
-		.dec = -3.7,
-		.gal_lat = 32.3,
-		.gal_long = 8.8,
-		.mag_vis = 2.73,
-		.mag_abs = -0.86,
-		.hip_parlx = 19.16,
-		.hip_parlx_err = 1.02,
-		.dist_ly = 170,
-	},
-	{
-		.name = "Eta Draconis (Aldhibain)",
-		.spec_type = "G8III",
-		.ra = 16.4,
-		.dec = 61.5,
-		.gal_lat = 40.9,
-		.gal_long = 92.6,
-		.mag_vis = 2.73,
-		.mag_abs = 0.58,
-		.hip_parlx = 37.18,
-		.hip_parlx_err = 0.45,
-		.dist_ly = 88,
-	},
-	{
-		.name = "Theta Carinae",
-		.spec_type = "B0V",
-		.ra = 10.7166666666667,
-		.dec = -64.4,
-		.gal_lat = -4.9,
-		.gal_long = 289.6,
-		.mag_vis = 2.74,
-		.mag_abs = -2.91,
-		.hip_parlx = 7.43,
-		.hip_parlx_err = 0.5,
-		.dist_ly = 440,
-	},
-	{
-		.name = "Gamma Virginis (Porrima)",
-		.spec_type = "F0V+F0V",
-		.ra = 12.7,
-		.dec = -1.5,
-		.gal_lat = 61.3,
-		.gal_long = 298.1,
-		.mag_vis = 2.74,
-		.mag_abs = 2.38,
-		.hip_parlx = 84.53,
-		.hip_parlx_err = 1.18,
-		.dist_ly = 39,
-	},
-	{
-		.name = "Iota Orionis (Hatysa)",
-		.spec_type = "O9III",
-		.ra = 5.58333333333333,
-		.dec = -5.9,
-		.gal_lat = -19.7,
-		.gal_long = 209.5,
-		.mag_vis = 2.75,
-		.mag_abs = -5.3,
-		.hip_parlx = 2.46,
-		.hip_parlx_err = 0.77,
-		.dist_ly = 1300,
-	},
-	{
-		.name = "Iota Centauri",
-		.spec_type = "A2V",
-		.ra = 13.35,
-		.dec = -36.7,
-		.gal_lat = 25.8,
-		.gal_long = 309.5,
-		.mag_vis = 2.75,
-		.mag_abs = 1.48,
-		.hip_parlx = 55.64,
-		.hip_parlx_err = 0.74,
-		.dist_ly = 59,
-	},
-	{
-		.name = "Beta Ophiuchi (Cebalrai)",
-		.spec_type = "K2III",
-		.ra = 17.7166666666667,
-		.dec = 4.6,
-		.gal_lat = 17.3,
-		.gal_long = 29.2,
-		.mag_vis = 2.76,
-		.mag_abs = 0.76,
-		.hip_parlx = 39.78,
-		.hip_parlx_err = 0.75,
-		.dist_ly = 82,
-	},
-	{
-		.name = "Beta Eridani (Kursa)",
-		.spec_type = "A3III",
-		.ra = 5.13333333333333,
-		.dec = -5.1,
-		.gal_lat = -25.3,
-		.gal_long = 205.4,
-		.mag_vis = 2.78,
-		.mag_abs = 0.6,
-		.hip_parlx = 36.71,
-		.hip_parlx_err = 0.76,
-		.dist_ly = 89,
-	},
-	{
-		.name = "Beta Herculis (Kornephoros)",
-		.spec_type = "G7III",
-		.ra = 16.5,
-		.dec = 21.5,
-		.gal_lat = 40.3,
-		.gal_long = 39,
-		.mag_vis = 2.78,
-		.mag_abs = -0.5,
-		.hip_parlx = 22.07,
-		.hip_parlx_err = 1,
-		.dist_ly = 150,
-	},
-	{
-		.name = "Delta Crucis",
-		.spec_type = "B2IV",
-		.ra = 12.25,
-		.dec = -58.7,
-		.gal_lat = 3.8,
-		.gal_long = 298.2,
-		.mag_vis = 2.79,
-		.mag_abs = -2.45,
-		.hip_parlx = 8.96,
-		.hip_parlx_err = 0.6,
-		.dist_ly = 360,
-	},
-	{
-		.name = "Beta Draconis (Rastaban)",
-		.spec_type = "G2II",
-		.ra = 17.5,
-		.dec = 52.3,
-		.gal_lat = 33.4,
-		.gal_long = 79.6,
-		.mag_vis = 2.79,
-		.mag_abs = -2.43,
-		.hip_parlx = 9.02,
-		.hip_parlx_err = 0.49,
-		.dist_ly = 360,
-	},
-	{
-		.name = "Alpha Canum Venaticorum (Cor Caroli)",
-		.spec_type = "A0IV+F0V",
-		.ra = 12.9333333333333,
-		.dec = 38.3,
-		.gal_lat = 78.8,
-		.gal_long = 118.3,
-		.mag_vis = 2.8,
-		.mag_abs = 0.16,
-		.hip_parlx = 29.6,
-		.hip_parlx_err = 1.04,
-		.dist_ly = 110,
-	},
-	{
-		.name = "Gamma Lupi",
-		.spec_type = "B2IV-V+B2IV-V",
-		.ra = 15.5833333333333,
-		.dec = -41.2,
-		.gal_lat = 11.9,
-		.gal_long = 333.2,
-		.mag_vis = 2.8,
-		.mag_abs = -3.4,
-		.hip_parlx = 5.75,
-		.hip_parlx_err = 1.24,
-		.dist_ly = 570,
-	},
-	{
-		.name = "Beta Leporis (Nihal)",
-		.spec_type = "G5III",
-		.ra = 5.46666666666667,
-		.dec = -20.8,
-		.gal_lat = -27.3,
-		.gal_long = 223.6,
-		.mag_vis = 2.81,
-		.mag_abs = -0.63,
-		.hip_parlx = 20.49,
-		.hip_parlx_err = 0.85,
-		.dist_ly = 160,
-	},
-	{
-		.name = "Zeta Herculis (Rutilicus)",
-		.spec_type = "F9IV+G7V",
-		.ra = 16.6833333333333,
-		.dec = 31.6,
-		.gal_lat = 40.3,
-		.gal_long = 52.6,
-		.mag_vis = 2.81,
-		.mag_abs = 2.64,
-		.hip_parlx = 92.63,
-		.hip_parlx_err = 0.6,
-		.dist_ly = 35,
-	},
-	{
-		.name = "Beta Hydri",
-		.spec_type = "G2IV",
-		.ra = 0.433333333333333,
-		.dec = -77.3,
-		.gal_lat = -39.7,
-		.gal_long = 304.7,
-		.mag_vis = 2.82,
-		.mag_abs = 3.45,
-		.hip_parlx = 133.78,
-		.hip_parlx_err = 0.51,
-		.dist_ly = 24,
-	},
-	{
-		.name = "Tau Scorpii",
-		.spec_type = "B0V",
-		.ra = 16.6,
-		.dec = -28.2,
-		.gal_lat = 12.8,
-		.gal_long = 351.6,
-		.mag_vis = 2.82,
-		.mag_abs = -2.78,
-		.hip_parlx = 7.59,
-		.hip_parlx_err = 0.78,
-		.dist_ly = 430,
-	},
-	{
-		.name = "Lambda Sagittarii (Kaus Borealis)",
-		.spec_type = "K1III",
-		.ra = 18.4666666666667,
-		.dec = -25.4,
-		.gal_lat = -6.5,
-		.gal_long = 7.7,
-		.mag_vis = 2.82,
-		.mag_abs = 0.95,
-		.hip_parlx = 42.2,
-		.hip_parlx_err = 0.9,
-		.dist_ly = 77,
-	},
-	{
-		.name = "Gamma Pegasi (Algenib)",
-		.spec_type = "B2IV",
-		.ra = 0.216666666666667,
-		.dec = 15.2,
-		.gal_lat = -46.7,
-		.gal_long = 109.4,
-		.mag_vis = 2.83,
-		.mag_abs = -2.22,
-		.hip_parlx = 9.79,
-		.hip_parlx_err = 0.81,
-		.dist_ly = 330,
-	},
-	{
-		.name = "Rho Puppis (Turais)",
-		.spec_type = "F6III",
-		.ra = 8.13333333333333,
-		.dec = -24.3,
-		.gal_lat = 4.5,
-		.gal_long = 243.2,
-		.mag_vis = 2.83,
-		.mag_abs = 1.41,
-		.hip_parlx = 51.99,
-		.hip_parlx_err = 0.66,
-		.dist_ly = 63,
-	},
-	{
-		.name = "Beta Trianguli Australis",
-		.spec_type = "F2IV",
-		.ra = 15.9166666666667,
-		.dec = -63.4,
-		.gal_lat = -7.5,
-		.gal_long = 321.9,
-		.mag_vis = 2.83,
-		.mag_abs = 2.38,
-		.hip_parlx = 81.24,
-		.hip_parlx_err = 0.62,
-		.dist_ly = 40,
-	},
-	{
-		.name = "Zeta Persei",
-		.spec_type = "B1II+B8IV+A2V",
-		.ra = 3.9,
-		.dec = 31.9,
-		.gal_lat = -16.7,
-		.gal_long = 162.3,
-		.mag_vis = 2.84,
-		.mag_abs = -4.55,
-		.hip_parlx = 3.32,
-		.hip_parlx_err = 0.75,
-		.dist_ly = 980,
-	},
-	{
-		.name = "Beta Arae",
-		.spec_type = "K3Ib-II",
-		.ra = 17.4166666666667,
-		.dec = -55.5,
-		.gal_lat = -11,
-		.gal_long = 335.4,
-		.mag_vis = 2.84,
-		.mag_abs = -3.49,
-		.hip_parlx = 5.41,
-		.hip_parlx_err = 0.76,
-		.dist_ly = 600,
-	},
-	{
-		.name = "Alpha Arae (Choo)",
-		.spec_type = "B2V",
-		.ra = 17.5333333333333,
-		.dec = -49.9,
-		.gal_lat = -8.9,
-		.gal_long = 340.8,
-		.mag_vis = 2.84,
-		.mag_abs = -1.51,
-		.hip_parlx = 13.46,
-		.hip_parlx_err = 0.95,
-		.dist_ly = 240,
-	},
-	{
-		.name = "Eta Tauri (Alcyone)",
-		.spec_type = "B7III",
-		.ra = 3.78333333333333,
-		.dec = 24.1,
-		.gal_lat = -23.5,
-		.gal_long = 166.6,
-		.mag_vis = 2.85,
-		.mag_abs = -2.41,
-		.hip_parlx = 8.87,
-		.hip_parlx_err = 0.99,
-		.dist_ly = 370,
-	},
-	{
-		.name = "Epsilon Virginis (Vindemiatrix)",
-		.spec_type = "G8III",
-		.ra = 13.0333333333333,
-		.dec = 11,
-		.gal_lat = 73.7,
-		.gal_long = 312.3,
-		.mag_vis = 2.85,
-		.mag_abs = 0.37,
-		.hip_parlx = 31.9,
-		.hip_parlx_err = 0.87,
-		.dist_ly = 102,
-	},
-	{
-		.name = "Delta Capricorni (Deneb Algedi)",
-		.spec_type = "A5V",
-		.ra = 21.7833333333333,
-		.dec = -16.1,
-		.gal_lat = -46,
-		.gal_long = 37.6,
-		.mag_vis = 2.85,
-		.mag_abs = 2.49,
-		.hip_parlx = 84.58,
-		.hip_parlx_err = 0.88,
-		.dist_ly = 39,
-	},
-	{
-		.name = "Alpha Hydri (Head of Hydrus)",
-		.spec_type = "F0III",
-		.ra = 1.98333333333333,
-		.dec = -61.6,
-		.gal_lat = -53.7,
-		.gal_long = 289.4,
-		.mag_vis = 2.86,
-		.mag_abs = 1.16,
-		.hip_parlx = 45.74,
-		.hip_parlx_err = 0.55,
-		.dist_ly = 71,
-	},
-	{
-		.name = "Delta Cygni",
-		.spec_type = "B9.5III+F1V",
-		.ra = 19.75,
-		.dec = 45.1,
-		.gal_lat = 10.2,
-		.gal_long = 78.7,
-		.mag_vis = 2.86,
-		.mag_abs = -0.74,
-		.hip_parlx = 19.07,
-		.hip_parlx_err = 0.45,
-		.dist_ly = 170,
-	},
-	{
-		.name = "Mu Geminorum (Tejat)",
-		.spec_type = "M3III",
-		.ra = 6.38333333333333,
-		.dec = 22.5,
-		.gal_lat = 4.2,
-		.gal_long = 189.8,
-		.mag_vis = 2.87,
-		.mag_abs = -1.39,
-		.hip_parlx = 14.07,
-		.hip_parlx_err = 0.93,
-		.dist_ly = 230,
-	},
-	{
-		.name = "Gamma Trianguli Australis",
-		.spec_type = "A1III",
-		.ra = 15.3166666666667,
-		.dec = -68.7,
-		.gal_lat = -8.4,
-		.gal_long = 316.5,
-		.mag_vis = 2.87,
-		.mag_abs = -0.87,
-		.hip_parlx = 17.85,
-		.hip_parlx_err = 0.52,
-		.dist_ly = 180,
-	},
-	{
-		.name = "Alpha Tucanae",
-		.spec_type = "K3III",
-		.ra = 22.3166666666667,
-		.dec = -60.3,
-		.gal_lat = -48,
-		.gal_long = 330.1,
-		.mag_vis = 2.87,
-		.mag_abs = -1.05,
-		.hip_parlx = 16.42,
-		.hip_parlx_err = 0.59,
-		.dist_ly = 200,
-	},
-	{
-		.name = "Theta Eridani (Acamar)",
-		.spec_type = "A4III+A1V",
-		.ra = 2.96666666666667,
-		.dec = -40.3,
-		.gal_lat = -60.7,
-		.gal_long = 247.9,
-		.mag_vis = 2.88,
-		.mag_abs = -0.59,
-		.hip_parlx = 20.22,
-		.hip_parlx_err = 0.54,
-		.dist_ly = 160,
-	},
-	{
-		.name = "Pi Sagittarii (Albaldah)",
-		.spec_type = "F2II",
-		.ra = 19.1666666666667,
-		.dec = -21,
-		.gal_lat = -13.3,
-		.gal_long = 15.9,
-		.mag_vis = 2.88,
-		.mag_abs = -2.77,
-		.hip_parlx = 7.41,
-		.hip_parlx_err = 0.69,
-		.dist_ly = 440,
-	},
-	{
-		.name = "Beta Canis Minoris (Gomeisa)",
-		.spec_type = "B8V",
-		.ra = 7.45,
-		.dec = 8.3,
-		.gal_lat = 11.7,
-		.gal_long = 209.5,
-		.mag_vis = 2.89,
-		.mag_abs = -0.7,
-		.hip_parlx = 19.16,
-		.hip_parlx_err = 0.85,
-		.dist_ly = 170,
-	},
-	{
-		.name = "Pi Scorpii",
-		.spec_type = "B1V+B2V",
-		.ra = 15.9833333333333,
-		.dec = -26.1,
-		.gal_lat = 20.2,
-		.gal_long = 347.2,
-		.mag_vis = 2.89,
-		.mag_abs = -2.85,
-		.hip_parlx = 7.1,
-		.hip_parlx_err = 0.84,
-		.dist_ly = 460,
-	},
-	{
-		.name = "Epsilon Persei",
-		.spec_type = "B0.5V+A2V",
-		.ra = 3.96666666666667,
-		.dec = 40,
-		.gal_lat = -10.1,
-		.gal_long = 157.4,
-		.mag_vis = 2.9,
-		.mag_abs = -3.19,
-		.hip_parlx = 6.06,
-		.hip_parlx_err = 0.82,
-		.dist_ly = 540,
-	},
-	{
-		.name = "Sigma Scorpii (Alniyat)",
-		.spec_type = "B1III",
-		.ra = 16.35,
-		.dec = -25.6,
-		.gal_lat = 17,
-		.gal_long = 351.3,
-		.mag_vis = 2.9,
-		.mag_abs = -3.86,
-		.hip_parlx = 4.44,
-		.hip_parlx_err = 0.81,
-		.dist_ly = 730,
-	},
-	{
-		.name = "Beta Cygni (Albireo)",
-		.spec_type = "K3II+B8V+B9V",
-		.ra = 19.5166666666667,
-		.dec = 28,
-		.gal_lat = 4.6,
-		.gal_long = 62.1,
-		.mag_vis = 2.9,
-		.mag_abs = -2.31,
-		.hip_parlx = 8.46,
-		.hip_parlx_err = 0.58,
-		.dist_ly = 390,
-	},
-	{
-		.name = "Beta Aquarii (Sadalsuud)",
-		.spec_type = "G0Ib",
-		.ra = 21.5333333333333,
-		.dec = -5.6,
-		.gal_lat = -37.9,
-		.gal_long = 48,
-		.mag_vis = 2.9,
-		.mag_abs = -3.47,
-		.hip_parlx = 5.33,
-		.hip_parlx_err = 0.94,
-		.dist_ly = 610,
-	},
-	{
-		.name = "Gamma Persei",
-		.spec_type = "G8III+A2V",
-		.ra = 3.08333333333333,
-		.dec = 53.5,
-		.gal_lat = -4.3,
-		.gal_long = 142.1,
-		.mag_vis = 2.91,
-		.mag_abs = -1.57,
-		.hip_parlx = 12.72,
-		.hip_parlx_err = 0.71,
-		.dist_ly = 260,
-	},
-	{
-		.name = "Upsilon Carinae",
-		.spec_type = "A7Ib+B7III",
-		.ra = 9.78333333333333,
-		.dec = -65.1,
-		.gal_lat = -8.8,
-		.gal_long = 285,
-		.mag_vis = 2.92,
-		.mag_abs = -5.56,
-		.hip_parlx = 2.01,
-		.hip_parlx_err = 0.4,
-		.dist_ly = 1600,
-	},
-	{
-		.name = "Eta Pegasi (Matar)",
-		.spec_type = "G2II-III+F0V",
-		.ra = 22.7166666666667,
-		.dec = 30.2,
-		.gal_lat = -25,
-		.gal_long = 92.5,
-		.mag_vis = 2.93,
-		.mag_abs = -1.16,
-		.hip_parlx = 15.18,
-		.hip_parlx_err = 0.79,
-		.dist_ly = 215,
-	},
-	{
-		.name = "Tau Puppis",
-		.spec_type = "K1III",
-		.ra = 6.83333333333333,
-		.dec = -50.6,
-		.gal_lat = -20.9,
-		.gal_long = 260.2,
-		.mag_vis = 2.94,
-		.mag_abs = -0.8,
-		.hip_parlx = 17.85,
-		.hip_parlx_err = 0.49,
-		.dist_ly = 185,
-	},
-	{
-		.name = "Delta Corvi (Algorel)",
-		.spec_type = "B9.5V",
-		.ra = 12.5,
-		.dec = -16.5,
-		.gal_lat = 46,
-		.gal_long = 295.5,
-		.mag_vis = 2.94,
-		.mag_abs = 0.79,
-		.hip_parlx = 37.11,
-		.hip_parlx_err = 0.69,
-		.dist_ly = 88,
-	},
-	{
-		.name = "Alpha Aquarii (Sadalmelik)",
-		.spec_type = "G2Ib",
-		.ra = 22.1,
-		.dec = -0.3,
-		.gal_lat = -42.1,
-		.gal_long = 59.9,
-		.mag_vis = 2.95,
-		.mag_abs = -3.88,
-		.hip_parlx = 4.3,
-		.hip_parlx_err = 0.83,
-		.dist_ly = 760,
-	},
-	{
-		.name = "Gamma Eridani (Zaurak)",
-		.spec_type = "M1III",
-		.ra = 3.96666666666667,
-		.dec = -13.5,
-		.gal_lat = -44.5,
-		.gal_long = 205.2,
-		.mag_vis = 2.97,
-		.mag_abs = -1.19,
-		.hip_parlx = 14.75,
-		.hip_parlx_err = 0.75,
-		.dist_ly = 220,
-	},
-	{
-		.name = "Zeta Tauri (Alheka)",
-		.spec_type = "B4III",
-		.ra = 5.63333333333333,
-		.dec = 21.1,
-		.gal_lat = -5.6,
-		.gal_long = 185.7,
-		.mag_vis = 2.97,
-		.mag_abs = -2.56,
-		.hip_parlx = 7.82,
-		.hip_parlx_err = 1.02,
-		.dist_ly = 420,
-	},
-	{
-		.name = "Epsilon Leonis (Ras Elased Austr.)",
-		.spec_type = "G1II",
-		.ra = 9.76666666666667,
-		.dec = 23.8,
-		.gal_lat = 48.2,
-		.gal_long = 206.8,
-		.mag_vis = 2.97,
-		.mag_abs = -1.46,
-		.hip_parlx = 13.01,
-		.hip_parlx_err = 0.88,
-		.dist_ly = 250,
-	},
-	{
-		.name = "Gamma2 Sagittarii (Alnasl)",
-		.spec_type = "K0III",
-		.ra = 18.1,
-		.dec = -30.4,
-		.gal_lat = -4.5,
-		.gal_long = 0.9,
-		.mag_vis = 2.98,
-		.mag_abs = 0.63,
-		.hip_parlx = 33.94,
-		.hip_parlx_err = 0.87,
-		.dist_ly = 96,
-	},
-	{
-		.name = "Gamma Hydrae",
-		.spec_type = "G8III",
-		.ra = 13.3166666666667,
-		.dec = -23.2,
-		.gal_lat = 39.3,
-		.gal_long = 311.1,
-		.mag_vis = 2.99,
-		.mag_abs = -0.05,
-		.hip_parlx = 24.69,
-		.hip_parlx_err = 0.7,
-		.dist_ly = 132,
-	},
-	{
-		.name = "Iota1 Scorpii",
-		.spec_type = "F2Ia",
-		.ra = 17.8,
-		.dec = -40.1,
-		.gal_lat = -6.1,
-		.gal_long = 350.6,
-		.mag_vis = 2.99,
-		.mag_abs = -5.71,
-		.hip_parlx = 1.82,
-		.hip_parlx_err = 0.73,
-		.dist_ly = 1800,
-	},
-	{
-		.name = "Zeta Aquilae (Deneb el Okab)",
-		.spec_type = "A0V",
-		.ra = 19.0833333333333,
-		.dec = 13.9,
-		.gal_lat = 3.3,
-		.gal_long = 46.9,
-		.mag_vis = 2.99,
-		.mag_abs = 0.96,
-		.hip_parlx = 39.18,
-		.hip_parlx_err = 0.72,
-		.dist_ly = 83,
-	},
-	{
-		.name = "Beta Trianguli",
-		.spec_type = "A5III",
-		.ra = 2.16666666666667,
-		.dec = 35,
-		.gal_lat = -25.2,
-		.gal_long = 140.6,
-		.mag_vis = 3,
-		.mag_abs = 0.09,
-		.hip_parlx = 26.24,
-		.hip_parlx_err = 0.77,
-		.dist_ly = 124,
-	},
-	{
-		.name = "Psi Ursae Majoris",
-		.spec_type = "K1III",
-		.ra = 11.1666666666667,
-		.dec = 44.5,
-		.gal_lat = 63.2,
-		.gal_long = 165.8,
-		.mag_vis = 3,
-		.mag_abs = -0.27,
-		.hip_parlx = 22.21,
-		.hip_parlx_err = 0.68,
-		.dist_ly = 147,
-	},
-	{
-		.name = "Gamma Ursae Minoris (Pherkad Major)",
-		.spec_type = "A3II",
-		.ra = 15.35,
-		.dec = 71.8,
-		.gal_lat = 40.8,
-		.gal_long = 108.5,
-		.mag_vis = 3,
-		.mag_abs = -2.84,
-		.hip_parlx = 6.79,
-		.hip_parlx_err = 0.46,
-		.dist_ly = 480,
-	},
-	{
-		.name = "Mu1 Scorpii",
-		.spec_type = "B1.5V+B6.5V",
-		.ra = 16.8666666666667,
-		.dec = -38,
-		.gal_lat = 3.9,
-		.gal_long = 346.1,
-		.mag_vis = 3,
-		.mag_abs = -4.01,
-		.hip_parlx = 3.97,
-		.hip_parlx_err = 1.2,
-		.dist_ly = 820,
-	},
-	{
-		.name = "Gamma Gruis",
-		.spec_type = "B8III",
-		.ra = 21.9,
-		.dec = -37.4,
-		.gal_lat = -51.5,
-		.gal_long = 6.1,
-		.mag_vis = 3,
-		.mag_abs = -0.97,
-		.hip_parlx = 16.07,
-		.hip_parlx_err = 0.77,
-		.dist_ly = 205,
-	},
-	{
-		.name = "Delta Persei",
-		.spec_type = "B5III",
-		.ra = 3.71666666666667,
-		.dec = 47.8,
-		.gal_lat = -5.8,
-		.gal_long = 150.3,
-		.mag_vis = 3.01,
-		.mag_abs = -3.04,
-		.hip_parlx = 6.18,
-		.hip_parlx_err = 0.85,
-		.dist_ly = 530,
-	},
-	{
-		.name = "Zeta Canis Majoris (Phurad)",
-		.spec_type = "B2.5V",
-		.ra = 6.33333333333333,
-		.dec = -30.1,
-		.gal_lat = -19.4,
-		.gal_long = 237.5,
-		.mag_vis = 3.02,
-		.mag_abs = -2.05,
-		.hip_parlx = 9.7,
-		.hip_parlx_err = 0.58,
-		.dist_ly = 340,
-	},
-	{
-		.name = "Omicron2 Canis Majoris",
-		.spec_type = "B3Ia",
-		.ra = 7.05,
-		.dec = -23.8,
-		.gal_lat = -8.2,
-		.gal_long = 235.6,
-		.mag_vis = 3.02,
-		.mag_abs = -6.46,
-		.hip_parlx = 1.27,
-		.hip_parlx_err = 0.56,
-		.dist_ly = 2600,
-	},
-	{
-		.name = "Epsilon Corvi (Minkar)",
-		.spec_type = "K2II",
-		.ra = 12.1666666666667,
-		.dec = -22.6,
-		.gal_lat = 39.3,
-		.gal_long = 290.6,
-		.mag_vis = 3.02,
-		.mag_abs = -1.82,
-		.hip_parlx = 10.75,
-		.hip_parlx_err = 0.71,
-		.dist_ly = 300,
-	},
-	{
-		.name = "Epsilon Aurigae (Almaaz)",
-		.spec_type = "F0Ia",
-		.ra = 5.03333333333333,
-		.dec = 43.8,
-		.gal_lat = 1.2,
-		.gal_long = 162.8,
-		.mag_vis = 3.03,
-		.mag_abs = -5.95,
-		.hip_parlx = 1.6,
-		.hip_parlx_err = 1.16,
-		.dist_ly = 2000,
-	},
-	{
-		.name = "Beta Muscae",
-		.spec_type = "B2V+B3V",
-		.ra = 12.7666666666667,
-		.dec = -68.1,
-		.gal_lat = -5.2,
-		.gal_long = 302.5,
-		.mag_vis = 3.04,
-		.mag_abs = -1.86,
-		.hip_parlx = 10.48,
-		.hip_parlx_err = 0.65,
-		.dist_ly = 310,
-	},
-	{
-		.name = "Gamma Bootis (Seginus)",
-		.spec_type = "A7III",
-		.ra = 14.5333333333333,
-		.dec = 38.3,
-		.gal_lat = 66.2,
-		.gal_long = 67.3,
-		.mag_vis = 3.04,
-		.mag_abs = 0.96,
-		.hip_parlx = 38.29,
-		.hip_parlx_err = 0.73,
-		.dist_ly = 85,
-	},
-	{
-		.name = "Beta Capricorni (Dabih)",
-		.spec_type = "G5II+A0V",
-		.ra = 20.35,
-		.dec = -14.8,
-		.gal_lat = -26.4,
-		.gal_long = 29.2,
-		.mag_vis = 3.05,
-		.mag_abs = -2.07,
-		.hip_parlx = 9.48,
-		.hip_parlx_err = 0.95,
-		.dist_ly = 340,
-	},
-	{
-		.name = "Epsilon Geminorum (Mebsuta)",
-		.spec_type = "G8Ib",
-		.ra = 6.73333333333333,
-		.dec = 25.1,
-		.gal_lat = 9.6,
-		.gal_long = 189.5,
-		.mag_vis = 3.06,
-		.mag_abs = -4.15,
-		.hip_parlx = 3.61,
-		.hip_parlx_err = 0.91,
-		.dist_ly = 900,
-	},
-	{
-		.name = "Mu Ursae Majoris (Tania Australis)",
-		.spec_type = "M0III",
-		.ra = 10.3666666666667,
-		.dec = 41.5,
-		.gal_lat = 56.4,
-		.gal_long = 177.9,
-		.mag_vis = 3.06,
-		.mag_abs = -1.35,
-		.hip_parlx = 13.11,
-		.hip_parlx_err = 0.75,
-		.dist_ly = 250,
-	},
-	{
-		.name = "Delta Draconis (Tais)",
-		.spec_type = "G9III",
-		.ra = 19.2166666666667,
-		.dec = 67.7,
-		.gal_lat = 23,
-		.gal_long = 98.7,
-		.mag_vis = 3.07,
-		.mag_abs = 0.63,
-		.hip_parlx = 32.54,
-		.hip_parlx_err = 0.46,
-		.dist_ly = 100,
-	},
-	{
-		.name = "Eta Sagittarii",
-		.spec_type = "M3.5III",
-		.ra = 18.3,
-		.dec = -36.8,
-		.gal_lat = -9.7,
-		.gal_long = 356.4,
-		.mag_vis = 3.1,
-		.mag_abs = -0.2,
-		.hip_parlx = 21.87,
-		.hip_parlx_err = 0.92,
-		.dist_ly = 149,
-	},
-	{
-		.name = "Zeta Hydrae",
-		.spec_type = "G9III",
-		.ra = 8.91666666666667,
-		.dec = 5.9,
-		.gal_lat = 30.2,
-		.gal_long = 222.3,
-		.mag_vis = 3.11,
-		.mag_abs = -0.21,
-		.hip_parlx = 21.64,
-		.hip_parlx_err = 0.99,
-		.dist_ly = 150,
-	},
-	{
-		.name = "Nu Hydrae",
-		.spec_type = "K2III",
-		.ra = 10.8333333333333,
-		.dec = -16.2,
-		.gal_lat = 37.6,
-		.gal_long = 265.1,
-		.mag_vis = 3.11,
-		.mag_abs = -0.03,
-		.hip_parlx = 23.54,
-		.hip_parlx_err = 0.81,
-		.dist_ly = 139,
-	},
-	{
-		.name = "Lambda Centauri",
-		.spec_type = "B9III",
-		.ra = 11.6,
-		.dec = -63,
-		.gal_lat = -1.4,
-		.gal_long = 294.5,
-		.mag_vis = 3.11,
-		.mag_abs = -2.39,
-		.hip_parlx = 7.96,
-		.hip_parlx_err = 0.52,
-		.dist_ly = 410,
-	},
-	{
-		.name = "Alpha Indi (Persian)",
-		.spec_type = "K0III",
-		.ra = 20.6333333333333,
-		.dec = -47.3,
-		.gal_lat = -37.2,
-		.gal_long = 352.6,
-		.mag_vis = 3.11,
-		.mag_abs = 0.65,
-		.hip_parlx = 32.21,
-		.hip_parlx_err = 0.75,
-		.dist_ly = 101,
-	},
-	{
-		.name = "Beta Columbae (Wazn)",
-		.spec_type = "K2III",
-		.ra = 5.85,
-		.dec = -35.8,
-		.gal_lat = -27.1,
-		.gal_long = 241.3,
-		.mag_vis = 3.12,
-		.mag_abs = 1.02,
-		.hip_parlx = 37.94,
-		.hip_parlx_err = 0.57,
-		.dist_ly = 86,
-	},
-	{
-		.name = "Iota Ursae Majoris (Talita)",
-		.spec_type = "A7IV",
-		.ra = 8.98333333333333,
-		.dec = 48,
-		.gal_lat = 40.8,
-		.gal_long = 171.5,
-		.mag_vis = 3.12,
-		.mag_abs = 2.29,
-		.hip_parlx = 68.32,
-		.hip_parlx_err = 0.79,
-		.dist_ly = 48,
-	},
-	{
-		.name = "Zeta Arae",
-		.spec_type = "K3II",
-		.ra = 16.9833333333333,
-		.dec = -56,
-		.gal_lat = -8.2,
-		.gal_long = 332.8,
-		.mag_vis = 3.12,
-		.mag_abs = -3.11,
-		.hip_parlx = 5.68,
-		.hip_parlx_err = 0.91,
-		.dist_ly = 570,
-	},
-	{
-		.name = "Delta Herculis (Sarin)",
-		.spec_type = "A3IV",
-		.ra = 17.25,
-		.dec = 24.8,
-		.gal_lat = 31.4,
-		.gal_long = 46.8,
-		.mag_vis = 3.12,
-		.mag_abs = 1.21,
-		.hip_parlx = 41.55,
-		.hip_parlx_err = 0.65,
-		.dist_ly = 78,
-	},
-	{
-		.name = "Kappa Centauri (Ke Kwan)",
-		.spec_type = "B2IV",
-		.ra = 14.9833333333333,
-		.dec = -42.1,
-		.gal_lat = 14.8,
-		.gal_long = 326.9,
-		.mag_vis = 3.13,
-		.mag_abs = -2.96,
-		.hip_parlx = 6.05,
-		.hip_parlx_err = 0.73,
-		.dist_ly = 540,
-	},
-	{
-		.name = "Alpha Lyncis",
-		.spec_type = "K7III",
-		.ra = 9.35,
-		.dec = 34.4,
-		.gal_lat = 44.7,
-		.gal_long = 190.2,
-		.mag_vis = 3.14,
-		.mag_abs = -1.02,
-		.hip_parlx = 14.69,
-		.hip_parlx_err = 0.81,
-		.dist_ly = 220,
-	},
+// Generated from stars.csv by gen-stars.pl.  Everything in it is const so
+// it stays in flash.
+#include "stars-gen.h"
+
+// Declination band height in degrees and the packed RA of the sky index
+#define STARS_BAND_DEG (180.0 / STARS_BANDS)
+#define STARS_RA_PACK(hours) ((unsigned int)((hours) * 65536 / 24))
+
+int _num_stars()
+{
+	return STARS_COUNT;
+}
+
+// Margin in degrees for the altitude pre-filter.  This covers refraction
+// (at most about 0.6 degrees at the horizon), aberration and float
+// rounding, so no star that ends up above min_alt is rejected early.
+#define STARS_ALT_MARGIN 1.0
+
+#define STARS_PI 3.14159265358979323846
+
+const char *star_name(int i)
+{
+	return stars_strings + stars[i].name;
+}
+
+const char *star_spec_type(int i)
+{
+	return stars_strings + stars[i].spec_type;
+}
+
+// J2000 right ascension in hours
+double star_ra(int i)
+{
+	double ra = atan2(stars[i].y, stars[i].x) * 12 / STARS_PI;
+
+	if (ra < 0)
+		ra += 24;
+
+	return ra;
+}
+
+// J2000 declination in degrees
+double star_dec(int i)
+{
+	return asin(stars[i].z) * 180 / STARS_PI;
+}
+
+double star_mag(int i)
+{
+	return stars[i].mag_vis / 100.0;
+}
+
+const star_info_t *star_info(int i)
+{
+	return &stars_info[i];
+}
+
+// Define star i as one of the user-defined Astronomy Engine bodies
+// (BODY_STAR1..BODY_STAR8).
+void star_define(astro_body_t body, int i)
+{
+	Astronomy_DefineStar(body, star_ra(i), star_dec(i), stars_info[i].dist_ly);
+}
+
+// Words in the mask of stars selected by stars_index_query().  Each query
+// has its own mask on the stack so concurrent queries do not collide.
+#define STARS_MASK_WORDS ((STARS_COUNT + 31) / 32)
+
+#define STARS_MASK_SET(mask, i) ((mask)[(i) / 32] |= 1UL << ((i) % 32))
+#define STARS_MASK_GET(mask, i) ((mask)[(i) / 32] & (1UL << ((i) % 32)))
+
+// Mark the stars in band b whose packed RA is within [ra_lo, ra_hi] and
+// that are within the cap given by its center c and min_dot = cos(radius).
+static int stars_band_visit(uint32_t *mask, int b, unsigned int ra_lo, unsigned int ra_hi,
+	const double *c, double min_dot)
+{
+	int lo = stars_band_start[b], hi = stars_band_start[b+1], mid, i, visited = 0;
+
+	// First entry in the band with RA >= ra_lo
+	while (lo < hi)
+	{
+		mid = (lo + hi) / 2;
+		if (stars_band_ra[mid] < ra_lo)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for (; lo < stars_band_start[b+1] && stars_band_ra[lo] <= ra_hi; lo++)
 	{
-		.name = "N Velorum",
-		.spec_type = "K5III",
-		.ra = 9.51666666666667,
-		.dec = -57,
-		.gal_lat = -4.1,
-		.gal_long = 278.2,
-		.mag_vis = 3.16,
-		.mag_abs = -1.15,
-		.hip_parlx = 13.72,
-		.hip_parlx_err = 0.51,
-		.dist_ly = 240,
-	},
+		i = stars_band_idx[lo];
+		visited++;
+
+		if (c[0]*stars[i].x + c[1]*stars[i].y + c[2]*stars[i].z >= min_dot)
+			STARS_MASK_SET(mask, i);
+	}
+
+	return visited;
+}
+
+// Mark every star within radius degrees of the J2000 unit vector c in
+// mask.  Only the declination bands the cap touches are visited,
+// and within each band only the RA range the cap can span.  Returns the
+// number of stars that were looked at.
+static int stars_index_query(uint32_t *mask, const double *c, double radius)
+{
+	double ra, dec, dec_lo, dec_hi, dra, min_dot, s, lo, hi;
+	int b, b_lo, b_hi, full, visited = 0;
+
+	memset(mask, 0, STARS_MASK_WORDS * sizeof(*mask));
+
+	if (radius >= 180)
 	{
-		.name = "Pi Herculis",
-		.spec_type = "K3II",
-		.ra = 17.25,
-		.dec = 36.8,
-		.gal_lat = 34.3,
-		.gal_long = 60.7,
-		.mag_vis = 3.16,
-		.mag_abs = -2.1,
-		.hip_parlx = 8.89,
-		.hip_parlx_err = 0.52,
-		.dist_ly = 370,
-	},
-	// Kepler 22b
-	// https://en.wikipedia.org/wiki/Kepler-22
-	// https://en.wikipedia.org/wiki/Kepler-22b
+		for (b = 0; b < STARS_COUNT; b++)
+			STARS_MASK_SET(mask, b);
+
+		return STARS_COUNT;
+	}
+
+	min_dot = cos(radius * STARS_PI / 180);
+
+	ra = atan2(c[1], c[0]) * 12 / STARS_PI;
+	dec = asin(c[2]) * 180 / STARS_PI;
+
+	dec_lo = dec - radius;
+	dec_hi = dec + radius;
+
+	// The RA half-width of a cap is asin(sin(r)/cos(dec)), unless the
+	// cap contains a pole.
+	full = dec_lo <= -90 || dec_hi >= 90;
+	dra = 12;
+	if (!full)
+	{
+		s = sin(radius * STARS_PI / 180) / cos(dec * STARS_PI / 180);
+		if (s >= 1)
+			full = 1;
+		else
+			dra = asin(s) * 12 / STARS_PI;
+	}
+
+	b_lo = (fmax(dec_lo, -90) + 90) / STARS_BAND_DEG;
+	b_hi = (fmin(dec_hi, 90) + 90) / STARS_BAND_DEG;
+	if (b_hi >= STARS_BANDS)
+		b_hi = STARS_BANDS - 1;
+
+	// RA window in hours, possibly wrapping through 0h
+	lo = ra - dra;
+	hi = ra + dra;
+	if (lo < 0)
+	{
+		lo += 24;
+		hi += 24;
+	}
+
+	for (b = b_lo; b <= b_hi; b++)
+	{
+		if (full)
+			visited += stars_band_visit(mask, b, 0, 0xFFFF, c, min_dot);
+		else if (hi >= 24)
+		{
+			visited += stars_band_visit(mask, b, STARS_RA_PACK(lo), 0xFFFF, c, min_dot);
+			visited += stars_band_visit(mask, b, 0, STARS_RA_PACK(hi - 24) + 1, c, min_dot);
+		}
+		else
+			visited += stars_band_visit(mask, b, STARS_RA_PACK(lo), STARS_RA_PACK(hi) + 1, c, min_dot);
+	}
+
+	return visited;
+}
+
+typedef struct
+{
+	// J2000 equatorial to horizontal of date (north, west, zenith)
+	astro_rotation_t rot;
+
+	// Earth's barycentric velocity as a fraction of the speed of light
+	double vx, vy, vz;
+
+	astro_time_t time;
+} stars_frame_t;
+
+// Precession, nutation and the observer frame are combined into one
+// rotation per request instead of per star.
+static int stars_frame(stars_frame_t *f, astro_time_t *time, astro_observer_t observer)
+{
+	astro_state_vector_t earth;
+
+	f->rot = Astronomy_CombineRotation(
+		Astronomy_Rotation_EQJ_EQD(time),
+		Astronomy_Rotation_EQD_HOR(time, observer));
+	if (f->rot.status != ASTRO_SUCCESS)
+		return 0;
+
+	earth = Astronomy_BaryState(BODY_EARTH, *time);
+	f->vx = earth.vx / C_AUDAY;
+	f->vy = earth.vy / C_AUDAY;
+	f->vz = earth.vz / C_AUDAY;
+
+	f->time = *time;
+
+	return 1;
+}
+
+// Apparent horizontal position of star i with annual aberration and
+// refraction.  lat is the altitude and lon is the azimuth.
+static astro_spherical_t stars_frame_horizon(stars_frame_t *f, int i)
+{
+	astro_vector_t vec;
+	double len;
+
+	vec.x = stars[i].x + f->vx;
+	vec.y = stars[i].y + f->vy;
+	vec.z = stars[i].z + f->vz;
+	len = sqrt(vec.x*vec.x + vec.y*vec.y + vec.z*vec.z);
+	vec.x /= len;
+	vec.y /= len;
+	vec.z /= len;
+	vec.t = f->time;
+	vec.status = ASTRO_SUCCESS;
+
+	vec = Astronomy_RotateVector(f->rot, vec);
+
+	return Astronomy_HorizonFromVector(vec, REFRACTION_NORMAL);
+}
+
+// Call cb(idx, az, alt, arg) in catalog order for every star marked in
+// mask that is above min_alt.
+static int stars_mask_horizon(stars_frame_t *f, const uint32_t *mask, double min_alt,
+	void (*cb)(int idx, double az, double alt, void *arg), void *arg)
+{
+	astro_spherical_t hor;
+	int i, count = 0;
+
+	for (i = 0; i < STARS_COUNT; i++)
 	{
-		.name = "Kepler 22",
-		.spec_type = "?",
-		.ra = 19+16/60. + 52.19023/3600.,
-		.dec = 47 + 53/60. +  3.9486/3600,
-		.gal_lat = NAN,  // unknown
-		.gal_long = NAN, // unknown
-		.mag_vis = 11.664,
-		.mag_abs = 5.27,
-		.hip_parlx = 5.0627,
-		.hip_parlx_err = 0.011,
-		.dist_ly = 644,
-	},
-};
+		if (!STARS_MASK_GET(mask, i))
+			continue;
 
-int _num_stars()
+		hor = stars_frame_horizon(f, i);
+		if (hor.status != ASTRO_SUCCESS || hor.lat <= min_alt)
+			continue;
+
+		cb(i, hor.lon, hor.lat, arg);
+		count++;
+	}
+
+	return count;
+}
+
+// Compute the horizontal position of every star above min_alt degrees and
+// call cb(idx, az, alt, arg) for each one in catalog order.  Stars above
+// min_alt are within 90-min_alt degrees of the zenith, so the sky index
+// only visits the bands and RA ranges under that cap and the rest of the
+// catalog is never touched.  Returns the number of stars passed to cb.
+int stars_horizon(astro_time_t *time, astro_observer_t observer, double min_alt,
+	void (*cb)(int idx, double az, double alt, void *arg), void *arg)
+{
+	stars_frame_t f;
+	uint32_t mask[STARS_MASK_WORDS];
+	double zenith[3];
+
+	if (!stars_frame(&f, time, observer))
+		return 0;
+
+	// rot.rot[j][2] maps J2000 axis j onto the zenith, so that column is
+	// the zenith in J2000.
+	zenith[0] = f.rot.rot[0][2];
+	zenith[1] = f.rot.rot[1][2];
+	zenith[2] = f.rot.rot[2][2];
+
+	if (isfinite(min_alt))
+		stars_index_query(mask, zenith, 90 - min_alt + STARS_ALT_MARGIN);
+	else
+		stars_index_query(mask, zenith, 180);
+
+	return stars_mask_horizon(&f, mask, min_alt, cb, arg);
+}
+
+// Call cb(idx, az, alt, arg) for every star within radius degrees of the
+// pointing direction az/el (degrees), for example the current rotor
+// position when calibrating the pointing model.  Returns the number of
+// stars passed to cb.
+int stars_near(astro_time_t *time, astro_observer_t observer,
+	double az, double el, double radius,
+	void (*cb)(int idx, double az, double alt, void *arg), void *arg)
 {
-	return (sizeof(stars)/sizeof(star_t));
+	stars_frame_t f;
+	uint32_t mask[STARS_MASK_WORDS];
+	double h[3], c[3];
+	int j;
+
+	if (!stars_frame(&f, time, observer))
+		return 0;
+
+	az *= STARS_PI / 180;
+	el *= STARS_PI / 180;
+
+	// Horizontal frame is north, west, zenith
+	h[0] = cos(el) * cos(az);
+	h[1] = -cos(el) * sin(az);
+	h[2] = sin(el);
+
+	// Rotate back to J2000 with the transpose
+	for (j = 0; j < 3; j++)
+		c[j] = f.rot.rot[j][0]*h[0] + f.rot.rot[j][1]*h[1] + f.rot.rot[j][2]*h[2];
+
+	stars_index_query(mask, c, radius);
+
+	return stars_mask_horizon(&f, mask, -INFINITY, cb, arg);
 }
@@ -20,6 +20,7 @@
 //
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
 
 // Returns 1 if a and b match.
 int match(char *a, char *b)
@@ -140,3 +141,31 @@ char *lltoa(long long val, int base)
 	}
 	return &buf[i + 1];
 }
+
+// CRC-32 (IEEE 802.3) four bits at a time.  Pass the previous result as
+// crc to continue a CRC over more data, or 0 to start one.
+uint32_t crc32_ieee_update(uint32_t crc, const void *data, int len)
+{
+	static const uint32_t tab[16] = {
+		0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+		0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+		0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+		0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+	};
+	const uint8_t *p = data;
+
+	crc = ~crc;
+	while (len-- > 0)
+	{
+		crc ^= *p++;
+		crc = (crc >> 4) ^ tab[crc & 15];
+		crc = (crc >> 4) ^ tab[crc & 15];
+	}
+
+	return ~crc;
+}
+
+uint32_t crc32_ieee(const void *data, int len)
+{
+	return crc32_ieee_update(0, data, len);
+}
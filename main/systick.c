@@ -22,21 +22,40 @@
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
+#include <string.h>
 
 #include "platform.h"
 
 #include "rotor.h"
 #include "config.h"
+#include "tlog.h"
+#include "systick.h"
+
+#ifdef __ESP32__
+#include "esp_timer.h"
+#endif
+
+// pid_update_task() interval on the ESP32
+#define SYSTICK_TASK_MS 10
 
 static volatile int _systick_bypass = 0;
 static volatile int ticks_per_sec = 1000;
 
+// Number of pid_update() calls, for the telemetry log
+static volatile uint32_t pid_ticks = 0;
+
+// Interval between pid_update() calls
+jitter_t pid_jitter;
+
 void pid_update()
 {
 	struct motor *motor;
 	struct rotor *rotor;
 	int i;
 
+	pid_ticks++;
+	jitter_mark(&pid_jitter, 1000000 / systick_hz());
+
 	// Bypass non-systick code.  Really this should be moved to an RTC IRQ
 	// and let systick be turned off completely.
 	if (_systick_bypass)
@@ -69,6 +88,8 @@ void pid_update()
 			if (rotor->error_count > rotor->error_count_max)
 				motor_speed(motor, 0);
 
+			tlog_sample(pid_ticks, i, rpos, motor->speed);
+
 			continue;
 		}
 		else
@@ -133,6 +154,8 @@ void pid_update()
 		}
 
 		motor_speed(motor, newspeed);
+
+		tlog_sample(pid_ticks, i, rpos, newspeed);
 	}
 }
 
@@ -151,7 +174,7 @@ int systick_update()
 #ifdef __ESP32__
 void pid_update_task(void *arg)
 {
-	TickType_t interval = 10/portTICK_PERIOD_MS;
+	TickType_t interval = SYSTICK_TASK_MS/portTICK_PERIOD_MS;
 	TickType_t now = xTaskGetTickCount();
 
 	while (1)
@@ -165,6 +188,11 @@ void pid_update_task(void *arg)
 int systick_init(int tps)
 {
 #ifdef __EFR32__
+	// Start the cycle counter for systick_clock()
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
 	ticks_per_sec = tps;
 	return systick_update();
 #else
@@ -177,3 +205,90 @@ void systick_bypass(int b)
 {
 	_systick_bypass = b;
 }
+
+// pid_update() calls per second
+int systick_hz()
+{
+#ifdef __EFR32__
+	return ticks_per_sec;
+#else
+	return 1000 / SYSTICK_TASK_MS;
+#endif
+}
+
+// Free running clock for measuring intervals, it wraps around
+uint32_t systick_clock()
+{
+#if defined(__EFR32__)
+	return DWT->CYCCNT;
+#elif defined(__ESP32__)
+	return esp_timer_get_time();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+uint32_t systick_clock_hz()
+{
+#if defined(__EFR32__)
+	return CMU_ClockFreqGet(cmuClock_CORE);
+#else
+	return 1000000;
+#endif
+}
+
+// Record one run of a job that should run every period_us microseconds.
+// Runs more than 1.5 periods apart count as late.  This is called from
+// pid_update(), so intervals are kept in systick_clock() units and only
+// converted to microseconds by jitter_print().
+void jitter_mark(jitter_t *j, uint32_t period_us)
+{
+	uint32_t now = systick_clock(), d, late;
+
+	if (j->started)
+	{
+		d = now - j->last;
+		late = period_us * (systick_clock_hz() / 1000000);
+		late += late / 2;
+
+		if (j->count == 0 || d < j->min)
+			j->min = d;
+		if (d > j->max)
+			j->max = d;
+		if (d > late)
+			j->late++;
+
+		j->sum += d;
+		j->count++;
+	}
+
+	j->last = now;
+	j->started = 1;
+}
+
+void jitter_reset(jitter_t *j)
+{
+	memset(j, 0, sizeof(*j));
+}
+
+void jitter_print(const char *name, jitter_t *j)
+{
+	uint32_t mhz = systick_clock_hz() / 1000000;
+
+	if (j->count == 0)
+	{
+		printf("%s: no runs\r\n", name);
+		return;
+	}
+
+	printf("%s: %lu runs, interval min %lu avg %lu max %lu us, %lu late\r\n",
+		name,
+		(unsigned long)j->count,
+		(unsigned long)(j->min / mhz),
+		(unsigned long)(j->sum / j->count / mhz),
+		(unsigned long)(j->max / mhz),
+		(unsigned long)j->late);
+}
@@ -0,0 +1,666 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+
+#include "ff.h"
+#include "fatfs-util.h"
+
+#include "rotor.h"
+#include "i2c.h"
+#include "rtcc.h"
+#include "systick.h"
+#include "strutil.h"
+#include "tlog.h"
+
+// Each block is a tlog_block_t followed by the samples as a bit stream,
+// most significant bit first.  A sample is
+//
+//   rotor          2 bits
+//   tick           0 if the tick is the expected one: the same as the
+//                  previous sample's for a higher rotor number, else the
+//                  next one.  Otherwise 1 and the tick delta.
+//   flags          0, or 1 and TLOG_POS_NAN and TLOG_GAP in 2 bits
+//   age            change of the sensor age
+//   target         target - prediction
+//   pos            pos - prediction, not present with TLOG_POS_NAN
+//   out            change of the motor speed
+//
+// target is predicted linearly from the rotor's previous two targets and
+// pos from the previous position and a smoothed velocity, which follows
+// a slewing rotor without amplifying sensor noise.  Numbers are signed
+// values zigzag-mapped to unsigned and written as Rice codes: the value
+// shifted right by k in unary, then its low k bits.  k follows the mean
+// of the recent values of each field and rotor, so a field that does not
+// change costs one bit and sensor noise of a few counts costs a few bits.
+// All prediction and Rice state restarts in every block so that blocks can
+// be decoded on their own.
+
+// Rice quotient at which the value is written in 32 bits instead
+#define TLOG_RICE_ESCAPE 16
+
+// Halve the Rice statistics after this many values so k can adapt
+#define TLOG_RICE_RESET 32
+
+// Rice statistics of one field
+typedef struct
+{
+	// Sum and number of the recent values
+	uint32_t a;
+	uint32_t n;
+} tlog_rice_t;
+
+typedef struct
+{
+	int32_t target[2], pos;
+
+	// Smoothed position change per tick, times 4
+	int32_t vel;
+
+	// Number of targets in target[] up to 2, and of positions
+	int nt, np;
+
+	int16_t out;
+	uint8_t age;
+
+	tlog_rice_t r_age, r_target, r_pos, r_out;
+} tlog_pred_t;
+
+// Encoder and decoder state of a block
+typedef struct
+{
+	tlog_pred_t pred[NUM_ROTORS];
+	tlog_rice_t r_tick;
+
+	uint32_t tick;
+	int rotor;
+} tlog_state_t;
+
+typedef struct
+{
+	uint8_t *p;
+
+	// Bits written or read, and the size of p in bits
+	int bits, max;
+} tlog_bits_t;
+
+static struct
+{
+	FIL fp;
+	char filename[32];
+
+	// The file is open / pid_update() adds samples
+	volatile int active, capture;
+
+	tlog_sample_t ring[TLOG_RING];
+	volatile uint32_t head, tail;
+
+	// Samples were dropped since the last one in the ring
+	volatile int gap;
+	volatile uint32_t dropped;
+
+	// blk[cur] is being filled, blk[pending] waits to be written
+	uint8_t blk[2][TLOG_BLOCK_SIZE];
+	int cur, pending, filling;
+
+	tlog_state_t state;
+	tlog_bits_t bits;
+
+	uint32_t seq, samples, blocks, ring_max;
+	uint64_t sample_bits;
+} tlog;
+
+// Bits past w->max are counted but not stored, so the caller can see
+// that a sample did not fit.
+static void tlog_put_bits(tlog_bits_t *w, uint32_t v, int n)
+{
+	while (n-- > 0)
+	{
+		if (w->bits < w->max && ((v >> n) & 1))
+			w->p[w->bits >> 3] |= 0x80 >> (w->bits & 7);
+
+		w->bits++;
+	}
+}
+
+// Clear the bits of w from bit on, after a sample did not fit
+static void tlog_clear_bits(tlog_bits_t *w, int bit)
+{
+	for (; bit < w->bits && bit < w->max; bit++)
+		w->p[bit >> 3] &= ~(0x80 >> (bit & 7));
+}
+
+// Bits past r->max read as 0, check r->bits afterwards
+static uint32_t tlog_get_bits(tlog_bits_t *r, int n)
+{
+	uint32_t v = 0;
+
+	while (n-- > 0)
+	{
+		v <<= 1;
+		if (r->bits < r->max)
+			v |= (r->p[r->bits >> 3] >> (7 - (r->bits & 7))) & 1;
+
+		r->bits++;
+	}
+
+	return v;
+}
+
+static void tlog_rice_init(tlog_rice_t *c)
+{
+	c->a = 2;
+	c->n = 1;
+}
+
+static int tlog_rice_k(const tlog_rice_t *c)
+{
+	int k = 0;
+
+	while ((c->n << k) < c->a && k < 24)
+		k++;
+
+	return k;
+}
+
+static void tlog_rice_update(tlog_rice_t *c, uint32_t u)
+{
+	c->a += u;
+	c->n++;
+
+	if (c->n >= TLOG_RICE_RESET)
+	{
+		c->a >>= 1;
+		c->n >>= 1;
+	}
+}
+
+static void tlog_put_rice(tlog_bits_t *w, tlog_rice_t *c, int32_t v)
+{
+	uint32_t u = ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+	int k = tlog_rice_k(c);
+	uint32_t q = u >> k;
+
+	// Escaped values, like the first one of a field in a block, are
+	// left out of the statistics so they do not inflate k.
+	if (q < TLOG_RICE_ESCAPE)
+	{
+		tlog_put_bits(w, ((1UL << q) - 1) << 1, q + 1);
+		tlog_put_bits(w, u, k);
+		tlog_rice_update(c, u);
+	}
+	else
+	{
+		tlog_put_bits(w, (1UL << TLOG_RICE_ESCAPE) - 1, TLOG_RICE_ESCAPE);
+		tlog_put_bits(w, u, 32);
+	}
+}
+
+static int32_t tlog_get_rice(tlog_bits_t *r, tlog_rice_t *c)
+{
+	int k = tlog_rice_k(c);
+	uint32_t q = 0, u;
+
+	while (q < TLOG_RICE_ESCAPE && tlog_get_bits(r, 1))
+		q++;
+
+	if (q < TLOG_RICE_ESCAPE)
+	{
+		u = (q << k) | tlog_get_bits(r, k);
+		tlog_rice_update(c, u);
+	}
+	else
+		u = tlog_get_bits(r, 32);
+
+	return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+static void tlog_state_init(tlog_state_t *st, uint32_t tick)
+{
+	int i;
+
+	memset(st, 0, sizeof(*st));
+
+	for (i = 0; i < NUM_ROTORS; i++)
+	{
+		tlog_rice_init(&st->pred[i].r_age);
+		tlog_rice_init(&st->pred[i].r_target);
+		tlog_rice_init(&st->pred[i].r_pos);
+		tlog_rice_init(&st->pred[i].r_out);
+	}
+
+	tlog_rice_init(&st->r_tick);
+
+	st->tick = tick;
+	st->rotor = -1;
+}
+
+static int32_t tlog_predict_target(const tlog_pred_t *pr)
+{
+	if (pr->nt >= 2)
+		return 2 * pr->target[0] - pr->target[1];
+	else if (pr->nt == 1)
+		return pr->target[0];
+
+	return 0;
+}
+
+static void tlog_update_target(tlog_pred_t *pr, int32_t target)
+{
+	pr->target[1] = pr->target[0];
+	pr->target[0] = target;
+
+	if (pr->nt < 2)
+		pr->nt++;
+}
+
+static int32_t tlog_predict_pos(const tlog_pred_t *pr)
+{
+	return pr->pos + pr->vel / 4;
+}
+
+static void tlog_update_pos(tlog_pred_t *pr, int32_t pos)
+{
+	if (pr->np > 0)
+		pr->vel += ((pos - pr->pos) * 4 - pr->vel) / 4;
+
+	pr->pos = pos;
+	pr->np++;
+}
+
+// The tick delta that costs one bit
+static uint32_t tlog_expected_tick(const tlog_state_t *st, int rotor)
+{
+	return rotor > st->rotor ? 0 : 1;
+}
+
+static void tlog_encode(tlog_state_t *st, tlog_bits_t *w, const tlog_sample_t *s)
+{
+	tlog_pred_t *pr = &st->pred[s->rotor];
+	uint32_t dt = s->tick - st->tick;
+
+	tlog_put_bits(w, s->rotor, 2);
+
+	if (dt == tlog_expected_tick(st, s->rotor))
+		tlog_put_bits(w, 0, 1);
+	else
+	{
+		tlog_put_bits(w, 1, 1);
+		tlog_put_rice(w, &st->r_tick, dt);
+	}
+
+	st->tick = s->tick;
+	st->rotor = s->rotor;
+
+	if (s->flags)
+	{
+		tlog_put_bits(w, 1, 1);
+		tlog_put_bits(w, s->flags, 2);
+	}
+	else
+		tlog_put_bits(w, 0, 1);
+
+	tlog_put_rice(w, &pr->r_age, s->age - pr->age);
+	pr->age = s->age;
+
+	tlog_put_rice(w, &pr->r_target, s->target - tlog_predict_target(pr));
+	tlog_update_target(pr, s->target);
+
+	if (!(s->flags & TLOG_POS_NAN))
+	{
+		tlog_put_rice(w, &pr->r_pos, s->pos - tlog_predict_pos(pr));
+		tlog_update_pos(pr, s->pos);
+	}
+
+	tlog_put_rice(w, &pr->r_out, s->out - pr->out);
+	pr->out = s->out;
+}
+
+// Called from pid_update() for each rotor it runs.  pos is NAN if
+// rotor_pos() failed.  When the ring is full the sample is dropped and the
+// next one is marked with TLOG_GAP.
+void tlog_sample(uint32_t tick, int rotor, float pos, float out)
+{
+	struct rotor *r = &rotors[rotor];
+	tlog_sample_t *s;
+	i2c_req_t *req;
+	uint32_t now;
+
+	if (!tlog.capture)
+		return;
+
+	if (tlog.head - tlog.tail >= TLOG_RING)
+	{
+		tlog.dropped++;
+		tlog.gap = 1;
+		return;
+	}
+
+	s = &tlog.ring[tlog.head % TLOG_RING];
+
+	now = rtcc_get();
+
+	s->tick = tick;
+	s->rtcc = now;
+	s->rotor = rotor;
+	s->flags = tlog.gap ? TLOG_GAP : 0;
+	s->target = lroundf(r->target * TLOG_DEG_SCALE);
+	s->out = lroundf(out * TLOG_OUT_SCALE);
+
+	if (isnan(pos))
+	{
+		s->flags |= TLOG_POS_NAN;
+		s->pos = 0;
+	}
+	else
+		s->pos = lroundf(pos * TLOG_DEG_SCALE);
+
+	req = i2c_req_get_cont(r->adc_addr);
+	if (r->adc_type == ADC_TYPE_INTERNAL || req == NULL || !req->valid)
+		s->age = TLOG_AGE_UNKNOWN;
+	else if (now - req->complete_ticks < TLOG_AGE_UNKNOWN)
+		s->age = now - req->complete_ticks;
+	else
+		s->age = TLOG_AGE_UNKNOWN - 1;
+
+	tlog.gap = 0;
+
+	// The sample must be complete before tlog_step() can see it
+	__sync_synchronize();
+	tlog.head++;
+}
+
+static void tlog_block_begin(const tlog_sample_t *s)
+{
+	tlog_block_t *b = (tlog_block_t *)tlog.blk[tlog.cur];
+	int tps = rtcc_ticks_per_sec();
+	uint64_t now = rtcc_get(), t;
+
+	memset(tlog.blk[tlog.cur], 0, TLOG_BLOCK_SIZE);
+
+	// Extend the sample's 32 bit rtcc time to 64 bits
+	t = now - (uint32_t)((uint32_t)now - s->rtcc);
+
+	b->magic = TLOG_MAGIC;
+	b->version = TLOG_VERSION;
+	b->hz = systick_hz();
+	b->seq = tlog.seq++;
+	b->tick = s->tick;
+	b->time = t / tps;
+	b->frac = t % tps;
+	b->tps = tps;
+	b->dropped = tlog.dropped;
+
+	tlog_state_init(&tlog.state, s->tick);
+
+	tlog.bits.p = (uint8_t *)(b + 1);
+	tlog.bits.bits = 0;
+	tlog.bits.max = (TLOG_BLOCK_SIZE - sizeof(*b)) * 8;
+
+	tlog.filling = 1;
+}
+
+static void tlog_block_end()
+{
+	tlog_block_t *b = (tlog_block_t *)tlog.blk[tlog.cur];
+
+	b->len = (tlog.bits.bits + 7) / 8;
+	b->crc = crc32_ieee(&b->magic, sizeof(*b) - sizeof(b->crc) + b->len);
+
+	tlog.pending = tlog.cur;
+	tlog.cur ^= 1;
+	tlog.filling = 0;
+}
+
+static void tlog_close()
+{
+	FRESULT res;
+
+	tlog.capture = 0;
+	tlog.active = 0;
+
+	res = f_close(&tlog.fp);
+	if (res != FR_OK)
+		printf("%s: close error %d: %s\r\n", tlog.filename, res, ff_strerror(res));
+}
+
+// Returns 0 and stops logging if the block could not be written
+static int tlog_write()
+{
+	FRESULT res;
+	UINT bw;
+
+	res = f_write(&tlog.fp, tlog.blk[tlog.pending], TLOG_BLOCK_SIZE, &bw);
+	if (res == FR_OK && bw != TLOG_BLOCK_SIZE)
+	{
+		printf("%s: flash is full, logging stopped\r\n", tlog.filename);
+		tlog_close();
+		return 0;
+	}
+	else if (res != FR_OK)
+	{
+		printf("%s: write error %d: %s, logging stopped\r\n",
+			tlog.filename, res, ff_strerror(res));
+		tlog_close();
+		return 0;
+	}
+
+	tlog.pending = -1;
+	tlog.blocks++;
+
+	if (tlog.blocks % TLOG_SYNC_BLOCKS == 0)
+		f_sync(&tlog.fp);
+
+	return 1;
+}
+
+// Background work, called from main_idle(): write a finished block if
+// there is one, then encode up to TLOG_CHUNK samples.  When both blocks
+// are full the samples stay in the ring until the next call.
+void tlog_step()
+{
+	const tlog_sample_t *s;
+	tlog_state_t st;
+	tlog_bits_t w;
+	tlog_block_t *b;
+	int i;
+
+	if (!tlog.active)
+		return;
+
+	if (tlog.pending >= 0 && !tlog_write())
+		return;
+
+	if (tlog.head - tlog.tail > tlog.ring_max)
+		tlog.ring_max = tlog.head - tlog.tail;
+
+	for (i = 0; i < TLOG_CHUNK && tlog.tail != tlog.head; i++)
+	{
+		s = &tlog.ring[tlog.tail % TLOG_RING];
+
+		if (!tlog.filling)
+			tlog_block_begin(s);
+
+		b = (tlog_block_t *)tlog.blk[tlog.cur];
+
+		st = tlog.state;
+		w = tlog.bits;
+		tlog_encode(&st, &w, s);
+
+		// The sample goes into the next block, where the prediction
+		// starts over.
+		if (w.bits > w.max)
+		{
+			tlog_clear_bits(&w, tlog.bits.bits);
+
+			if (tlog.pending >= 0)
+				break;
+
+			tlog_block_end();
+			continue;
+		}
+
+		tlog.sample_bits += w.bits - tlog.bits.bits;
+		tlog.state = st;
+		tlog.bits = w;
+
+		b->count++;
+		tlog.samples++;
+
+		tlog.tail++;
+	}
+}
+
+int tlog_start(char *filename)
+{
+	FRESULT res;
+
+	tlog_stop();
+
+	snprintf(tlog.filename, sizeof(tlog.filename), "%s", filename);
+
+	res = f_open(&tlog.fp, tlog.filename, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res != FR_OK)
+	{
+		printf("%s: open error %d: %s\r\n", tlog.filename, res, ff_strerror(res));
+		return -1;
+	}
+
+	tlog.head = tlog.tail = 0;
+	tlog.gap = 0;
+	tlog.dropped = 0;
+	tlog.cur = 0;
+	tlog.pending = -1;
+	tlog.filling = 0;
+	tlog.seq = tlog.samples = tlog.blocks = tlog.ring_max = 0;
+	tlog.sample_bits = 0;
+
+	tlog.active = 1;
+	tlog.capture = 1;
+
+	return 0;
+}
+
+// Stop adding samples, then write everything that is left
+void tlog_stop()
+{
+	if (!tlog.active)
+		return;
+
+	tlog.capture = 0;
+
+	while (tlog.active && (tlog.tail != tlog.head || tlog.filling || tlog.pending >= 0))
+	{
+		if (tlog.tail == tlog.head && tlog.pending < 0)
+			tlog_block_end();
+
+		tlog_step();
+	}
+
+	if (tlog.active)
+		tlog_close();
+}
+
+void tlog_status()
+{
+	printf("tlog: %s %s\r\n"
+		"  samples:   %lu, %lu dropped, ring %lu/%d max\r\n"
+		"  blocks:    %lu (%lu bytes)\r\n",
+		tlog.filename[0] ? tlog.filename : TLOG_FILE,
+		tlog.capture ? "logging" : "stopped",
+		(unsigned long)tlog.samples, (unsigned long)tlog.dropped,
+		(unsigned long)tlog.ring_max, TLOG_RING,
+		(unsigned long)tlog.blocks, (unsigned long)tlog.blocks * TLOG_BLOCK_SIZE);
+
+	if (tlog.samples)
+		printf("  encoded:   %0.2f bytes/sample, %0.2f with block overhead\r\n",
+			(float)tlog.sample_bits / 8 / tlog.samples,
+			(float)tlog.blocks * TLOG_BLOCK_SIZE / tlog.samples);
+}
+
+// Check a block and call cb() for each of its samples.  tlog_sample_t.rtcc
+// is not stored and is 0.  Returns the number of samples, or -1 if the
+// block is not valid.
+int tlog_decode(const void *block, void (*cb)(const tlog_block_t *b, const tlog_sample_t *s, void *arg), void *arg)
+{
+	const tlog_block_t *b = block;
+	tlog_state_t st;
+	tlog_sample_t s;
+	tlog_pred_t *pr;
+	tlog_bits_t r;
+	int i;
+
+	if (b->magic != TLOG_MAGIC || b->version != TLOG_VERSION ||
+		b->len > TLOG_BLOCK_SIZE - sizeof(*b) ||
+		crc32_ieee(&b->magic, sizeof(*b) - sizeof(b->crc) + b->len) != b->crc)
+		return -1;
+
+	tlog_state_init(&st, b->tick);
+
+	r.p = (uint8_t *)(b + 1);
+	r.bits = 0;
+	r.max = b->len * 8;
+
+	for (i = 0; i < b->count; i++)
+	{
+		memset(&s, 0, sizeof(s));
+
+		s.rotor = tlog_get_bits(&r, 2);
+		pr = &st.pred[s.rotor];
+
+		if (tlog_get_bits(&r, 1))
+			st.tick += tlog_get_rice(&r, &st.r_tick);
+		else
+			st.tick += tlog_expected_tick(&st, s.rotor);
+
+		st.rotor = s.rotor;
+		s.tick = st.tick;
+
+		if (tlog_get_bits(&r, 1))
+			s.flags = tlog_get_bits(&r, 2);
+
+		pr->age += tlog_get_rice(&r, &pr->r_age);
+		s.age = pr->age;
+
+		s.target = tlog_predict_target(pr) + tlog_get_rice(&r, &pr->r_target);
+		tlog_update_target(pr, s.target);
+
+		if (!(s.flags & TLOG_POS_NAN))
+		{
+			s.pos = tlog_predict_pos(pr) + tlog_get_rice(&r, &pr->r_pos);
+			tlog_update_pos(pr, s.pos);
+		}
+
+		pr->out += tlog_get_rice(&r, &pr->r_out);
+		s.out = pr->out;
+
+		if (r.bits > r.max)
+			return -1;
+
+		cb(b, &s, arg);
+	}
+
+	return b->count;
+}
@@ -0,0 +1,692 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+// ZMODEM receiver.
+//
+// XMODEM waits for an ACK after every block, so at 57600 baud a good part
+// of an upload is spent turning the line around.  ZMODEM streams data
+// subpackets, each with a CRC-32, and only stops when the receiver asks
+// it to.  The ZRINIT header tells the sender our buffer is one subpacket
+// short of ZMODEM_WINDOW bytes, so it ends every window with a ZCRCW
+// subpacket that still fits and waits for a ZACK.  Data is kept in RAM
+// until then and handed to the sink while the sender is waiting, so
+// flash writes never overrun the serial ring.
+//
+// A bad subpacket is answered with ZRPOS at the last good byte and the
+// sender continues from there.  The good subpackets before it are kept.
+// When the sender asks to resume a file (sz -r), the sink can return the
+// length it already has and only the rest is sent.
+//
+// Only receiving is implemented; use xmodem_tx() to send.  Headers are
+// read in all three formats (hex, binary with CRC-16 and with CRC-32) and
+// sent as hex.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+#include "serial.h"
+#include "rtcc.h"
+#include "strutil.h"
+#include "zmodem.h"
+
+#define ZPAD   '*'
+#define ZDLE   0x18
+#define ZBIN   'A'
+#define ZHEX   'B'
+#define ZBIN32 'C'
+
+// Frame types
+#define ZRQINIT    0
+#define ZRINIT     1
+#define ZSINIT     2
+#define ZACK       3
+#define ZFILE      4
+#define ZSKIP      5
+#define ZNAK       6
+#define ZABORT     7
+#define ZFIN       8
+#define ZRPOS      9
+#define ZDATA      10
+#define ZEOF       11
+#define ZFERR      12
+#define ZCRC       13
+#define ZCHALLENGE 14
+#define ZCOMPL     15
+#define ZCAN       16
+#define ZFREECNT   17
+#define ZCOMMAND   18
+
+// Subpacket ends, after ZDLE
+#define ZCRCE 'h'
+#define ZCRCG 'i'
+#define ZCRCQ 'j'
+#define ZCRCW 'k'
+#define ZRUB0 'l'
+#define ZRUB1 'm'
+
+// Header byte positions
+#define ZF0 3
+#define ZP0 0
+
+// ZRINIT flags
+#define CANFDX  0x01
+#define CANFC32 0x20
+
+// ZFILE ZF0: resume an interrupted file
+#define ZCRESUM 3
+
+// Largest data subpacket a sender uses
+#define ZM_SUBPACKET 1024
+
+// Receive buffer size sent in ZRINIT.  The sender stops after the
+// subpacket that reaches it, so that subpacket must fit in the window.
+#define ZM_RXBUF (ZMODEM_WINDOW - ZM_SUBPACKET)
+
+// zm_getc() and zm_zdl() results that are not data bytes
+#define ZM_TIMEOUT -1
+#define ZM_CAN     -2
+#define ZM_ERROR   -3
+#define ZM_END     0x100
+
+typedef struct {
+	const zmodem_sink_t *sink;
+	zmodem_stats_t *stats;
+
+	uint8_t hdr[4];
+
+	// Data received but not yet given to the sink, which starts at file
+	// offset pos.
+	uint8_t *buf;
+	int len;
+	long pos;
+
+	// The last header was ZBIN32, so its data subpackets use CRC-32
+	int crc32;
+
+	int in_file;
+	int can;
+
+	// Called while waiting for serial data, or NULL
+	void (*idle)();
+} zmodem_t;
+
+static const uint8_t zm_zero[4];
+
+static uint16_t zm_crc16(uint16_t crc, const uint8_t *p, int len)
+{
+	int i;
+
+	while (len-- > 0)
+	{
+		crc ^= *p++ << 8;
+		for (i = 0; i < 8; i++)
+			crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+
+	return crc;
+}
+
+static int zm_getc(zmodem_t *z, float timeout)
+{
+	uint64_t start = rtcc_get();
+	int c;
+
+	while ((c = serial_read_char()) == -1)
+	{
+		if (rtcc_elapsed_sec(start) >= timeout)
+			return ZM_TIMEOUT;
+
+		if (z->idle != NULL)
+			z->idle();
+	}
+
+	// Five CANs in a row cancel the transfer
+	if (c == ZDLE)
+	{
+		if (++z->can >= 5)
+			return ZM_CAN;
+	}
+	else
+		z->can = 0;
+
+	return c;
+}
+
+// Read one byte of ZDLE encoded data.  Subpacket ends are returned as
+// ZM_END | type.
+static int zm_zdl(zmodem_t *z)
+{
+	int c;
+
+	do
+	{
+		c = zm_getc(z, 1);
+		if (c < 0)
+			return c;
+	} while ((c & 0x7F) == 0x11 || (c & 0x7F) == 0x13);
+
+	if (c != ZDLE)
+		return c;
+
+	do
+	{
+		c = zm_getc(z, 1);
+		if (c < 0)
+			return c;
+	} while ((c & 0x7F) == 0x11 || (c & 0x7F) == 0x13);
+
+	switch (c)
+	{
+		case ZCRCE:
+		case ZCRCG:
+		case ZCRCQ:
+		case ZCRCW:
+			return ZM_END | c;
+		case ZRUB0:
+			return 0x7F;
+		case ZRUB1:
+			return 0xFF;
+	}
+
+	if ((c & 0x60) == 0x40)
+		return c ^ 0x40;
+
+	return ZM_ERROR;
+}
+
+static int zm_hex(zmodem_t *z)
+{
+	int i, c, v = 0;
+
+	for (i = 0; i < 2; i++)
+	{
+		c = zm_getc(z, 1);
+		if (c >= '0' && c <= '9')
+			v = v * 16 + c - '0';
+		else if (c >= 'a' && c <= 'f')
+			v = v * 16 + c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F')
+			v = v * 16 + c - 'A' + 10;
+		else
+			return c < 0 ? c : ZM_ERROR;
+	}
+
+	return v;
+}
+
+// Wait for a header and return its type, with its four data bytes in
+// z->hdr.
+static int zm_gethdr(zmodem_t *z)
+{
+	uint8_t h[9];
+	int c, i, n, fmt;
+
+	for (;;)
+	{
+		c = zm_getc(z, ZMODEM_TIMEOUT);
+		if (c < 0)
+			return c;
+
+		if ((c & 0x7F) != ZPAD)
+			continue;
+
+		do
+		{
+			c = zm_getc(z, 1);
+		} while ((c & 0x7F) == ZPAD);
+
+		if (c != ZDLE)
+		{
+			if (c < 0)
+				return c;
+			continue;
+		}
+
+		fmt = zm_getc(z, 1);
+		if (fmt < 0)
+			return fmt;
+
+		// Type, four data bytes and a CRC-16 or CRC-32
+		n = fmt == ZBIN32 ? 9 : 7;
+
+		for (i = 0; i < n; i++)
+		{
+			if (fmt == ZHEX)
+				c = zm_hex(z);
+			else if (fmt == ZBIN || fmt == ZBIN32)
+				c = zm_zdl(z);
+			else
+				c = ZM_ERROR;
+
+			if (c < 0 || c > 0xFF)
+				return c < 0 ? c : ZM_ERROR;
+
+			h[i] = c;
+		}
+
+		if (fmt == ZBIN32)
+		{
+			if (crc32_ieee(h, 5) != (h[5] | h[6] << 8 | h[7] << 16 | (uint32_t)h[8] << 24))
+				return ZM_ERROR;
+		}
+		else if (zm_crc16(0, h, 5) != (h[5] << 8 | h[6]))
+			return ZM_ERROR;
+
+		memcpy(z->hdr, h + 1, 4);
+		z->crc32 = fmt == ZBIN32;
+
+		return h[0];
+	}
+}
+
+static long zm_hdrpos(zmodem_t *z)
+{
+	return z->hdr[ZP0] | z->hdr[ZP0+1] << 8 | z->hdr[ZP0+2] << 16 | (long)z->hdr[ZP0+3] << 24;
+}
+
+static void zm_puthex(int type, const uint8_t *hdr)
+{
+	static const char hex[] = "0123456789abcdef";
+	uint8_t h[5];
+	char s[24];
+	uint16_t crc;
+	int i, n = 0;
+
+	h[0] = type;
+	memcpy(h + 1, hdr, 4);
+	crc = zm_crc16(0, h, 5);
+
+	s[n++] = ZPAD;
+	s[n++] = ZPAD;
+	s[n++] = ZDLE;
+	s[n++] = ZHEX;
+	for (i = 0; i < 5; i++)
+	{
+		s[n++] = hex[h[i] >> 4];
+		s[n++] = hex[h[i] & 15];
+	}
+	s[n++] = hex[crc >> 12];
+	s[n++] = hex[(crc >> 8) & 15];
+	s[n++] = hex[(crc >> 4) & 15];
+	s[n++] = hex[crc & 15];
+	s[n++] = '\r';
+	s[n++] = '\n' | 0x80;
+
+	// XON in case a stray XOFF stopped the sender
+	if (type != ZFIN && type != ZACK)
+		s[n++] = 0x11;
+
+	serial_write(s, n);
+}
+
+static void zm_putpos(int type, long pos)
+{
+	uint8_t hdr[4] = { pos, pos >> 8, pos >> 16, pos >> 24 };
+
+	zm_puthex(type, hdr);
+}
+
+static void zm_zrinit()
+{
+	uint8_t hdr[4] = { ZM_RXBUF & 0xFF, ZM_RXBUF >> 8, 0, CANFDX | CANFC32 };
+
+	zm_puthex(ZRINIT, hdr);
+}
+
+static void zm_cancel()
+{
+	serial_write("\x18\x18\x18\x18\x18\x18\x18\x18\x08\x08\x08\x08\x08\x08\x08\x08", 16);
+}
+
+// Read one data subpacket into buf, which has room for max bytes, and
+// return its end type, or an error if the CRC is bad or it does not fit.
+static int zm_getdata(zmodem_t *z, uint8_t *buf, int max, int *len)
+{
+	uint8_t crc[4], end;
+	int c, i, n = 0;
+	uint32_t crc_want;
+
+	for (;;)
+	{
+		c = zm_zdl(z);
+		if (c < 0)
+			return c;
+
+		if (c & ZM_END)
+			break;
+
+		if (n >= max)
+			return ZM_ERROR;
+
+		buf[n++] = c;
+	}
+
+	for (i = 0; i < (z->crc32 ? 4 : 2); i++)
+	{
+		int b = zm_zdl(z);
+		if (b < 0 || b > 0xFF)
+			return b < 0 ? b : ZM_ERROR;
+
+		crc[i] = b;
+	}
+
+	// The CRC covers the end type too
+	end = c;
+
+	if (z->crc32)
+	{
+		crc_want = crc32_ieee_update(crc32_ieee(buf, n), &end, 1);
+		if (crc_want != (crc[0] | crc[1] << 8 | crc[2] << 16 | (uint32_t)crc[3] << 24))
+			return ZM_ERROR;
+	}
+	else
+	{
+		crc_want = zm_crc16(zm_crc16(0, buf, n), &end, 1);
+		if (crc_want != (uint32_t)(crc[0] << 8 | crc[1]))
+			return ZM_ERROR;
+	}
+
+	*len = n;
+
+	return end;
+}
+
+// Give the buffered data to the sink
+static int zm_flush(zmodem_t *z)
+{
+	int ret = 0;
+
+	if (z->len > 0)
+		ret = z->sink->write(z->sink->ctx, z->buf, z->len);
+
+	z->pos += z->len;
+	z->stats->bytes += z->len;
+	z->len = 0;
+
+	return ret;
+}
+
+static void zm_close(zmodem_t *z, int complete)
+{
+	if (!z->in_file)
+		return;
+
+	z->sink->close(z->sink->ctx, complete);
+	z->in_file = 0;
+
+	if (complete)
+		z->stats->files++;
+}
+
+// ZFILE: the subpacket holds the name, then the length and other
+// fields in text.
+static int zm_file(zmodem_t *z)
+{
+	char *name, *p;
+	int ret, len;
+	long size = -1, pos;
+
+	ret = zm_getdata(z, z->buf, ZMODEM_WINDOW - 1, &len);
+	if (ret < 0)
+		return ret;
+
+	z->buf[len] = 0;
+	name = (char*)z->buf;
+
+	// Leave off any directory
+	p = strrchr(name, '/');
+	if (p != NULL)
+		name = p + 1;
+
+	p = (char*)z->buf + strlen((char*)z->buf) + 1;
+	if (p < (char*)z->buf + len && *p)
+		size = strtol(p, NULL, 10);
+
+	pos = z->sink->open(z->sink->ctx, name, size, z->hdr[ZF0] == ZCRESUM);
+	if (pos < 0)
+	{
+		zm_puthex(ZSKIP, zm_zero);
+		return 0;
+	}
+
+	z->in_file = 1;
+	z->pos = pos;
+	z->len = 0;
+	zm_putpos(ZRPOS, pos);
+
+	return 0;
+}
+
+// ZDATA: receive subpackets until the sender waits for us or ends the
+// frame.
+static int zm_data(zmodem_t *z)
+{
+	int ret, len;
+
+	if (!z->in_file)
+		return ZM_ERROR;
+
+	// Data for another offset is still in flight after a ZRPOS
+	if (zm_hdrpos(z) != z->pos + z->len)
+	{
+		z->stats->errors++;
+		zm_putpos(ZRPOS, z->pos + z->len);
+		return 0;
+	}
+
+	for (;;)
+	{
+		ret = zm_getdata(z, z->buf + z->len, ZMODEM_WINDOW - z->len, &len);
+		if (ret == ZM_CAN)
+			return ret;
+
+		if (ret < 0)
+		{
+			// Keep the good subpackets and ask for the rest again.
+			// The sender keeps streaming until it sees the ZRPOS, so
+			// flush first and then discard what arrived meanwhile.
+			z->stats->errors++;
+			if (zm_flush(z) < 0)
+				return ZM_CAN;
+
+			while (zm_getc(z, 0.1) >= 0)
+				;
+
+			zm_putpos(ZRPOS, z->pos);
+			return 0;
+		}
+
+		z->len += len;
+
+		switch (ret)
+		{
+			case ZCRCQ:
+				zm_putpos(ZACK, z->pos + z->len);
+				break;
+
+			case ZCRCW:
+				if (zm_flush(z) < 0)
+					return ZM_CAN;
+				zm_putpos(ZACK, z->pos);
+				return 0;
+
+			case ZCRCE:
+				if (zm_flush(z) < 0)
+					return ZM_CAN;
+				return 0;
+		}
+	}
+}
+
+// Answer ZFIN and wait for the sender's "OO" (over and out), so it does
+// not end up at the console prompt.
+static void zm_fin(zmodem_t *z)
+{
+	int i, c;
+
+	for (i = 0; i < 3; i++)
+	{
+		while (zm_getc(z, 0.1) >= 0)
+			;
+
+		zm_puthex(ZFIN, zm_zero);
+
+		do
+		{
+			c = zm_getc(z, 2);
+		} while (c >= 0 && c != 'O');
+
+		if (c == 'O')
+		{
+			zm_getc(z, 0.1);
+			return;
+		}
+	}
+}
+
+// Receive files until the sender finishes or cancels and pass their
+// data to sink.  Returns 0, or -1 if the transfer was cancelled or timed
+// out.
+int zmodem_receive(const zmodem_sink_t *sink, zmodem_stats_t *stats, void (*idle)())
+{
+	zmodem_t z;
+	int type, ret = 0, retries = 0, len;
+
+	memset(&z, 0, sizeof(z));
+	memset(stats, 0, sizeof(*stats));
+	z.sink = sink;
+	z.stats = stats;
+	z.idle = idle;
+
+	z.buf = malloc(ZMODEM_WINDOW);
+	if (z.buf == NULL)
+		return -1;
+
+	zm_zrinit();
+
+	for (;;)
+	{
+		type = zm_gethdr(&z);
+
+		// The header CRC was bad or it was cut short
+		if (type == ZM_ERROR || type == ZM_TIMEOUT)
+		{
+			if (++retries > ZMODEM_RETRIES)
+			{
+				ret = -1;
+				break;
+			}
+
+			stats->errors++;
+			if (z.in_file)
+				zm_putpos(ZRPOS, z.pos + z.len);
+			else
+				zm_zrinit();
+
+			continue;
+		}
+
+		if (type == ZM_CAN || type == ZCAN || type == ZABORT)
+		{
+			ret = -1;
+			break;
+		}
+
+		retries = 0;
+
+		switch (type)
+		{
+			case ZRQINIT:
+				zm_zrinit();
+				break;
+
+			case ZSINIT:
+				// The attention string is not needed, since we never
+				// interrupt the sender while it is streaming.
+				if (zm_getdata(&z, z.buf, ZMODEM_WINDOW, &len) >= 0)
+					zm_putpos(ZACK, 1);
+				break;
+
+			case ZFILE:
+				ret = zm_file(&z);
+				if (ret < 0)
+				{
+					zm_puthex(ZNAK, zm_zero);
+					ret = 0;
+				}
+				break;
+
+			case ZDATA:
+				ret = zm_data(&z);
+				if (ret == ZM_ERROR)
+				{
+					zm_zrinit();
+					ret = 0;
+				}
+				break;
+
+			case ZEOF:
+				// An earlier offset means data is still in flight
+				if (z.in_file && zm_hdrpos(&z) == z.pos + z.len)
+				{
+					if (zm_flush(&z) < 0)
+						ret = ZM_CAN;
+					zm_close(&z, 1);
+					zm_zrinit();
+				}
+				break;
+
+			case ZFIN:
+				zm_close(&z, 0);
+				zm_fin(&z);
+
+				free(z.buf);
+				return 0;
+
+			case ZCOMMAND:
+				// Never run commands from the sender
+				zm_putpos(ZCOMPL, 0);
+				break;
+
+			case ZFREECNT:
+				zm_putpos(ZACK, 0);
+				break;
+
+			default:
+				break;
+		}
+
+		if (ret == ZM_CAN)
+		{
+			ret = -1;
+			break;
+		}
+	}
+
+	zm_close(&z, 0);
+	zm_cancel();
+
+	free(z.buf);
+
+	return ret;
+}
@@ -0,0 +1,278 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+
+// sat-bundle: build tle.bin, tle.idx and pass.bin on a Linux host.
+//
+// The catalog is converted by catalog.c and the pass table is built by
+// pass.c, the same code the device runs, on a FAT volume on the emulated
+// flash in nor-sim.c, kept in memory.  The catalog is split between one
+// process per core for the pass search because SDP4 keeps its state in
+// globals.  Upload the three files with
+// `fat rx <file>` and the device starts with a complete catalog and pass
+// table for the next 24 hours.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <sys/wait.h>
+
+#include "sgp4sdp4.h"
+
+#include "catalog.h"
+#include "pass.h"
+#include "config.h"
+#include "rtcc.h"
+
+#include "ff.h"
+#include "fatfs-util.h"
+#include "nor-sim.h"
+
+#define BUNDLE_MAX_JOBS 256
+
+static FATFS fatfs;
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: sat-bundle [-j jobs] [-t unix-time] [-n max-passes] [-o dir]\n"
+		"                  <lat> <lon> <alt-m> <tle-or-omm-csv-file>\n"
+		"\n"
+		"  -j  Processes for the pass search (default: all cores)\n"
+		"  -t  Start of the 24 hour pass window (default: now)\n"
+		"  -n  Most passes to keep, 256 for EFR32 (default: %d)\n"
+		"  -o  Output directory (default: .)\n",
+		PASS_MAX);
+
+	exit(1);
+}
+
+// Feed the text file to catalog.c, which writes tle.bin and tle.idx.
+static int bundle_catalog(const char *filename)
+{
+	static catalog_t cat;
+	static char buf[65536];
+
+	FILE *in;
+	size_t n;
+
+	in = fopen(filename, "rb");
+	if (in == NULL)
+	{
+		perror(filename);
+		return -1;
+	}
+
+	if (catalog_begin(&cat, "tle.bin") != FR_OK)
+	{
+		fclose(in);
+		return -1;
+	}
+
+	while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+		catalog_feed(&cat, buf, n);
+
+	fclose(in);
+
+	return catalog_end(&cat) == FR_OK ? 0 : -1;
+}
+
+// Search every jobs'th satellite in a child process and return the passes
+// through a pipe.  Returns the read end of the pipe.
+static int bundle_worker(uint32_t start, int part, int jobs, pid_t *pid)
+{
+	const pass_t *p;
+	int fd[2], i, n;
+
+	if (pipe(fd) < 0)
+	{
+		perror("pipe");
+		return -1;
+	}
+
+	*pid = fork();
+	if (*pid < 0)
+	{
+		perror("fork");
+		close(fd[0]);
+		close(fd[1]);
+		return -1;
+	}
+
+	if (*pid > 0)
+	{
+		close(fd[1]);
+		return fd[0];
+	}
+
+	close(fd[0]);
+
+	n = pass_build(start, part, jobs);
+	for (i = 0; i < n; i++)
+	{
+		p = pass_get(i);
+		if (write(fd[1], p, sizeof(*p)) != sizeof(*p))
+			_exit(1);
+	}
+
+	_exit(0);
+}
+
+// Copy a file out of the FAT volume into dir.
+static int bundle_export(const char *dir, const char *name)
+{
+	char path[4096], buf[4096];
+	FRESULT res;
+	FILE *out;
+	FIL in;
+	UINT br;
+
+	res = f_open(&in, name, FA_READ);
+	if (res != FR_OK)
+	{
+		fprintf(stderr, "%s: %s\n", name, ff_strerror(res));
+		return -1;
+	}
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	out = fopen(path, "wb");
+	if (out == NULL)
+	{
+		perror(path);
+		f_close(&in);
+		return -1;
+	}
+
+	while (f_read(&in, buf, sizeof(buf), &br) == FR_OK && br > 0)
+		fwrite(buf, 1, br, out);
+
+	printf("%s: %lu bytes\n", path, (unsigned long)f_size(&in));
+
+	fclose(out);
+	f_close(&in);
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	static pass_t all[PASS_MAX * BUNDLE_MAX_JOBS];
+
+	MKFS_PARM mkfs = {.fmt = FM_ANY};
+	BYTE work[FF_MAX_SS];
+	FRESULT res;
+
+	const char *dir = ".";
+	uint32_t start = time(NULL);
+	int jobs = sysconf(_SC_NPROCESSORS_ONLN), max = PASS_MAX;
+	int fds[BUNDLE_MAX_JOBS], i, c, n, total = 0;
+	pid_t pids[BUNDLE_MAX_JOBS];
+	uint64_t t0;
+	ssize_t len;
+
+	while ((c = getopt(argc, argv, "+j:t:n:o:")) != -1)
+	{
+		switch (c)
+		{
+			case 'j': jobs = atoi(optarg); break;
+			case 't': start = strtoul(optarg, NULL, 10); break;
+			case 'n': max = atoi(optarg); break;
+			case 'o': dir = optarg; break;
+			default: usage();
+		}
+	}
+
+	if (argc - optind != 4)
+		usage();
+
+	if (jobs < 1)
+		jobs = 1;
+	if (jobs > BUNDLE_MAX_JOBS)
+		jobs = BUNDLE_MAX_JOBS;
+
+	config.observer.lat = Radians(atof(argv[optind]));
+	config.observer.lon = Radians(atof(argv[optind+1]));
+	config.observer.alt = atof(argv[optind+2]) / 1000;
+
+	// Large enough for the whole public catalog and kept in memory
+	if (nor_sim_open(NULL, 32*1024*1024 / FLASH_PAGE_SIZE))
+		return 1;
+
+	res = f_mkfs("", &mkfs, work, sizeof(work));
+	if (res == FR_OK)
+		res = f_mount(&fatfs, "", 1);
+	if (res != FR_OK)
+	{
+		fprintf(stderr, "fatfs: %s\n", ff_strerror(res));
+		return 1;
+	}
+
+	if (bundle_catalog(argv[optind+3]) < 0)
+		return 1;
+
+	t0 = rtcc_get();
+
+	// Children inherit the volume with tle.bin in it
+	fflush(stdout);
+	for (i = 0; i < jobs; i++)
+	{
+		fds[i] = bundle_worker(start, i, jobs, &pids[i]);
+		if (fds[i] < 0)
+			return 1;
+	}
+
+	for (i = 0; i < jobs; i++)
+	{
+		n = 0;
+		while (total < PASS_MAX * BUNDLE_MAX_JOBS &&
+			(len = read(fds[i], (char *)&all[total] + n, sizeof(pass_t) - n)) > 0)
+		{
+			n += len;
+			if (n == sizeof(pass_t))
+			{
+				total++;
+				n = 0;
+			}
+		}
+
+		close(fds[i]);
+		waitpid(pids[i], &c, 0);
+		if (!WIFEXITED(c) || WEXITSTATUS(c) != 0)
+		{
+			fprintf(stderr, "worker %d failed\n", i);
+			return 1;
+		}
+	}
+
+	pass_import(all, total, max, start);
+
+	printf("%d passes in %.2f seconds with %d processes, %d kept\n",
+		total, rtcc_elapsed_sec(t0), jobs, pass_count());
+
+	if (bundle_export(dir, "tle.bin") < 0 ||
+		bundle_export(dir, "tle.idx") < 0 ||
+		bundle_export(dir, "pass.bin") < 0)
+		return 1;
+
+	return 0;
+}
@@ -0,0 +1,111 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+
+// tlog-dump: convert a rotor telemetry log written by `tlog start` to CSV.
+//
+// Download the log with `fat tx tlog.bin` after `tlog stop`.  Blocks that
+// are damaged are skipped and counted.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tlog.h"
+
+struct dump
+{
+	FILE *out;
+	unsigned long samples, gaps, nan;
+};
+
+static void dump_sample(const tlog_block_t *b, const tlog_sample_t *s, void *arg)
+{
+	struct dump *d = arg;
+	double t;
+
+	t = b->time + (double)b->frac / b->tps + (double)(s->tick - b->tick) / b->hz;
+
+	fprintf(d->out, "%.3f,%lu,%d,%.2f,",
+		t, (unsigned long)s->tick, s->rotor, (double)s->target / TLOG_DEG_SCALE);
+
+	if (s->flags & TLOG_POS_NAN)
+		fprintf(d->out, ",,");
+	else
+		fprintf(d->out, "%.2f,%.2f,",
+			(double)s->pos / TLOG_DEG_SCALE,
+			(double)(s->target - s->pos) / TLOG_DEG_SCALE);
+
+	fprintf(d->out, "%.3f,", (double)s->out / TLOG_OUT_SCALE);
+
+	if (s->age == TLOG_AGE_UNKNOWN)
+		fprintf(d->out, ",");
+	else
+		fprintf(d->out, "%.1f,", 1000.0 * s->age / b->tps);
+
+	fprintf(d->out, "%d\n", s->flags);
+
+	d->samples++;
+	if (s->flags & TLOG_GAP)
+		d->gaps++;
+	if (s->flags & TLOG_POS_NAN)
+		d->nan++;
+}
+
+int main(int argc, char **argv)
+{
+	struct dump d = { .out = stdout };
+	uint8_t block[TLOG_BLOCK_SIZE];
+	unsigned long blocks = 0, bad = 0, dropped = 0;
+	FILE *in;
+
+	if (argc != 2)
+	{
+		fprintf(stderr, "usage: tlog-dump <tlog.bin>\n");
+		return 1;
+	}
+
+	in = fopen(argv[1], "rb");
+	if (in == NULL)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	printf("time,tick,rotor,target,pos,err,out,age_ms,flags\n");
+
+	while (fread(block, 1, sizeof(block), in) == sizeof(block))
+	{
+		blocks++;
+		if (tlog_decode(block, dump_sample, &d) < 0)
+			bad++;
+		else
+			dropped = ((tlog_block_t *)block)->dropped;
+	}
+
+	fclose(in);
+
+	fprintf(stderr, "%lu blocks (%lu damaged), %lu samples, %lu gaps, "
+		"%lu without position, %lu dropped before the last block\n",
+		blocks, bad, d.samples, d.gaps, d.nan, dropped);
+
+	return 0;
+}
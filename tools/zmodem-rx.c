@@ -0,0 +1,150 @@
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+// 
+//  Copyright (C) 2022- by Ezekiel Wheeler, KJ7NLL and Eric Wheeler, KJ7LNW.
+//  All rights reserved.
+//
+//  The official website and doumentation for space-ham is available here:
+//    https://www.kj7nll.radio/
+//
+//
+// zmodem-rx: run the device's ZMODEM receiver (main/zmodem.c) on a Linux
+// host.
+//
+// The Linux build of serial.c reads the link from stdin and writes it to
+// stderr, so connect a sender with a pipe each way:
+//
+//   mkfifo link
+//   sz -b tle.txt <link | zmodem-rx out 2>link
+//
+// Files are written to the given directory, or the current one, under
+// the name they were sent with.  An existing file is skipped unless the
+// sender asks to resume it (sz -r).  tools/zmodem-test.py uses this to
+// check the receiver against errors, resume and cancel without a device.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "zmodem.h"
+
+struct rx_file
+{
+	const char *dir;
+	char path[512];
+	FILE *out;
+	int failed;
+};
+
+static long rx_open(void *ctx, const char *name, long size, int resume)
+{
+	struct rx_file *rf = ctx;
+	const char *base = strrchr(name, '/');
+	long len;
+
+	// Never write outside the directory
+	if (base != NULL)
+		name = base + 1;
+
+	snprintf(rf->path, sizeof(rf->path), "%s/%s", rf->dir, name);
+
+	rf->out = fopen(rf->path, "r+b");
+	if (rf->out != NULL)
+	{
+		fseek(rf->out, 0, SEEK_END);
+		len = ftell(rf->out);
+		if (resume && (size < 0 || len <= size))
+		{
+			printf("%s: resume at %ld of %ld bytes\n", rf->path, len, size);
+			return len;
+		}
+
+		fclose(rf->out);
+		rf->out = NULL;
+		printf("%s: exists, skipped\n", rf->path);
+		return -1;
+	}
+
+	rf->out = fopen(rf->path, "wb");
+	if (rf->out == NULL)
+	{
+		perror(rf->path);
+		rf->failed = 1;
+		return -1;
+	}
+
+	printf("%s: %ld bytes\n", rf->path, size);
+
+	return 0;
+}
+
+static int rx_write(void *ctx, const void *buf, int len)
+{
+	struct rx_file *rf = ctx;
+
+	if (fwrite(buf, 1, len, rf->out) != (size_t)len)
+	{
+		perror(rf->path);
+		rf->failed = 1;
+		return -1;
+	}
+
+	return 0;
+}
+
+static void rx_close(void *ctx, int complete)
+{
+	struct rx_file *rf = ctx;
+
+	fclose(rf->out);
+	rf->out = NULL;
+
+	if (!complete)
+		printf("%s: incomplete\n", rf->path);
+}
+
+static void rx_idle()
+{
+	usleep(100);
+}
+
+int main(int argc, char **argv)
+{
+	struct rx_file rf = { .dir = "." };
+	zmodem_sink_t sink = { rx_open, rx_write, rx_close, &rf };
+	zmodem_stats_t stats;
+	int ret;
+
+	if (argc > 2)
+	{
+		printf("usage: zmodem-rx [dir] <link 2>link\n");
+		return 1;
+	}
+
+	if (argc == 2)
+		rf.dir = argv[1];
+
+	// serial_read_char() must not block so the receiver can time out
+	fcntl(0, F_SETFL, fcntl(0, F_GETFL) | O_NONBLOCK);
+
+	ret = zmodem_receive(&sink, &stats, rx_idle);
+
+	printf("%s: %d files, %ld bytes, %d errors\n",
+		ret < 0 ? "cancelled" : "received",
+		stats.files, stats.bytes, stats.errors);
+
+	return (ret < 0 || rf.failed) ? 1 : 0;
+}
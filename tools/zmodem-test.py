@@ -0,0 +1,300 @@
+#!/usr/bin/env python3
+#
+# zmodem-test.py: check the ZMODEM receiver in main/zmodem.c on a Linux
+# host through tools/zmodem-rx.
+#
+# This is a minimal ZMODEM sender that can corrupt and truncate data
+# subpackets on purpose, which sz cannot.  Each run compares the files
+# written by zmodem-rx with the data that was sent:
+#
+#   - a batch of two files, text and binary
+#   - 5% corrupted and 2% truncated subpackets
+#   - CRC-16 headers and subpackets, with a file that is skipped
+#   - resume from a partial file (sz -r)
+#   - an empty file
+#   - 1000 byte subpackets, which do not divide the receive window
+#   - CAN abort in the middle of a file
+#
+# usage: tools/zmodem-test.py [path/to/zmodem-rx] [seed]
+
+import binascii
+import os
+import random
+import select
+import subprocess
+import sys
+import tempfile
+import time
+
+ZRQINIT, ZRINIT, ZSINIT, ZACK, ZFILE, ZSKIP, ZNAK, ZABORT, ZFIN, ZRPOS, ZDATA, ZEOF = range(12)
+ZCRCE, ZCRCG, ZCRCQ, ZCRCW = b'hijk'
+
+ZDLE = 0x18
+ZDLE_ESCAPED = (0x18, 0x10, 0x11, 0x13, 0x90, 0x91, 0x93)
+
+rx = './zmodem-rx'
+outdir = None
+
+# Retransmissions reported by the last zmodem-rx run
+errors = 0
+
+
+def crc16(data, crc=0):
+	for b in data:
+		crc ^= b << 8
+		for _ in range(8):
+			crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+			crc &= 0xffff
+	return crc
+
+
+def esc(data):
+	out = bytearray()
+	for b in data:
+		if b in ZDLE_ESCAPED:
+			out += bytes([ZDLE, b ^ 0x40])
+		else:
+			out.append(b)
+	return bytes(out)
+
+
+def hexhdr(t, h):
+	d = bytes([t]) + bytes(h)
+	c = crc16(d)
+	return b'**\x18B' + binascii.hexlify(d + bytes([c >> 8, c & 255])) + b'\r\x8a\x11'
+
+
+def bin32hdr(t, h):
+	d = bytes([t]) + bytes(h)
+	return b'*\x18C' + esc(d + binascii.crc32(d).to_bytes(4, 'little'))
+
+
+def bin16hdr(t, h):
+	d = bytes([t]) + bytes(h)
+	c = crc16(d)
+	return b'*\x18A' + esc(d + bytes([c >> 8, c & 255]))
+
+
+def pos4(p):
+	return list(p.to_bytes(4, 'little'))
+
+
+def sub32(data, end, corrupt=False):
+	c = binascii.crc32(data + bytes([end]))
+	e = esc(data)
+	if corrupt and len(e) > 10:
+		# Flip a bit that cannot turn into or out of a ZDLE
+		e = bytearray(e)
+		i = random.randrange(len(e))
+		if e[i] != ZDLE and e[i] ^ 1 not in ZDLE_ESCAPED:
+			e[i] ^= 1
+		e = bytes(e)
+	return e + bytes([ZDLE, end]) + esc(c.to_bytes(4, 'little'))
+
+
+def sub16(data, end, corrupt=False):
+	c = crc16(data + bytes([end]))
+	return esc(data) + bytes([ZDLE, end]) + esc(bytes([c >> 8, c & 255]))
+
+
+class Link:
+	def __init__(self, p):
+		self.p = p
+		self.buf = b''
+
+	def write(self, d):
+		self.p.stdin.write(d)
+		self.p.stdin.flush()
+
+	def fill(self, timeout):
+		r, _, _ = select.select([self.p.stderr], [], [], timeout)
+		if not r:
+			return False
+		d = os.read(self.p.stderr.fileno(), 4096)
+		if not d:
+			raise EOFError('zmodem-rx exited')
+		self.buf += d
+		return True
+
+	# The receiver only sends hex headers.  With poll set, return None
+	# right away if there is no complete header yet.
+	def hdr(self, timeout=5.0, poll=False):
+		end = time.time() + timeout
+		while True:
+			i = self.buf.find(b'**\x18B')
+			if i >= 0 and len(self.buf) >= i + 18:
+				h = binascii.unhexlify(self.buf[i + 4:i + 18])
+				self.buf = self.buf[i + 18:]
+				assert crc16(h[:5]) == (h[5] << 8 | h[6]), 'header CRC'
+				return h[0], h[1:5]
+			if poll:
+				if not self.fill(0):
+					return None
+			elif not self.fill(max(0, end - time.time())) and time.time() > end:
+				raise TimeoutError('no header from zmodem-rx')
+
+
+def start():
+	p = subprocess.Popen([rx, outdir], stdin=subprocess.PIPE,
+		stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+	link = Link(p)
+	link.write(hexhdr(ZRQINIT, [0, 0, 0, 0]))
+	t, h = link.hdr()
+	assert t == ZRINIT, t
+	return p, link, h[0] | h[1] << 8
+
+
+def finish(p):
+	global errors
+
+	p.stdin.close()
+	out = p.stdout.read().decode()
+	p.wait()
+	sys.stdout.write(''.join('    ' + l + '\n' for l in out.splitlines()))
+	errors = int(out.split()[-2])
+	return p.returncode
+
+
+def send(files, resume=False, blk=1024, err=0.0, drop=0.0, crc='32'):
+	p, link, window = start()
+	H = bin32hdr if crc == '32' else bin16hdr
+	S = sub32 if crc == '32' else sub16
+
+	for name, data in files:
+		info = name.encode() + b'\0' + b'%d 0 100644 0' % len(data) + b'\0'
+		link.write(H(ZFILE, [0, 0, 0, 3 if resume else 1]) + S(info, ZCRCW))
+		t, h = link.hdr()
+		while t == ZRINIT:
+			t, h = link.hdr()
+		if t == ZSKIP:
+			continue
+		assert t == ZRPOS, t
+		pos = int.from_bytes(h, 'little')
+
+		while True:
+			link.write(H(ZDATA, pos4(pos)))
+			left = window
+			restart = None
+			while True:
+				n = min(blk, len(data) - pos)
+				left -= n
+				eof = pos + n >= len(data)
+				end = ZCRCE if eof else (ZCRCW if left <= 0 else ZCRCG)
+				pkt = S(data[pos:pos + n], end, corrupt=random.random() < err)
+				if random.random() < drop and len(pkt) > 20:
+					i = random.randrange(len(pkt) - 5)
+					pkt = pkt[:i] + pkt[i + 3:]
+				link.write(pkt)
+				pos += n
+
+				if end == ZCRCW:
+					t, h = link.hdr(12)
+					if t == ZRPOS:
+						restart = int.from_bytes(h, 'little')
+					else:
+						assert t == ZACK, t
+					break
+
+				# Full duplex: the receiver asks for a restart as soon
+				# as it sees a bad subpacket.
+				r = link.hdr(poll=True)
+				if r:
+					assert r[0] == ZRPOS, r[0]
+					restart = int.from_bytes(r[1], 'little')
+					break
+
+				if end == ZCRCE:
+					break
+
+			if restart is not None:
+				pos = restart
+				continue
+			if pos < len(data):
+				continue
+
+			link.write(H(ZEOF, pos4(pos)))
+			t, h = link.hdr(12)
+			if t == ZRPOS:
+				pos = int.from_bytes(h, 'little')
+				continue
+			assert t == ZRINIT, t
+			break
+
+	link.write(hexhdr(ZFIN, [0, 0, 0, 0]))
+	t, h = link.hdr()
+	assert t == ZFIN, t
+	link.write(b'OO')
+
+	return finish(p)
+
+
+def cancel():
+	p, link, window = start()
+	link.write(bin32hdr(ZFILE, [0, 0, 0, 1]) + sub32(b'cancel.dat\0' b'100000 0 0\0', ZCRCW))
+	t, h = link.hdr()
+	while t == ZRINIT:
+		t, h = link.hdr()
+	assert t == ZRPOS, t
+	link.write(bin32hdr(ZDATA, [0, 0, 0, 0]) + sub32(b'a' * 1024, ZCRCG) + b'\x18' * 8 + b'\x08' * 8)
+	return finish(p)
+
+
+failed = 0
+
+
+# Runs without injected errors must not need a retransmission either,
+# or the receiver stalled until a timeout.
+def check(what, ret, want_ret, files, clean=True):
+	global failed
+	ok = ret == want_ret and (errors == 0 or not clean)
+	for name, data in files:
+		with open(os.path.join(outdir, name), 'rb') as f:
+			ok = ok and f.read() == data
+	print('%s: %s' % (what, 'ok' if ok else 'FAILED'))
+	if not ok:
+		failed += 1
+
+
+def main():
+	global rx, outdir
+
+	if len(sys.argv) > 1:
+		rx = sys.argv[1]
+	random.seed(int(sys.argv[2]) if len(sys.argv) > 2 else 1)
+
+	text = b''.join(b'OBJECT %05d 1 25544U 98067A   24001.00000000  .00016717  00000-0  10270-3 0  9005\r\n' % i
+		for i in range(20000))
+	binary = bytes(random.randrange(256) for _ in range(300000))
+
+	with tempfile.TemporaryDirectory() as d:
+		outdir = d
+
+		check('batch', send([('tle.txt', text), ('bin.dat', binary)]), 0,
+			[('tle.txt', text), ('bin.dat', binary)])
+
+		os.remove(os.path.join(d, 'bin.dat'))
+		check('errors', send([('bin.dat', binary)], err=0.05, drop=0.02), 0,
+			[('bin.dat', binary)], clean=False)
+
+		with open(os.path.join(d, 'skip.txt'), 'wb') as f:
+			f.write(b'old')
+		check('crc16 and skip', send([('skip.txt', b'new'), ('b16.dat', binary[:5000])], crc='16'), 0,
+			[('skip.txt', b'old'), ('b16.dat', binary[:5000])])
+
+		with open(os.path.join(d, 'res.dat'), 'wb') as f:
+			f.write(binary[:123457])
+		check('resume', send([('res.dat', binary)], resume=True), 0,
+			[('res.dat', binary)])
+
+		check('empty', send([('empty', b'')]), 0, [('empty', b'')])
+
+		check('odd subpackets', send([('odd.dat', binary[:100000])], blk=1000), 0,
+			[('odd.dat', binary[:100000])])
+
+		check('cancel', cancel(), 1, [], clean=False)
+
+	return 1 if failed else 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())